@@ -168,6 +168,10 @@
     #error Unsupported GPS configuration. Use at own risk.
 #endif
 
+#if defined(GPS_PPS_PIN) && (USE_GPS == 0)
+    #error GPS_PPS_PIN needs USE_GPS to be 1
+#endif
+
 #if (USE_GYRO_LEVEL == 0)
 // Baseline configuration without gyro is valid
 #elif defined(ESP32) || defined(__AVR_ATmega2560__)
@@ -175,6 +179,17 @@
 #else
     #error Unsupported gyro configuration. Use at own risk.
 #endif
+#if USE_GYRO_LEVEL == 1
+    #if (GYRO_SAMPLE_MS < 5) || (GYRO_SAMPLE_MS > 256)
+        #error GYRO_SAMPLE_MS must be between 5 and 256
+    #endif
+    #if GYRO_FILTER_SAMPLES < 1
+        #error GYRO_FILTER_SAMPLES must be at least 1
+    #endif
+    #if (GYRO_USE_FIFO != 0) && (GYRO_USE_FIFO != 1)
+        #error GYRO_USE_FIFO must be 0 (read the registers) or 1 (read the FIFO)
+    #endif
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                            ////////
@@ -312,6 +327,112 @@
         #error Missing serial port assignment for external debugging
     #endif
 #endif
+#if (AUTO_MERIDIAN_FLIP_LEAD_MINUTES < 1) || (AUTO_MERIDIAN_FLIP_LEAD_MINUTES > 120)
+    #error AUTO_MERIDIAN_FLIP_LEAD_MINUTES must be between 1 and 120
+#endif
+#if STEP_TIMING_CAPTURE == 1
+    #if (STEP_TIMING_BUFFER_SIZE & (STEP_TIMING_BUFFER_SIZE - 1)) != 0
+        #error STEP_TIMING_BUFFER_SIZE must be a power of two
+    #endif
+    #ifdef NEW_STEPPER_LIB
+        #error STEP_TIMING_CAPTURE is not supported with NEW_STEPPER_LIB
+    #endif
+#endif
+#if GUIDE_RATE_LEARNING != 0
+    #if (GUIDE_RATE_LEARNING != 1) && (GUIDE_RATE_LEARNING != 2)
+        #error GUIDE_RATE_LEARNING must be 0, 1 or 2
+    #endif
+    #if (GUIDE_RATE_LEARNING_BINS < 8) || (GUIDE_RATE_LEARNING_BINS > 255)
+        #error GUIDE_RATE_LEARNING_BINS must be between 8 and 255
+    #endif
+    #if GUIDE_RATE_LEARNING_BINS * GUIDE_RATE_LEARNING_BIN_SECONDS < GUIDE_RATE_LEARNING_MIN_MINUTES * 60
+        #error GUIDE_RATE_LEARNING_BINS bins of GUIDE_RATE_LEARNING_BIN_SECONDS must cover GUIDE_RATE_LEARNING_MIN_MINUTES
+    #endif
+#endif
+#if PEC_ENABLED == 1
+    #if (PEC_CYCLE_STEPS % PEC_SEGMENTS) != 0
+        #error PEC_CYCLE_STEPS must be a multiple of PEC_SEGMENTS (64), increase RA_TRACKING_MICROSTEPPING or set PEC_CYCLE_STEPS
+    #endif
+    #if (PEC_RECORD_CYCLES < 1) || (PEC_RECORD_CYCLES > 16)
+        #error PEC_RECORD_CYCLES must be between 1 and 16
+    #endif
+    #ifdef NEW_STEPPER_LIB
+        #error PEC is not supported with NEW_STEPPER_LIB
+    #endif
+#endif
+#if EPHEMERIS_TRACKING == 1
+    #if (EPHEMERIS_POINTS < 4) || (EPHEMERIS_POINTS > 255)
+        #error EPHEMERIS_POINTS must be between 4 and 255
+    #endif
+    #if (EPHEMERIS_UPDATE_MS < 100) || (EPHEMERIS_UPDATE_MS > 10000)
+        #error EPHEMERIS_UPDATE_MS must be between 100 and 10000
+    #endif
+#endif
+#if TARGET_QUEUE == 1
+    #if (TARGET_QUEUE_SIZE < 1) || (TARGET_QUEUE_SIZE > 255)
+        #error TARGET_QUEUE_SIZE must be between 1 and 255
+    #endif
+#endif
+#if STEP_ENVELOPE == 1
+    #if (STEP_ENVELOPE_RA_MAX_SPEED < 0) || (STEP_ENVELOPE_DEC_MAX_SPEED < 0)
+        #error STEP_ENVELOPE_RA_MAX_SPEED and STEP_ENVELOPE_DEC_MAX_SPEED must be 0 (no cap) or a speed in steps/s
+    #endif
+    #ifdef NEW_STEPPER_LIB
+        #error STEP_ENVELOPE is not supported with NEW_STEPPER_LIB
+    #endif
+#endif
+#if (HALL_SENSOR_LATCH_EDGES != 0) && (HALL_SENSOR_LATCH_EDGES != 1)
+    #error HALL_SENSOR_LATCH_EDGES must be 0 (poll the sensor) or 1 (latch edges in an interrupt)
+#endif
+#if HALL_SENSOR_SLOW_APPROACH == 1
+    #if (HALL_SENSOR_APPROACH_SLEW_RATE < 1) || (HALL_SENSOR_APPROACH_SLEW_RATE > 4)
+        #error HALL_SENSOR_APPROACH_SLEW_RATE must be between 1 and 4
+    #endif
+#endif
+#if USE_STALLGUARD_RA_AUTOHOME == 1
+    #if RA_DRIVER_TYPE != DRIVER_TYPE_TMC2209_UART
+        #error StallGuard homing of RA needs a DRIVER_TYPE_TMC2209_UART driver
+    #endif
+    #if USE_HALL_SENSOR_RA_AUTOHOME == 1
+        #error RA can be homed by Hall sensor or by StallGuard, not both
+    #endif
+    #if (RA_STALL_HOMING_DIRECTION != 1) && (RA_STALL_HOMING_DIRECTION != -1)
+        #error RA_STALL_HOMING_DIRECTION must be 1 or -1
+    #endif
+    #if (RA_STALL_HOMING_SLEW_RATE < 1) || (RA_STALL_HOMING_SLEW_RATE > 4)
+        #error RA_STALL_HOMING_SLEW_RATE must be between 1 and 4
+    #endif
+#endif
+#if USE_STALLGUARD_DEC_AUTOHOME == 1
+    #if DEC_DRIVER_TYPE != DRIVER_TYPE_TMC2209_UART
+        #error StallGuard homing of DEC needs a DRIVER_TYPE_TMC2209_UART driver
+    #endif
+    #if USE_HALL_SENSOR_DEC_AUTOHOME == 1
+        #error DEC can be homed by Hall sensor or by StallGuard, not both
+    #endif
+    #if (DEC_STALL_HOMING_DIRECTION != 1) && (DEC_STALL_HOMING_DIRECTION != -1)
+        #error DEC_STALL_HOMING_DIRECTION must be 1 or -1
+    #endif
+    #if (DEC_STALL_HOMING_SLEW_RATE < 1) || (DEC_STALL_HOMING_SLEW_RATE > 4)
+        #error DEC_STALL_HOMING_SLEW_RATE must be between 1 and 4
+    #endif
+#endif
+#if BUFFER_LOGS == true
+    #if (LOG_BUFFER_RECORDS < 1) || (LOG_BUFFER_RECORDS > 255)
+        #error LOG_BUFFER_RECORDS must be between 1 and 255
+    #endif
+#endif
+#if BINARY_LOGS == true
+    #if BUFFER_LOGS == true
+        #error BINARY_LOGS and BUFFER_LOGS cannot be enabled at the same time
+    #endif
+    #if (BINARY_LOG_BUFFER_SIZE & (BINARY_LOG_BUFFER_SIZE - 1)) != 0
+        #error BINARY_LOG_BUFFER_SIZE must be a power of two
+    #endif
+    #if (BINARY_LOG_MAX_STRING > 64)
+        #error BINARY_LOG_MAX_STRING must not be larger than 64
+    #endif
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                                ////////
@@ -21,6 +21,100 @@
 #if !defined(BUFFER_LOGS)
     #define BUFFER_LOGS false
 #endif
+// Set to 0 to remove the loop profiler (see :XGPF#). It costs about 300 bytes of RAM.
+#if !defined(LOOP_PROFILER)
+    #define LOOP_PROFILER 1
+#endif
+// Set to 1 to be able to capture the timing of every RA tracking step (see :XSJ# and :XGJ#).
+// Analyze the captured data with scripts/StepJitterAnalyzer.py.
+#if !defined(STEP_TIMING_CAPTURE)
+    #define STEP_TIMING_CAPTURE 0
+#endif
+#if STEP_TIMING_CAPTURE == 1
+    #ifndef STEP_TIMING_BUFFER_SIZE
+        #define STEP_TIMING_BUFFER_SIZE 128  // Number of timestamps, must be a power of two
+    #endif
+#endif
+// Set to 1 to learn the RA tracking rate error from the guide pulses while guiding (see :XGGL#), the learned
+// speed factor can then be applied with :XSGL#. Set to 2 to apply and store it automatically as soon as the
+// fit is good enough. Costs about 300 bytes of RAM.
+#if !defined(GUIDE_RATE_LEARNING)
+    #define GUIDE_RATE_LEARNING 0
+#endif
+#if GUIDE_RATE_LEARNING != 0
+    #ifndef GUIDE_RATE_LEARNING_BINS
+        #define GUIDE_RATE_LEARNING_BINS 32  // Number of bins of guide pulses that are kept for the fit
+    #endif
+    #ifndef GUIDE_RATE_LEARNING_BIN_SECONDS
+        #define GUIDE_RATE_LEARNING_BIN_SECONDS 120  // Guide pulses are summed over this time into one bin
+    #endif
+    #ifndef GUIDE_RATE_LEARNING_MIN_MINUTES
+        #define GUIDE_RATE_LEARNING_MIN_MINUTES 30  // Minimum guiding time covered before a fit is valid
+    #endif
+#endif
+// Set to 1 to enable periodic error correction (PEC). While guiding, :XSPER# records the RA guide corrections
+// over PEC_RECORD_CYCLES periods of the RA drive and stores their average in EEPROM. While tracking, the TRK
+// speed then follows that table. The phase is counted from the home position, so the mount must be started
+// (or homed) at home. Costs about 500 bytes of RAM.
+#if !defined(PEC_ENABLED)
+    #define PEC_ENABLED 0
+#endif
+#if PEC_ENABLED == 1
+    #define PEC_SEGMENTS 64  // Entries in the PEC table, fixed by the EEPROM layout
+    #ifndef PEC_CYCLE_STEPS
+        // TRK steps per period of the periodic error, by default one revolution of the RA motor pulley
+        #define PEC_CYCLE_STEPS (1L * RA_STEPPER_SPR * RA_TRACKING_MICROSTEPPING)
+    #endif
+    #ifndef PEC_RECORD_CYCLES
+        #define PEC_RECORD_CYCLES 3  // Number of periods averaged into the table
+    #endif
+#endif
+// Set to 1 to follow moving objects (comets, asteroids, satellites) from a list of time tagged RA/DEC points
+// that is streamed in over serial (see :XEP#). The tracking rates of both axes are adjusted every
+// EPHEMERIS_UPDATE_MS to stay on the track. Costs about 12 bytes of RAM per point.
+#if !defined(EPHEMERIS_TRACKING)
+    #define EPHEMERIS_TRACKING 0
+#endif
+#if EPHEMERIS_TRACKING == 1
+    #ifndef EPHEMERIS_POINTS
+        #define EPHEMERIS_POINTS 16  // Number of buffered track points
+    #endif
+    #ifndef EPHEMERIS_UPDATE_MS
+        #define EPHEMERIS_UPDATE_MS 1000  // Time between two rate updates
+    #endif
+#endif
+// Set to 1 to run a queue of GoTo targets (e.g. mosaic panels) on the mount, each with a dwell time and
+// optional dither, so the host does not need to sequence every slew (see :XQA#).
+#if !defined(TARGET_QUEUE)
+    #define TARGET_QUEUE 0
+#endif
+#if TARGET_QUEUE == 1
+    #ifndef TARGET_QUEUE_SIZE
+        #define TARGET_QUEUE_SIZE 16  // Number of targets that can be queued, 12 bytes of RAM each
+    #endif
+#endif
+#if BUFFER_LOGS == true
+    #ifndef LOG_BUFFER_RECORDS
+        #define LOG_BUFFER_RECORDS 8  // Number of log lines kept, the oldest line is overwritten when full
+    #endif
+    #ifndef LOG_BUFFER_RECORD_LENGTH
+        #define LOG_BUFFER_RECORD_LENGTH 64  // Longer log lines are truncated
+    #endif
+#endif
+// Set to true to log in binary form. LOG() then only stores a hash of the format string plus the raw
+// arguments and the records are streamed to DEBUG_SERIAL_PORT in the background. Decode them on the
+// PC with scripts/BinaryLogDecoder.py. Best used together with DEBUG_SEPARATE_SERIAL.
+#if !defined(BINARY_LOGS)
+    #define BINARY_LOGS false
+#endif
+#if BINARY_LOGS == true
+    #ifndef BINARY_LOG_BUFFER_SIZE
+        #define BINARY_LOG_BUFFER_SIZE 512  // Bytes, must be a power of two
+    #endif
+    #ifndef BINARY_LOG_MAX_STRING
+        #define BINARY_LOG_MAX_STRING 24  // Longer string arguments are truncated
+    #endif
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                            ////////
@@ -212,6 +306,19 @@
     #define RA_TRACKING_LIMIT 7.0f
 #endif
 
+// Set AUTO_MERIDIAN_FLIP to 1 to flip to the other side of the pier and keep tracking the same position when tracking gets
+// within AUTO_MERIDIAN_FLIP_LEAD_MINUTES of RA_TRACKING_LIMIT, instead of stopping tracking at the limit. The host sees
+// 'FlipPending' in :GX# for AUTO_MERIDIAN_FLIP_PAUSE_SECONDS before the flip, so it can pause guiding. Can be changed with :XSF.
+#ifndef AUTO_MERIDIAN_FLIP
+    #define AUTO_MERIDIAN_FLIP 0
+#endif
+#ifndef AUTO_MERIDIAN_FLIP_LEAD_MINUTES
+    #define AUTO_MERIDIAN_FLIP_LEAD_MINUTES 5
+#endif
+#ifndef AUTO_MERIDIAN_FLIP_PAUSE_SECONDS
+    #define AUTO_MERIDIAN_FLIP_PAUSE_SECONDS 10
+#endif
+
 #ifndef RA_PHYSICAL_LIMIT
     #define RA_PHYSICAL_LIMIT 7.0f
 #endif
@@ -246,6 +353,20 @@
     #endif
 #endif
 
+// Set STEP_ENVELOPE to 1 to have the step generator keep RA and DEC inside their limits, whatever started the move (GoTo,
+// manual slew, :MX moves). RA may turn RA_PHYSICAL_LIMIT hours either way from home, DEC stays within the DEC limits. An
+// axis that gets within braking distance of the edge while moving outwards is decelerated to a stop.
+// STEP_ENVELOPE_RA_MAX_SPEED and STEP_ENVELOPE_DEC_MAX_SPEED cap the slew speed of the axis in steps/s, 0 for no cap.
+#ifndef STEP_ENVELOPE
+    #define STEP_ENVELOPE 0
+#endif
+#ifndef STEP_ENVELOPE_RA_MAX_SPEED
+    #define STEP_ENVELOPE_RA_MAX_SPEED 0
+#endif
+#ifndef STEP_ENVELOPE_DEC_MAX_SPEED
+    #define STEP_ENVELOPE_DEC_MAX_SPEED 0
+#endif
+
 ////////////////////////////
 //
 // GUIDE SETTINGS
@@ -259,6 +380,14 @@
     #define DEC_PULSE_MULTIPLIER 0.5f
 #endif
 
+// DITHER SETTLE TIME
+// After the guide pulses of a dither (:XMD) the mount reports 'Settling' in :GX# for DITHER_SETTLE_MS plus the time
+// the axes need to stop from the guide speed at their configured acceleration, and the time to take up BACKLASH_STEPS
+// if DEC had to turn around. Then it reports 'Settled'.
+#ifndef DITHER_SETTLE_MS
+    #define DITHER_SETTLE_MS 1000
+#endif
+
 ////////////////////////////
 //
 // INVERT AXIS
@@ -511,6 +640,64 @@
     #endif
 #endif
 
+// When the homing sensor pin can raise an interrupt (digitalPinToInterrupt() knows it), the stepper position is
+// latched in the interrupt at every sensor edge instead of when the main loop next polls the pin, so the found
+// range no longer depends on the slew speed or on how busy the loop is. Pins without an interrupt keep polling.
+#ifndef HALL_SENSOR_LATCH_EDGES
+    #define HALL_SENSOR_LATCH_EDGES 1
+#endif
+
+// Two phase homing: the search at full slew speed only locates the sensor range roughly, then the axis backs off
+// HALL_SENSOR_APPROACH_BACKOFF_DEGREES before the range and crosses both edges again at HALL_SENSOR_APPROACH_SLEW_RATE
+// (1 is slowest, 4 is full speed) to measure them. Set to 1 to enable.
+#ifndef HALL_SENSOR_SLOW_APPROACH
+    #define HALL_SENSOR_SLOW_APPROACH 0
+#endif
+#if HALL_SENSOR_SLOW_APPROACH == 1
+    #ifndef HALL_SENSOR_APPROACH_SLEW_RATE
+        #define HALL_SENSOR_APPROACH_SLEW_RATE 1
+    #endif
+    #ifndef HALL_SENSOR_APPROACH_BACKOFF_DEGREES
+        #define HALL_SENSOR_APPROACH_BACKOFF_DEGREES 2
+    #endif
+#endif
+
+//////////////////////////////////////////
+// StallGuard (sensorless) homing support
+//////////////////////////////////////////
+// Homes an axis that has no Hall sensor by driving it against its hard stop until the TMC2209 (UART) reports a stall,
+// then moving the homing offset (:XSHRnnn# / :XSHDnnn#, positive is away from the stop) back to home. Tune
+// RA_STALL_VALUE / DEC_STALL_VALUE so that the axis does not trigger while moving freely. With both axes enabled, the
+// guided startup homes automatically instead of asking to move the mount home by hand.
+// Enable StallGuard homing in your local configuration. Do not edit here!
+#ifndef USE_STALLGUARD_RA_AUTOHOME
+    #define USE_STALLGUARD_RA_AUTOHOME 0
+#elif USE_STALLGUARD_RA_AUTOHOME == 1
+    #ifndef RA_STALL_HOMING_DIRECTION
+        #define RA_STALL_HOMING_DIRECTION 1  // 1 if the hard stop is in the direction of increasing steps, else -1
+    #endif
+    #ifndef RA_STALL_HOMING_SEARCH_DEGREES
+        #define RA_STALL_HOMING_SEARCH_DEGREES 180
+    #endif
+    #ifndef RA_STALL_HOMING_SLEW_RATE
+        #define RA_STALL_HOMING_SLEW_RATE 2  // 1 to 4, as the slew rate. StallGuard needs some speed to measure the load
+    #endif
+#endif
+
+#ifndef USE_STALLGUARD_DEC_AUTOHOME
+    #define USE_STALLGUARD_DEC_AUTOHOME 0
+#elif USE_STALLGUARD_DEC_AUTOHOME == 1
+    #ifndef DEC_STALL_HOMING_DIRECTION
+        #define DEC_STALL_HOMING_DIRECTION 1  // 1 if the hard stop is in the direction of increasing steps, else -1
+    #endif
+    #ifndef DEC_STALL_HOMING_SEARCH_DEGREES
+        #define DEC_STALL_HOMING_SEARCH_DEGREES 180
+    #endif
+    #ifndef DEC_STALL_HOMING_SLEW_RATE
+        #define DEC_STALL_HOMING_SLEW_RATE 2  // 1 to 4, as the slew rate. StallGuard needs some speed to measure the load
+    #endif
+#endif
+
 // RA EndSwitch support
 //////////////////////////////////////////
 // Enable RA End Switches in your local configuration. Do not edit here!
@@ -645,8 +832,28 @@
 #endif
 
 // GPS
+// Once a fix has been applied, every new GPS second keeps the mount clock in step. Wire the receiver's PPS output to an
+// interrupt capable pin and define GPS_PPS_PIN to it to start the seconds on the PPS edge instead of when the sentence
+// comes in, and to correct the clock for the drift of the board's crystal/resonator.
 #if USE_GPS == 1
     #define GPS_BAUD_RATE 9600
+// #define GPS_PPS_PIN 19
+#endif
+
+// Gyro
+// The accelerometer is sampled in the background every GYRO_SAMPLE_MS and filtered over about GYRO_FILTER_SAMPLES
+// samples. Set GYRO_USE_FIFO to 1 to have the MPU6050 collect the samples in its FIFO and read a few at a time in one
+// I2C burst, which halves the bus transactions.
+#if USE_GYRO_LEVEL == 1
+    #ifndef GYRO_SAMPLE_MS
+        #define GYRO_SAMPLE_MS 20
+    #endif
+    #ifndef GYRO_FILTER_SAMPLES
+        #define GYRO_FILTER_SAMPLES 8
+    #endif
+    #ifndef GYRO_USE_FIFO
+        #define GYRO_USE_FIFO 0
+    #endif
 #endif
 
 ////////////////////////////
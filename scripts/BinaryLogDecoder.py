@@ -0,0 +1,194 @@
+"""
+Decoder for the binary log stream produced when the firmware is built with BINARY_LOGS set to true.
+
+The firmware does not send the text of a log message. Every LOG() call site sends the FNV-1a hash of its
+format string plus the raw argument values (see src/BinaryLog.hpp). This script scans the firmware sources
+for LOG() format strings, hashes them the same way and renders the messages just like the text logger would.
+
+USAGE:
+ - Capture the debug serial port to a file (e.g. with a terminal program set to raw/binary logging) and run
+       python BinaryLogDecoder.py capture.bin
+ - Or read the port directly (needs pyserial):
+       python BinaryLogDecoder.py --port COM4 --baud 115200
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MODULE_PATH = os.path.dirname(os.path.realpath(__file__))
+DEFAULT_SOURCE_DIR = os.path.join(MODULE_PATH, "..", "src")
+FRAME_SYNC = 0xA5
+SOURCE_EXTENSIONS = (".cpp", ".hpp", ".h", ".ino")
+
+# LOG(level, "format" "continued format", args...)
+LOG_PATTERN = re.compile(r'\bLOG\(\s*[^,"]+,\s*((?:"(?:[^"\\]|\\.)*"\s*)+)', re.DOTALL)
+STRING_PATTERN = re.compile(r'"((?:[^"\\]|\\.)*)"')
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+ARG_FORMATS = {
+    "c": ("<c", 1),
+    "h": ("<h", 2),
+    "H": ("<H", 2),
+    "i": ("<i", 4),
+    "I": ("<I", 4),
+    "f": ("<f", 4),
+}
+
+
+def fnv1a(text):
+    value = 2166136261
+    for byte in text.encode("latin-1"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def unescape(literal):
+    result = []
+    i = 0
+    while i < len(literal):
+        ch = literal[i]
+        if ch == "\\" and i + 1 < len(literal):
+            i += 1
+            result.append(ESCAPES.get(literal[i], literal[i]))
+        else:
+            result.append(ch)
+        i += 1
+    return "".join(result)
+
+
+def collect_formats(source_dir):
+    formats = {}
+    for root, _, files in os.walk(source_dir):
+        for name in files:
+            if not name.endswith(SOURCE_EXTENSIONS):
+                continue
+            path = os.path.join(root, name)
+            with open(path, "r", encoding="latin-1") as source:
+                content = source.read()
+            for match in LOG_PATTERN.finditer(content):
+                text = "".join(unescape(part) for part in STRING_PATTERN.findall(match.group(1)))
+                key = fnv1a(text)
+                if key in formats and formats[key] != text:
+                    print(f"WARNING: hash collision between '{formats[key]}' and '{text}'", file=sys.stderr)
+                formats[key] = text
+    return formats
+
+
+def parse_args(payload):
+    args = []
+    pos = 0
+    while pos < len(payload):
+        tag = chr(payload[pos])
+        pos += 1
+        if tag == "s":
+            length = payload[pos]
+            args.append(payload[pos + 1:pos + 1 + length].decode("latin-1"))
+            pos += 1 + length
+        elif tag in ARG_FORMATS:
+            fmt, size = ARG_FORMATS[tag]
+            value = struct.unpack(fmt, payload[pos:pos + size])[0]
+            args.append(value.decode("latin-1") if tag == "c" else value)
+            pos += size
+        else:
+            raise ValueError(f"unknown argument tag {tag!r}")
+    return args
+
+
+def render(fmt, args):
+    """Mirror of formatArg() in src/Utility.cpp."""
+    out = []
+    args = list(args)
+    i = 0
+    while i < len(fmt):
+        ch = fmt[i]
+        if ch != "%" or i + 1 == len(fmt):
+            out.append(ch)
+            i += 1
+            continue
+        spec = fmt[i + 1]
+        i += 2
+        if spec == "%":
+            out.append("%")
+        elif spec in "cdilsfx":
+            value = args.pop(0) if args else "<missing>"
+            if spec == "f" and isinstance(value, float):
+                out.append(f"{value:.4f}")
+            elif spec == "x" and isinstance(value, int):
+                out.append(f"0x{value & 0xFFFF:04X}")
+            else:
+                out.append(str(value))
+        else:
+            out.append(spec)
+    return "".join(out)
+
+
+def decode(stream, formats, out):
+    buffer = bytearray()
+    last_time = None
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buffer.extend(chunk)
+        while True:
+            start = buffer.find(bytes([FRAME_SYNC]))
+            if start < 0:
+                buffer.clear()
+                break
+            del buffer[:start]
+            if len(buffer) < 2 or len(buffer) < 2 + buffer[1]:
+                break
+            length = buffer[1]
+            frame = bytes(buffer[2:2 + length])
+            if length < 8:
+                del buffer[:1]
+                continue
+            record_id, timestamp = struct.unpack("<II", frame[:8])
+            try:
+                args = parse_args(frame[8:])
+            except (ValueError, IndexError, struct.error):
+                # Not a real frame, resynchronize on the next sync byte.
+                del buffer[:1]
+                continue
+            del buffer[:2 + length]
+
+            if record_id == 0:
+                text = f"*** {args[0] if args else '?'} log records dropped ***"
+            elif record_id in formats:
+                text = render(formats[record_id], args)
+            else:
+                text = f"<unknown id 0x{record_id:08X}> {args}"
+
+            delta = 0 if last_time is None else ((timestamp - last_time) & 0xFFFFFFFF)
+            last_time = timestamp
+            out.write(f"[{timestamp / 1000.0:.3f}]{{{delta / 1000.0:.3f}}}ms: {text}\n")
+            out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode OAT binary logs (BINARY_LOGS == true)")
+    parser.add_argument("capture", nargs="?", help="raw capture file, '-' for stdin")
+    parser.add_argument("--port", help="serial port to read from instead of a file")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate (default: %(default)s)")
+    parser.add_argument("--source", default=DEFAULT_SOURCE_DIR, help="firmware source folder (default: %(default)s)")
+    options = parser.parse_args()
+
+    formats = collect_formats(options.source)
+    print(f"Loaded {len(formats)} log formats from {os.path.abspath(options.source)}", file=sys.stderr)
+
+    if options.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        with serial.Serial(options.port, options.baud, timeout=1) as port:
+            decode(port, formats, sys.stdout)
+    elif options.capture and options.capture != "-":
+        with open(options.capture, "rb") as capture:
+            decode(capture, formats, sys.stdout)
+    else:
+        decode(sys.stdin.buffer, formats, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
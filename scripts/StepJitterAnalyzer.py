@@ -0,0 +1,180 @@
+"""
+Captures and analyzes the timing of the RA tracking steps.
+
+Needs firmware built with STEP_TIMING_CAPTURE set to 1. The script starts a capture (:XSJ1#), downloads the step
+timestamps (:XGJ#) for the requested time and then reports the step interval jitter and the resulting RA error in
+arcseconds, both raw and with the average rate error removed.
+
+Builds with NEW_STEPPER_LIB cannot capture, the stepper library issues the steps itself. They answer :XGJ# with "0"
+and the script stops with an error.
+
+USAGE:
+ - Capture from the mount (needs pyserial) and keep the raw data:
+       python StepJitterAnalyzer.py --port COM4 --duration 120 --save capture.csv
+ - Analyze a saved capture again (e.g. to compare firmware versions or boards):
+       python StepJitterAnalyzer.py --load capture.csv
+"""
+
+import argparse
+import csv
+import math
+import sys
+import time
+
+SIDEREAL_ARCSEC_PER_SECOND = 360.0 * 3600.0 / 86164.0905
+
+
+def send_command(port, command):
+    port.write(command.encode("ascii"))
+    reply = port.read_until(b"#").decode("ascii", errors="replace")
+    if not reply.endswith("#"):
+        raise IOError(f"No reply to {command}")
+    return reply[:-1]
+
+
+def read_mount_parameters(port):
+    """Returns (tracking steps per second, tracking steps per degree)."""
+    tracking_speed = float(send_command(port, ":XGT#"))
+    slew_steps_per_degree = float(send_command(port, ":XGR#"))
+    # "<RA driver>,<RA slewMS>,<RA trackMS>|..."
+    ra_driver = send_command(port, ":XGMS#").split("|")[0].split(",")
+    slew_ms, track_ms = float(ra_driver[1]), float(ra_driver[2])
+    return tracking_speed, slew_steps_per_degree * track_ms / slew_ms
+
+
+def capture(port, duration):
+    """Returns a list of segments. Each segment is a list of timestamps in seconds without gaps."""
+    segments = [[]]
+    last_raw = None
+    unwrapped = 0
+
+    send_command_no_reply(port, ":XSJ1#")
+    end_time = time.time() + duration
+    try:
+        while time.time() < end_time:
+            ticks, overruns, samples = parse_samples(send_command(port, ":XGJ#"))
+            if overruns and segments[-1]:
+                print(f"WARNING: {overruns} steps were lost, starting a new segment", file=sys.stderr)
+                segments.append([])
+                last_raw = None
+            for raw in samples:
+                if last_raw is not None:
+                    unwrapped += (raw - last_raw) & 0xFFFFFFFF
+                last_raw = raw
+                segments[-1].append(unwrapped / ticks)
+            if not samples:
+                time.sleep(0.05)
+    finally:
+        send_command_no_reply(port, ":XSJ0#")
+    return [segment for segment in segments if len(segment) > 2]
+
+
+def send_command_no_reply(port, command):
+    port.write(command.encode("ascii"))
+    port.flush()
+
+
+def parse_samples(reply):
+    parts = reply.split("|")
+    if len(parts) < 3:
+        raise IOError(f"Step timing capture not supported by firmware (reply '{reply}')")
+    samples = [int(value) for value in parts[2].split(",") if value]
+    return int(parts[0]), int(parts[1]), samples
+
+
+def stats(values):
+    mean = sum(values) / len(values)
+    variance = sum((value - mean) ** 2 for value in values) / len(values)
+    return mean, math.sqrt(variance), min(values), max(values)
+
+
+def detrend(times, values):
+    """Removes the least squares line through the values."""
+    n = len(times)
+    mean_t = sum(times) / n
+    mean_v = sum(values) / n
+    denominator = sum((t - mean_t) ** 2 for t in times)
+    slope = sum((t - mean_t) * (v - mean_v) for t, v in zip(times, values)) / denominator if denominator else 0.0
+    return [v - mean_v - slope * (t - mean_t) for t, v in zip(times, values)]
+
+
+def analyze(segments, tracking_speed, steps_per_degree):
+    expected_interval = 1.0 / tracking_speed
+    arcsec_per_step = 3600.0 / steps_per_degree
+    intervals = []
+    errors = []
+    detrended = []
+    for segment in segments:
+        intervals.extend(b - a for a, b in zip(segment, segment[1:]))
+        # Time error of every step against an ideal step train, converted into RA error
+        segment_errors = [(t - segment[0] - i * expected_interval) * SIDEREAL_ARCSEC_PER_SECOND
+                          for i, t in enumerate(segment)]
+        errors.extend(segment_errors)
+        detrended.extend(detrend(segment, segment_errors))
+
+    mean, sigma, low, high = stats(intervals)
+    print(f"Steps captured      : {sum(len(segment) for segment in segments)} in {len(segments)} segment(s)")
+    print(f"Tracking rate       : {tracking_speed:.5f} steps/s, {arcsec_per_step:.4f} arcsec/step")
+    print(f"Expected interval   : {expected_interval * 1e3:.4f} ms")
+    print(f"Measured interval   : mean {mean * 1e3:.4f} ms, stddev {sigma * 1e6:.2f} us, "
+          f"min {low * 1e3:.4f} ms, max {high * 1e3:.4f} ms")
+    print(f"Interval jitter     : {(high - low) * 1e6:.2f} us peak to peak, "
+          f"rate error {(expected_interval / mean - 1.0) * 1e6:.1f} ppm")
+    _, _, error_low, error_high = stats(errors)
+    print(f"RA error (raw)      : {math.sqrt(sum(e * e for e in errors) / len(errors)):.3f} arcsec RMS, "
+          f"{error_high - error_low:.3f} arcsec peak to peak")
+    _, _, detrended_low, detrended_high = stats(detrended)
+    print(f"RA error (detrended): {math.sqrt(sum(e * e for e in detrended) / len(detrended)):.3f} arcsec RMS, "
+          f"{detrended_high - detrended_low:.3f} arcsec peak to peak")
+
+
+def save(filename, segments, tracking_speed, steps_per_degree):
+    with open(filename, "w", newline="") as output:
+        writer = csv.writer(output)
+        writer.writerow(["tracking_speed", tracking_speed, "steps_per_degree", steps_per_degree])
+        writer.writerow(["segment", "time_s"])
+        for index, segment in enumerate(segments):
+            for timestamp in segment:
+                writer.writerow([index, f"{timestamp:.9f}"])
+
+
+def load(filename):
+    with open(filename, newline="") as source:
+        reader = csv.reader(source)
+        header = next(reader)
+        tracking_speed, steps_per_degree = float(header[1]), float(header[3])
+        next(reader)
+        segments = {}
+        for row in reader:
+            segments.setdefault(int(row[0]), []).append(float(row[1]))
+    return [segments[key] for key in sorted(segments)], tracking_speed, steps_per_degree
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Capture and analyze OAT RA tracking step timing")
+    parser.add_argument("--port", help="serial port of the mount")
+    parser.add_argument("--baud", type=int, default=19200, help="baud rate (default: %(default)s)")
+    parser.add_argument("--duration", type=float, default=60.0, help="capture time in seconds (default: %(default)s)")
+    parser.add_argument("--save", help="write the captured timestamps to this CSV file")
+    parser.add_argument("--load", help="analyze a previously saved CSV file instead of capturing")
+    options = parser.parse_args()
+
+    if options.load:
+        segments, tracking_speed, steps_per_degree = load(options.load)
+    elif options.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        with serial.Serial(options.port, options.baud, timeout=2) as port:
+            tracking_speed, steps_per_degree = read_mount_parameters(port)
+            segments = capture(port, options.duration)
+        if options.save:
+            save(options.save, segments, tracking_speed, steps_per_degree)
+    else:
+        parser.error("either --port or --load is required")
+
+    if not segments:
+        sys.exit("No steps captured. Is the mount tracking?")
+    analyze(segments, tracking_speed, steps_per_degree)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#include "../Configuration.hpp"
+#include "Utility.hpp"
+
+#if (DEBUG_LEVEL > 0) && (BINARY_LOGS == true)
+
+uint8_t BinaryLog::_buffer[BINARY_LOG_BUFFER_SIZE];
+uint16_t BinaryLog::_head    = 0;
+uint16_t BinaryLog::_tail    = 0;
+uint16_t BinaryLog::_dropped = 0;
+
+/////////////////////////////////
+//
+// reserve
+//
+/////////////////////////////////
+// Must be called with the critical section held. Checks that a record of the given length fits into
+// the ring. If earlier records were dropped, the drop notice is written first (and must fit as well).
+// Records longer than the length byte can express (too many string arguments) are dropped too.
+bool BinaryLog::reserve(uint16_t length)
+{
+    const uint8_t dropFrameLength = 13;  // sync, length, id, time, tag and 16-bit count
+    uint16_t used                 = (_head - _tail) & (BINARY_LOG_BUFFER_SIZE - 1);
+    uint16_t available            = BINARY_LOG_BUFFER_SIZE - 1 - used;
+    uint16_t needed               = length + 2 + ((_dropped != 0) ? dropFrameLength : 0);
+
+    if ((length > 0xFF) || (needed > available))
+    {
+        if (_dropped != 0xFFFF)
+        {
+            _dropped++;
+        }
+        return false;
+    }
+
+    if (_dropped != 0)
+    {
+        const uint32_t id  = 0;
+        const uint32_t now = micros();
+        put(FRAME_SYNC);
+        put(dropFrameLength - 2);
+        putValue(id);
+        putValue(now);
+        put('H');
+        putValue(_dropped);
+        _dropped = 0;
+    }
+    return true;
+}
+
+/////////////////////////////////
+//
+// drain
+//
+/////////////////////////////////
+void BinaryLog::drain()
+{
+    uint16_t head;
+    {
+        CriticalSection lock;
+        head = _head;
+    }
+
+    // Only this function moves the tail, so it can be read without locking.
+    uint16_t tail = _tail;
+    int room      = DEBUG_SERIAL_PORT.availableForWrite();
+    while ((tail != head) && (room > 0))
+    {
+        uint16_t chunk = ((head > tail) ? head : BINARY_LOG_BUFFER_SIZE) - tail;
+        if (chunk > static_cast<uint16_t>(room))
+        {
+            chunk = static_cast<uint16_t>(room);
+        }
+        DEBUG_SERIAL_PORT.write(_buffer + tail, chunk);
+        tail = (tail + chunk) & (BINARY_LOG_BUFFER_SIZE - 1);
+        room -= chunk;
+    }
+
+    CriticalSection lock;
+    _tail = tail;
+}
+
+#endif
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+#include "CriticalSection.hpp"
+
+// Deferred binary logging (BINARY_LOGS == true).
+//
+// Instead of formatting the message at the LOG() call site, only a 32-bit FNV-1a hash of the format
+// string (computed by the compiler) and the raw argument bytes are appended to a RAM ring buffer.
+// Appending costs a few dozen cycles and is safe from interruptLoop(). The ring is drained in the
+// background to DEBUG_SERIAL_PORT and scripts/BinaryLogDecoder.py turns the stream back into text
+// using the format strings it finds in the source tree.
+//
+// Frame layout (little endian):
+//   0xA5 | length | id (4 bytes) | micros() (4 bytes) | arguments...
+// length counts the bytes after the length byte. Each argument is a one byte tag followed by its value:
+//   'c' char (1 byte), 'h'/'H' signed/unsigned 16-bit, 'i'/'I' signed/unsigned 32-bit, 'f' float (4 bytes),
+//   's' string (1 length byte followed by at most BINARY_LOG_MAX_STRING characters).
+// Records whose arguments would not fit into the length byte are dropped and counted like an overflow.
+// When the ring overflows, records are dropped and the next record that fits is preceded by a frame
+// with id 0 and a single 'H' argument holding the number of records that were lost.
+class BinaryLog
+{
+  public:
+    static const uint8_t FRAME_SYNC = 0xA5;
+
+    // Compile-time FNV-1a hash of a format string, used as the record ID.
+    static constexpr uint32_t hash(const char *str, uint32_t h = 2166136261UL)
+    {
+        return (*str == 0) ? h : hash(str + 1, (h ^ static_cast<uint8_t>(*str)) * 16777619UL);
+    }
+
+    // Append a record for the given ID and arguments. Drops the record if the ring is full.
+    template <typename... Args>
+    static void write(uint32_t id, Args... args)
+    {
+        const uint16_t length = 8 + payloadSize(args...);
+        CriticalSection lock;
+        if (!reserve(length))
+        {
+            return;
+        }
+        put(FRAME_SYNC);
+        put(static_cast<uint8_t>(length));
+        const uint32_t now = micros();
+        putValue(id);
+        putValue(now);
+        putArgs(args...);
+    }
+
+    // Send as many pending bytes to DEBUG_SERIAL_PORT as it can take without blocking.
+    static void drain();
+
+  private:
+    static bool reserve(uint16_t length);
+
+    static void put(uint8_t b)
+    {
+        _buffer[_head] = b;
+        _head          = (_head + 1) & (BINARY_LOG_BUFFER_SIZE - 1);
+    }
+
+    template <typename T>
+    static void putValue(T value)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        for (uint8_t i = 0; i < sizeof(T); i++)
+        {
+            put(bytes[i]);
+        }
+    }
+
+    static uint8_t stringLength(const char *str)
+    {
+        uint8_t len = 0;
+        while ((len < BINARY_LOG_MAX_STRING) && (str[len] != 0))
+        {
+            len++;
+        }
+        return len;
+    }
+
+    static uint16_t payloadSize()
+    {
+        return 0;
+    }
+
+    template <typename T, typename... Args>
+    static uint16_t payloadSize(T first, Args... rest)
+    {
+        return argSize(first) + payloadSize(rest...);
+    }
+
+    static uint16_t argSize(char)
+    {
+        return 2;
+    }
+    static uint16_t argSize(int)
+    {
+        return 1 + sizeof(int);
+    }
+    static uint16_t argSize(unsigned int)
+    {
+        return 1 + sizeof(unsigned int);
+    }
+    static uint16_t argSize(long)
+    {
+        return 5;
+    }
+    static uint16_t argSize(unsigned long)
+    {
+        return 5;
+    }
+    static uint16_t argSize(double)
+    {
+        return 5;
+    }
+    static uint16_t argSize(const char *str)
+    {
+        return 2 + stringLength(str);
+    }
+
+    static void putArgs()
+    {
+    }
+
+    template <typename T, typename... Args>
+    static void putArgs(T first, Args... rest)
+    {
+        putArg(first);
+        putArgs(rest...);
+    }
+
+    static void putArg(char value)
+    {
+        put('c');
+        put(static_cast<uint8_t>(value));
+    }
+    static void putArg(int value)
+    {
+        put((sizeof(int) == 2) ? 'h' : 'i');
+        putValue(value);
+    }
+    static void putArg(unsigned int value)
+    {
+        put((sizeof(unsigned int) == 2) ? 'H' : 'I');
+        putValue(value);
+    }
+    static void putArg(long value)
+    {
+        const int32_t raw = value;
+        put('i');
+        putValue(raw);
+    }
+    static void putArg(unsigned long value)
+    {
+        const uint32_t raw = value;
+        put('I');
+        putValue(raw);
+    }
+    static void putArg(double value)
+    {
+        put('f');
+        putValue(static_cast<float>(value));
+    }
+    static void putArg(const char *str)
+    {
+        const uint8_t len = stringLength(str);
+        put('s');
+        put(len);
+        for (uint8_t i = 0; i < len; i++)
+        {
+            put(static_cast<uint8_t>(str[i]));
+        }
+    }
+
+    static uint8_t _buffer[BINARY_LOG_BUFFER_SIZE];
+    static uint16_t _head;
+    static uint16_t _tail;
+    static uint16_t _dropped;
+};
+
+// Forces the format string hash to be evaluated by the compiler.
+template <uint32_t Id>
+struct BinaryLogId {
+    enum : uint32_t
+    {
+        value = Id
+    };
+};
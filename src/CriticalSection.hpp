@@ -0,0 +1,39 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+#if defined(ESP32)
+extern portMUX_TYPE criticalSectionMux;
+#endif
+
+// Scoped guard that keeps the stepper servicing code from running while it is alive. On ATmega it masks the
+// timer interrupt. On ESP32 the stepper task runs on the other core, so interruptLoop() takes the same lock
+// around the state it shares with the main loop. Only guard a handful of instructions with this, and make no
+// FreeRTOS, Serial or LOG calls while it is held.
+class CriticalSection
+{
+  public:
+    CriticalSection()
+    {
+#if defined(ESP32)
+        portENTER_CRITICAL(&criticalSectionMux);
+#else
+        _sreg = SREG;
+        cli();
+#endif
+    }
+
+    ~CriticalSection()
+    {
+#if defined(ESP32)
+        portEXIT_CRITICAL(&criticalSectionMux);
+#else
+        SREG = _sreg;
+#endif
+    }
+
+  private:
+#if !defined(ESP32)
+    uint8_t _sreg;
+#endif
+};
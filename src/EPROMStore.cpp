@@ -6,6 +6,7 @@ POP_NO_WARNINGS
 #include "../Configuration.hpp"
 #include "Utility.hpp"
 #include "EPROMStore.hpp"
+#include "Profiler.hpp"
 
 // The platform-independant EEPROM class
 
@@ -71,6 +72,7 @@ void EEPROMStore::update(uint8_t location, uint8_t value)
 // Complete the transaction
 void EEPROMStore::commit()
 {
+    ProfileScope profile(PROFILE_EEPROM);
     LOG(DEBUG_EEPROM, "[EEPROM]: ESP32: Committing");
     EEPROM.commit();
 }
@@ -97,6 +99,7 @@ void EEPROMStore::initialize()
 // Update the given location with the given value
 void EEPROMStore::update(uint8_t location, uint8_t value)
 {
+    ProfileScope profile(PROFILE_EEPROM);
     LOG(DEBUG_EEPROM, "[EEPROM]: ATMega: Writing8 %x to %d", value, location);
     EEPROM.write(location, value);
 }
@@ -142,9 +145,13 @@ void EEPROMStore::displayContents()
     LOG(DEBUG_INFO, "[EEPROM]: Stored AZ Position: %l", getAZPosition());
     LOG(DEBUG_INFO, "[EEPROM]: Stored ALT Position: %l", getALTPosition());
     LOG(DEBUG_INFO, "[EEPROM]: Stored DEC Homing Offset : %l", getDECHomingOffset());
+    LOG(DEBUG_INFO, "[EEPROM]: Stored RA StallGuard Homing Offset: %l", getRAStallHomingOffset());
+    LOG(DEBUG_INFO, "[EEPROM]: Stored DEC StallGuard Homing Offset: %l", getDECStallHomingOffset());
     LOG(DEBUG_INFO, "[EEPROM]: Stored DEC Lower Limit: %l", getDECLowerLimit());
     LOG(DEBUG_INFO, "[EEPROM]: Stored DEC Upper Limit: %l", getDECUpperLimit());
     LOG(DEBUG_INFO, "[EEPROM]: Stored Last Flashed Version: %d", getLastFlashedVersion());
+    LOG(DEBUG_INFO, "[EEPROM]: PEC table? %s", (isPresentExtended(PEC_TABLE_MARKER_FLAG) ? "Yes" : "No"));
+    LOG(DEBUG_INFO, "[EEPROM]: Clock drift? %s", (isPresentExtended(CLOCK_DRIFT_MARKER_FLAG) ? "Yes" : "No"));
 #endif
 }
 
@@ -797,6 +804,74 @@ void EEPROMStore::storeDECHomingOffset(int32_t decHomingOffset)
     commit();  // Complete the transaction
 }
 
+// Whether a RA StallGuard homing offset has been stored. Homing must not use the 0 read back when it was never set.
+bool EEPROMStore::hasRAStallHomingOffset()
+{
+    return isPresentExtended(RA_STALL_HOMING_MARKER_FLAG);
+}
+
+// Get the configured RA Homing offset for StallGuard homing (slew microsteps from the hard stop to home).
+int32_t EEPROMStore::getRAStallHomingOffset()
+{
+    int32_t raStallHomingOffset(0);  // microsteps (slew)
+
+    if (isPresentExtended(RA_STALL_HOMING_MARKER_FLAG))
+    {
+        raStallHomingOffset = readInt32(RA_STALL_HOMING_OFFSET_ADDR);
+        LOG(DEBUG_EEPROM, "[EEPROM]: RA StallGuard Homing offset read as %l", raStallHomingOffset);
+    }
+    else
+    {
+        LOG(DEBUG_EEPROM, "[EEPROM]: No stored values for RA StallGuard Homing offset");
+    }
+
+    return raStallHomingOffset;  // microsteps (slew)
+}
+
+// Whether a DEC StallGuard homing offset has been stored. Homing must not use the 0 read back when it was never set.
+bool EEPROMStore::hasDECStallHomingOffset()
+{
+    return isPresentExtended(DEC_STALL_HOMING_MARKER_FLAG);
+}
+
+// Get the configured DEC Homing offset for StallGuard homing (slew microsteps from the hard stop to home).
+int32_t EEPROMStore::getDECStallHomingOffset()
+{
+    int32_t decStallHomingOffset(0);  // microsteps (slew)
+
+    if (isPresentExtended(DEC_STALL_HOMING_MARKER_FLAG))
+    {
+        decStallHomingOffset = readInt32(DEC_STALL_HOMING_OFFSET_ADDR);
+        LOG(DEBUG_EEPROM, "[EEPROM]: DEC StallGuard Homing offset read as %l", decStallHomingOffset);
+    }
+    else
+    {
+        LOG(DEBUG_EEPROM, "[EEPROM]: No stored values for DEC StallGuard Homing offset");
+    }
+
+    return decStallHomingOffset;  // microsteps (slew)
+}
+
+// Store the configured RA Homing offset for StallGuard homing (slew microsteps from the hard stop to home).
+void EEPROMStore::storeRAStallHomingOffset(int32_t raStallHomingOffset)
+{
+    LOG(DEBUG_EEPROM, "[EEPROM]: Write: Updating RA StallGuard Homing offset to %l", raStallHomingOffset);
+
+    updateInt32(RA_STALL_HOMING_OFFSET_ADDR, raStallHomingOffset);
+    updateFlagsExtended(RA_STALL_HOMING_MARKER_FLAG);
+    commit();  // Complete the transaction
+}
+
+// Store the configured DEC Homing offset for StallGuard homing (slew microsteps from the hard stop to home).
+void EEPROMStore::storeDECStallHomingOffset(int32_t decStallHomingOffset)
+{
+    LOG(DEBUG_EEPROM, "[EEPROM]: Write: Updating DEC StallGuard Homing offset to %l", decStallHomingOffset);
+
+    updateInt32(DEC_STALL_HOMING_OFFSET_ADDR, decStallHomingOffset);
+    updateFlagsExtended(DEC_STALL_HOMING_MARKER_FLAG);
+    commit();  // Complete the transaction
+}
+
 // Get the current AZ position from home (in steps)
 int32_t EEPROMStore::getAZPosition()
 {
@@ -852,3 +927,67 @@ void EEPROMStore::storeALTPosition(int32_t altPosition)
     updateFlagsExtended(ALT_POSITION_MARKER_FLAG);
     commit();  // Complete the transaction
 }
+
+// Get the PEC table (in 1/16 arcsec per segment) if it was recorded with the given steps per cycle
+bool EEPROMStore::getPECTable(int8_t *table, uint8_t count, int32_t cycleSteps)
+{
+    if (!isPresentExtended(PEC_TABLE_MARKER_FLAG))
+    {
+        LOG(DEBUG_EEPROM, "[EEPROM]: No stored PEC table");
+        return false;
+    }
+
+    int32_t storedCycleSteps = readInt32(PEC_CYCLE_STEPS_ADDR);
+    if ((storedCycleSteps != cycleSteps) || (count > PEC_TABLE_SIZE))
+    {
+        LOG(DEBUG_EEPROM, "[EEPROM]: Stored PEC table is for %l steps per cycle, not %l. Ignored.", storedCycleSteps, cycleSteps);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        table[i] = static_cast<int8_t>(read(PEC_TABLE_ADDR + i));
+    }
+    LOG(DEBUG_EEPROM, "[EEPROM]: PEC table read for %l steps per cycle", cycleSteps);
+    return true;
+}
+
+// Store the PEC table (in 1/16 arcsec per segment) and the steps per cycle it was recorded with
+void EEPROMStore::storePECTable(const int8_t *table, uint8_t count, int32_t cycleSteps)
+{
+    LOG(DEBUG_EEPROM, "[EEPROM]: Write: Updating PEC table for %l steps per cycle", cycleSteps);
+
+    updateInt32(PEC_CYCLE_STEPS_ADDR, cycleSteps);
+    for (uint8_t i = 0; (i < count) && (i < PEC_TABLE_SIZE); i++)
+    {
+        update(PEC_TABLE_ADDR + i, static_cast<uint8_t>(table[i]));
+    }
+    updateFlagsExtended(PEC_TABLE_MARKER_FLAG);
+    commit();  // Complete the transaction
+}
+
+// Return the stored drift of the clock and the error of that estimate, in ppm
+bool EEPROMStore::getClockDrift(float &driftPpm, float &errorPpm)
+{
+    if (!isPresentExtended(CLOCK_DRIFT_MARKER_FLAG))
+    {
+        LOG(DEBUG_EEPROM, "[EEPROM]: No stored clock drift");
+        return false;
+    }
+
+    driftPpm = readInt32(CLOCK_DRIFT_ADDR) / 100.0f;
+    errorPpm = readInt16(CLOCK_DRIFT_ERROR_ADDR) / 100.0f;
+    LOG(DEBUG_EEPROM, "[EEPROM]: Clock drift read as %f ppm (+/- %f)", driftPpm, errorPpm);
+    return true;
+}
+
+// Store the drift of the clock and the error of that estimate, in ppm (stored as ppm * 100)
+void EEPROMStore::storeClockDrift(float driftPpm, float errorPpm)
+{
+    LOG(DEBUG_EEPROM, "[EEPROM]: Write: Updating clock drift to %f ppm (+/- %f)", driftPpm, errorPpm);
+
+    updateInt32(CLOCK_DRIFT_ADDR, static_cast<int32_t>(roundf(driftPpm * 100.0f)));
+    updateInt16(CLOCK_DRIFT_ERROR_ADDR, static_cast<int16_t>(roundf(constrain(errorPpm, 0.0f, 327.0f) * 100.0f)));
+    updateFlagsExtended(CLOCK_DRIFT_MARKER_FLAG);
+    commit();  // Complete the transaction
+}
@@ -59,6 +59,14 @@ class EEPROMStore
     static int32_t getDECHomingOffset();
     static void storeDECHomingOffset(int32_t decHomingOffset);
 
+    static bool hasRAStallHomingOffset();
+    static int32_t getRAStallHomingOffset();
+    static void storeRAStallHomingOffset(int32_t raStallHomingOffset);
+
+    static bool hasDECStallHomingOffset();
+    static int32_t getDECStallHomingOffset();
+    static void storeDECStallHomingOffset(int32_t decStallHomingOffset);
+
     static int16_t getLastFlashedVersion();
     static void storeLastFlashedVersion(int16_t lastVersion);
 
@@ -68,6 +76,13 @@ class EEPROMStore
     static int32_t getALTPosition();
     static void storeALTPosition(int32_t altPosition);
 
+    // The PEC table is only returned if it was recorded with the same number of steps per cycle.
+    static bool getPECTable(int8_t *table, uint8_t count, int32_t cycleSteps);
+    static void storePECTable(const int8_t *table, uint8_t count, int32_t cycleSteps);
+
+    static bool getClockDrift(float &driftPpm, float &errorPpm);
+    static void storeClockDrift(float driftPpm, float errorPpm);
+
   private:
     /////////////////////////////////
     //
@@ -91,7 +106,11 @@ class EEPROMStore
     // If Location 5 is 0xCF, then an extended 16-bit flag is stored in 21/22 and
     // indicates the additional fields that have been stored: 0000 0000 0000 0000
     //                                                        ^^^^ ^^^^ ^^^^ ^^^^
-    //                                                               || |||| ||||
+    //                                                          || |||| |||| ||||
+    //          DEC StallGuard Homing Offset (144-147) ---------+| |||| |||| ||||
+    //           RA StallGuard Homing Offset (140-143) ----------+ |||| |||| ||||
+    //     Clock drift (134-137) and its error (138-139) ----------+||| |||| ||||
+    //    PEC steps per cycle (66-69), table (70-133) --------------+|| |||| ||||
     //                           ALT position (62-65) ---------------+| |||| ||||
     //                            AZ Position (58-61) ----------------+ |||| ||||
     //                   Last flashed version (56-57) ------------------+||| ||||
@@ -127,16 +146,20 @@ class EEPROMStore
     enum ExtendedItemFlag
     {
         // The marker bits for the extended values
-        PARKING_POS_MARKER_FLAG    = 0x0001,
-        DEC_LIMIT_MARKER_FLAG      = 0x0002,
-        UTC_OFFSET_MARKER_FLAG     = 0x0004,
-        RA_HOMING_MARKER_FLAG      = 0x0008,
-        RA_NORM_STEPS_MARKER_FLAG  = 0x0010,
-        DEC_NORM_STEPS_MARKER_FLAG = 0x0020,
-        DEC_HOMING_MARKER_FLAG     = 0x0040,
-        LAST_FLASHED_MARKER_FLAG   = 0x0080,
-        AZ_POSITION_MARKER_FLAG    = 0x0100,
-        ALT_POSITION_MARKER_FLAG   = 0x0200,
+        PARKING_POS_MARKER_FLAG      = 0x0001,
+        DEC_LIMIT_MARKER_FLAG        = 0x0002,
+        UTC_OFFSET_MARKER_FLAG       = 0x0004,
+        RA_HOMING_MARKER_FLAG        = 0x0008,
+        RA_NORM_STEPS_MARKER_FLAG    = 0x0010,
+        DEC_NORM_STEPS_MARKER_FLAG   = 0x0020,
+        DEC_HOMING_MARKER_FLAG       = 0x0040,
+        LAST_FLASHED_MARKER_FLAG     = 0x0080,
+        AZ_POSITION_MARKER_FLAG      = 0x0100,
+        ALT_POSITION_MARKER_FLAG     = 0x0200,
+        PEC_TABLE_MARKER_FLAG        = 0x0400,
+        CLOCK_DRIFT_MARKER_FLAG      = 0x0800,
+        RA_STALL_HOMING_MARKER_FLAG  = 0x1000,
+        DEC_STALL_HOMING_MARKER_FLAG = 0x2000,
     };
 
     // These are the offsets to each item stored in the EEPROM
@@ -209,7 +232,27 @@ class EEPROMStore
         _ALT_POSITION_ADDR_1,
         _ALT_POSITION_ADDR_2,
         _ALT_POSITION_ADDR_3,
-        STORE_SIZE = 66
+        PEC_CYCLE_STEPS_ADDR = 66,
+        _PEC_CYCLE_STEPS_ADDR_1,
+        _PEC_CYCLE_STEPS_ADDR_2,
+        _PEC_CYCLE_STEPS_ADDR_3,  // Int32
+        PEC_TABLE_ADDR = 70,      // PEC_TABLE_SIZE x Int8
+        PEC_TABLE_SIZE = 64,
+        CLOCK_DRIFT_ADDR = 134,
+        _CLOCK_DRIFT_ADDR_1,
+        _CLOCK_DRIFT_ADDR_2,
+        _CLOCK_DRIFT_ADDR_3,  // Int32
+        CLOCK_DRIFT_ERROR_ADDR = 138,
+        _CLOCK_DRIFT_ERROR_ADDR_1,  // Int16
+        RA_STALL_HOMING_OFFSET_ADDR = 140,
+        _RA_STALL_HOMING_OFFSET_ADDR_1,
+        _RA_STALL_HOMING_OFFSET_ADDR_2,
+        _RA_STALL_HOMING_OFFSET_ADDR_3,  // Int32
+        DEC_STALL_HOMING_OFFSET_ADDR = 144,
+        _DEC_STALL_HOMING_OFFSET_ADDR_1,
+        _DEC_STALL_HOMING_OFFSET_ADDR_2,
+        _DEC_STALL_HOMING_OFFSET_ADDR_3,  // Int32
+        STORE_SIZE = 148
     };
 
     // Helper functions
@@ -24,6 +24,8 @@ EndSwitch::EndSwitch(Mount *mount, StepperAxis axis, int minPin, int maxPin, int
     _posWhenTriggered = 0;
     pinMode(_minPin, INPUT_PULLUP);
     pinMode(_maxPin, INPUT_PULLUP);
+    _minInput.attach(_minPin);
+    _maxInput.attach(_maxPin);
 }
 
 /////////////////////////////////
@@ -41,7 +43,7 @@ void EndSwitch::processEndSwitchState()
     {
         case EndSwitchState::SWITCH_NOT_ACTIVE:
             {
-                if (digitalRead(_minPin) == _activeState)
+                if (_minInput.read() == _activeState)
                 {
                     _state            = EndSwitchState::SWITCH_AT_MINIMUM;
                     _posWhenTriggered = _pMount->getCurrentStepperPosition(_dir);
@@ -53,7 +55,7 @@ void EndSwitch::processEndSwitchState()
                         _pMount->mountStatus());
                 }
 
-                if (digitalRead(_maxPin) == _activeState)
+                if (_maxInput.read() == _activeState)
                 {
                     _state            = EndSwitchState::SWITCH_AT_MAXIMUM;
                     _posWhenTriggered = _pMount->getCurrentStepperPosition(_dir);
@@ -75,7 +77,7 @@ void EndSwitch::processEndSwitchState()
 
         case EndSwitchState::SWITCH_SLEWING_OFF_MINIMUM:
             {
-                if (digitalRead(_minPin) == _inactiveState)
+                if (_minInput.read() == _inactiveState)
                 {
                     _state = EndSwitchState::SWITCH_NOT_ACTIVE;
                     LOG(DEBUG_MOUNT,
@@ -86,7 +88,7 @@ void EndSwitch::processEndSwitchState()
             break;
         case EndSwitchState::SWITCH_SLEWING_OFF_MAXIMUM:
             {
-                if (digitalRead(_maxPin) == _inactiveState)
+                if (_maxInput.read() == _inactiveState)
                 {
                     _state = EndSwitchState::SWITCH_NOT_ACTIVE;
                     LOG(DEBUG_MOUNT,
@@ -3,6 +3,7 @@
 
 #include "Types.hpp"
 #include "Mount.hpp"
+#include "FastPin.hpp"
 
 #if (USE_RA_END_SWITCH == 1 || USE_DEC_END_SWITCH == 1)
 
@@ -36,6 +37,8 @@ class EndSwitch
     int _dir;
     int _minPin;
     int _maxPin;
+    FastInputPin _minInput;  // Read in processEndSwitchState(), which runs in the stepper interrupt
+    FastInputPin _maxInput;
 
   public:
     EndSwitch(Mount *mount, StepperAxis axis, int minPin, int maxPin, int activeState);
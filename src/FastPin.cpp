@@ -0,0 +1,53 @@
+#include "../Configuration.hpp"
+#include "Utility.hpp"
+#include "FastPin.hpp"
+
+#define FAST_PIN_BENCHMARK_READS 256
+
+/////////////////////////////////
+//
+// logReadCost
+//
+/////////////////////////////////
+void FastInputPin::logReadCost(int pin)
+{
+#if (DEBUG_LEVEL & DEBUG_MOUNT)
+    FastInputPin fastPin;
+    fastPin.attach(pin);
+    int highCount = 0;
+
+    // Interrupts stay enabled, so this is an upper bound. Use the smallest of a few runs to keep them out.
+    unsigned long digitalReadUs = 0xFFFFFFFFUL;
+    unsigned long fastReadUs    = 0xFFFFFFFFUL;
+    for (int run = 0; run < 4; run++)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < FAST_PIN_BENCHMARK_READS; i++)
+        {
+            highCount += digitalRead(pin);
+        }
+        unsigned long middle = micros();
+        for (int i = 0; i < FAST_PIN_BENCHMARK_READS; i++)
+        {
+            highCount += fastPin.read();
+        }
+        unsigned long end = micros();
+        digitalReadUs     = min(digitalReadUs, middle - start);
+        fastReadUs        = min(fastReadUs, end - middle);
+    }
+
+    // Includes the loop overhead, which is the same for both
+    const unsigned long cyclesPerUs   = F_CPU / 1000000UL;
+    const unsigned long digitalCycles = digitalReadUs * cyclesPerUs / FAST_PIN_BENCHMARK_READS;
+    const unsigned long fastCycles    = fastReadUs * cyclesPerUs / FAST_PIN_BENCHMARK_READS;
+    LOG(DEBUG_MOUNT,
+        "[FASTPIN]: Pin %d read costs %l cycles with digitalRead(), %l cycles from the port register (%l saved, %d high)",
+        pin,
+        digitalCycles,
+        fastCycles,
+        digitalCycles - fastCycles,
+        highCount);
+#else
+    (void) pin;
+#endif
+}
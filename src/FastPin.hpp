@@ -0,0 +1,44 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+/////////////////////////////////
+//
+// class FastInputPin
+//
+/////////////////////////////////
+// Reads a digital input straight from its port input register. The register and bit mask are looked up once in
+// attach(), so a read is a load and a mask instead of the table lookups and PWM timer check digitalRead() does on
+// every call. Meant for the pins that are polled from interruptLoop() (end switches, Hall sensors).
+class FastInputPin
+{
+  public:
+#if defined(ESP32)
+    typedef uint32_t port_t;
+#else
+    typedef uint8_t port_t;
+#endif
+
+    FastInputPin() : _port(nullptr), _mask(0)
+    {
+    }
+
+    void attach(int pin)
+    {
+        _port = portInputRegister(digitalPinToPort(pin));
+        _mask = digitalPinToBitMask(pin);
+    }
+
+    // Returns HIGH or LOW, like digitalRead()
+    int read() const
+    {
+        return (*_port & _mask) ? HIGH : LOW;
+    }
+
+    // Measures what a digitalRead() and a read() of the pin cost in CPU cycles and logs it under DEBUG_MOUNT
+    static void logReadCost(int pin);
+
+  private:
+    volatile port_t *_port;
+    port_t _mask;
+};
@@ -0,0 +1,220 @@
+#include "../Configuration.hpp"
+#include "GuideRateLearner.hpp"
+
+#if GUIDE_RATE_LEARNING != 0
+
+// Pulses needed before the typical pulse size is known well enough to reject outliers
+const unsigned long warmupPulses = 8;
+// A pulse is an outlier when it is this many times larger than the typical pulse ...
+const float outlierFactor = 5.0f;
+// ... and larger than this, so that a very quiet guiding session does not reject every correction
+const float minimumOutlierArcsec = 2.0f;
+// Bins whose residual is larger than this many standard deviations are dropped from the fit
+const float clipSigmas = 2.5f;
+// Minimum number of bins for a fit
+const uint8_t minimumBins = 8;
+// The slope must be at least this many standard errors away from zero to be valid
+const float significanceSigmas = 3.0f;
+
+GuideRateLearner::GuideRateLearner()
+{
+    reset();
+}
+
+/////////////////////////////////
+//
+// reset
+//
+/////////////////////////////////
+void GuideRateLearner::reset()
+{
+    _binHead         = 0;
+    _binCount        = 0;
+    _startMs         = 0;
+    _binStartSeconds = 0;
+    _netArcsec       = 0;
+    _meanAbsArcsec   = 0;
+    _pulses          = 0;
+    _rejectedPulses  = 0;
+}
+
+/////////////////////////////////
+//
+// addPulse
+//
+/////////////////////////////////
+bool GuideRateLearner::addPulse(unsigned long nowMs, float netArcsec)
+{
+    if ((_pulses == 0) && (_binCount == 0))
+    {
+        _startMs = nowMs;
+    }
+
+    const float size = fabsf(netArcsec);
+    if ((_pulses >= warmupPulses) && (size > outlierFactor * _meanAbsArcsec) && (size > minimumOutlierArcsec))
+    {
+        _rejectedPulses++;
+    }
+    else
+    {
+        _pulses++;
+        _netArcsec += netArcsec;
+        // Plain mean during warmup, then a running mean that follows changing seeing
+        _meanAbsArcsec += (size - _meanAbsArcsec) / min(_pulses, 4 * warmupPulses);
+    }
+
+    const unsigned long seconds = (nowMs - _startMs) / 1000UL;
+    if (seconds - _binStartSeconds < GUIDE_RATE_LEARNING_BIN_SECONDS)
+    {
+        return false;
+    }
+
+    Bin &bin         = _bins[_binHead];
+    bin.endSeconds   = seconds;
+    bin.netArcsec    = _netArcsec;
+    _binHead         = (_binHead + 1) % GUIDE_RATE_LEARNING_BINS;
+    _binStartSeconds = seconds;
+    if (_binCount < GUIDE_RATE_LEARNING_BINS)
+    {
+        _binCount++;
+    }
+    return true;
+}
+
+/////////////////////////////////
+//
+// binAt
+//
+/////////////////////////////////
+// Returns the bin at the given index, 0 being the oldest.
+const GuideRateLearner::Bin &GuideRateLearner::binAt(uint8_t index) const
+{
+    return _bins[(_binHead + GUIDE_RATE_LEARNING_BINS - _binCount + index) % GUIDE_RATE_LEARNING_BINS];
+}
+
+/////////////////////////////////
+//
+// solve
+//
+/////////////////////////////////
+// Least squares line through the bins that are not skipped. x is in hours and y in arcseconds, both
+// relative to the oldest bin to keep the float sums small.
+bool GuideRateLearner::solve(const bool *skip, float &slope, float &intercept, float &sigma, float &sxx, uint8_t &count) const
+{
+    const Bin &first = binAt(0);
+    float sumX       = 0;
+    float sumY       = 0;
+    count            = 0;
+    for (uint8_t i = 0; i < _binCount; i++)
+    {
+        if (!skip[i])
+        {
+            const Bin &bin = binAt(i);
+            sumX += (bin.endSeconds - first.endSeconds) / 3600.0f;
+            sumY += bin.netArcsec - first.netArcsec;
+            count++;
+        }
+    }
+    if (count < 3)
+    {
+        return false;
+    }
+
+    const float meanX = sumX / count;
+    const float meanY = sumY / count;
+    float sxy         = 0;
+    sxx               = 0;
+    for (uint8_t i = 0; i < _binCount; i++)
+    {
+        if (!skip[i])
+        {
+            const Bin &bin = binAt(i);
+            const float dx = (bin.endSeconds - first.endSeconds) / 3600.0f - meanX;
+            sxx += dx * dx;
+            sxy += dx * (bin.netArcsec - first.netArcsec - meanY);
+        }
+    }
+    if (sxx <= 0)
+    {
+        return false;
+    }
+    slope     = sxy / sxx;
+    intercept = meanY - slope * meanX;
+
+    float sumSquares = 0;
+    for (uint8_t i = 0; i < _binCount; i++)
+    {
+        if (!skip[i])
+        {
+            const Bin &bin       = binAt(i);
+            const float x        = (bin.endSeconds - first.endSeconds) / 3600.0f;
+            const float residual = bin.netArcsec - first.netArcsec - (intercept + slope * x);
+            sumSquares += residual * residual;
+        }
+    }
+    sigma = sqrtf(sumSquares / (count - 2));
+    return true;
+}
+
+/////////////////////////////////
+//
+// fit
+//
+/////////////////////////////////
+GuideRateLearner::Fit GuideRateLearner::fit() const
+{
+    Fit result;
+    memset(&result, 0, sizeof(result));
+
+    bool skip[GUIDE_RATE_LEARNING_BINS];
+    memset(skip, 0, sizeof(skip));
+    float slope;
+    float intercept;
+    float sigma;
+    float sxx;
+    uint8_t count;
+    if (!solve(skip, slope, intercept, sigma, sxx, count))
+    {
+        return result;
+    }
+
+    // Drop the bins that do not fit the line and fit again without them
+    const Bin &first = binAt(0);
+    bool clipped     = false;
+    for (uint8_t i = 0; i < _binCount; i++)
+    {
+        const Bin &bin       = binAt(i);
+        const float x        = (bin.endSeconds - first.endSeconds) / 3600.0f;
+        const float residual = bin.netArcsec - first.netArcsec - (intercept + slope * x);
+        if (fabsf(residual) > clipSigmas * sigma)
+        {
+            skip[i] = true;
+            clipped = true;
+        }
+    }
+    if (clipped && !solve(skip, slope, intercept, sigma, sxx, count))
+    {
+        return result;
+    }
+
+    uint8_t firstUsed = 0;
+    uint8_t lastUsed  = _binCount - 1;
+    while (skip[firstUsed])
+    {
+        firstUsed++;
+    }
+    while (skip[lastUsed])
+    {
+        lastUsed--;
+    }
+
+    result.bins                = count;
+    result.spanSeconds         = binAt(lastUsed).endSeconds - binAt(firstUsed).endSeconds;
+    result.arcsecPerHour       = slope;
+    result.stdErrArcsecPerHour = sigma / sqrtf(sxx);
+    result.valid               = (count >= minimumBins) && (result.spanSeconds >= GUIDE_RATE_LEARNING_MIN_MINUTES * 60UL);
+    result.valid               = result.valid && (fabsf(slope) > significanceSigmas * result.stdErrArcsecPerHour);
+    return result;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+#if GUIDE_RATE_LEARNING != 0
+
+/////////////////////////////////
+//
+// class GuideRateLearner
+//
+/////////////////////////////////
+// Learns the RA tracking rate error from the guide pulses of a session. A mount that tracks slightly
+// too slow or too fast makes the guider send more pulses in one direction, so the accumulated net RA
+// correction grows linearly over time and its slope is the rate error.
+// The net displacement of the pulses is summed into bins of GUIDE_RATE_LEARNING_BIN_SECONDS and a
+// straight line is fitted through the last GUIDE_RATE_LEARNING_BINS bins. Single pulses that are much
+// larger than the usual corrections (e.g. dithering or a jump to another star) are not counted and
+// bins that do not fit the line are dropped from the fit.
+class GuideRateLearner
+{
+  public:
+    struct Fit {
+        bool valid;                 // Enough data over a long enough time and the slope is significant
+        uint8_t bins;               // Number of bins used for the fit
+        unsigned long spanSeconds;  // Time covered by the bins
+        float arcsecPerHour;        // Slope of the net correction, positive means the mount tracks too slow
+        float stdErrArcsecPerHour;  // Standard error of the slope
+    };
+
+    GuideRateLearner();
+
+    // Discards all history, e.g. when tracking stops or the mount slews to another target.
+    void reset();
+
+    // Adds the net RA displacement of a finished guide pulse. Returns true when a bin was completed.
+    bool addPulse(unsigned long nowMs, float netArcsec);
+
+    Fit fit() const;
+
+    unsigned long getRejectedPulses() const
+    {
+        return _rejectedPulses;
+    }
+
+  private:
+    struct Bin {
+        unsigned long endSeconds;  // Seconds since the first pulse
+        float netArcsec;           // Accumulated net correction at the end of the bin
+    };
+
+    const Bin &binAt(uint8_t index) const;
+    bool solve(const bool *skip, float &slope, float &intercept, float &sigma, float &sxx, uint8_t &count) const;
+
+    Bin _bins[GUIDE_RATE_LEARNING_BINS];
+    uint8_t _binHead;
+    uint8_t _binCount;
+    unsigned long _startMs;
+    unsigned long _binStartSeconds;
+    float _netArcsec;
+    float _meanAbsArcsec;  // Running mean of the size of accepted pulses
+    unsigned long _pulses;
+    unsigned long _rejectedPulses;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "../Configuration.hpp"
 #include "Utility.hpp"
 #include "Gyro.hpp"
+#include "libs/FixedTrig/FixedTrig.hpp"
 
 #if USE_GYRO_LEVEL == 1
 
@@ -16,6 +17,35 @@ POP_NO_WARNINGS
  * */
 
 bool Gyro::isPresent(false);
+bool Gyro::isSampling(false);
+uint8_t Gyro::sampleCount(0);
+int16_t Gyro::history[SAMPLE_CHANNELS][2];
+int32_t Gyro::filtered[SAMPLE_CHANNELS];
+
+void Gyro::writeRegister(uint8_t reg, uint8_t value)
+/* Executes a 1 byte write to the given register.
+*/
+{
+    Wire.beginTransmission(MPU6050_I2C_ADDR);
+    Wire.write(reg);
+    Wire.write(value);
+    Wire.endTransmission(true);
+}
+
+void Gyro::readRegisters(uint8_t reg, uint8_t *buffer, uint8_t count)
+/* Executes a count byte burst read starting at the given register.
+   Reading MPU6050_REG_FIFO_R_W returns the next count bytes from the FIFO.
+*/
+{
+    Wire.beginTransmission(MPU6050_I2C_ADDR);
+    Wire.write(reg);
+    Wire.endTransmission(false);
+    Wire.requestFrom(MPU6050_I2C_ADDR, static_cast<int>(count), 1);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buffer[i] = Wire.read();
+    }
+}
 
 void Gyro::startup()
 /* Starts up the MPU-6050 device.
@@ -42,17 +72,17 @@ void Gyro::startup()
         return;
     }
 
-    // Execute 1 byte write to MPU6050_REG_PWR_MGMT_1
-    Wire.beginTransmission(MPU6050_I2C_ADDR);
-    Wire.write(MPU6050_REG_PWR_MGMT_1);
-    Wire.write(0);  // Disable sleep, 8 MHz clock
-    Wire.endTransmission(true);
+    writeRegister(MPU6050_REG_PWR_MGMT_1, 0);                   // Disable sleep, 8 MHz clock
+    writeRegister(MPU6050_REG_CONFIG, 6);                       // 5Hz bandwidth (lowest) for smoothing
+    writeRegister(MPU6050_REG_SMPLRT_DIV, GYRO_SAMPLE_MS - 1);  // 1kHz / (1 + divider), one sample per GYRO_SAMPLE_MS
+    #if GYRO_USE_FIFO == 1
+    writeRegister(MPU6050_REG_FIFO_EN, 0x88);    // Accelerometer and temperature into the FIFO
+    writeRegister(MPU6050_REG_USER_CTRL, 0x44);  // Enable and reset the FIFO
+    #endif
 
-    // Execute 1 byte write to MPU6050_REG_PWR_MGMT_1
-    Wire.beginTransmission(MPU6050_I2C_ADDR);
-    Wire.write(MPU6050_REG_CONFIG);
-    Wire.write(6);  // 5Hz bandwidth (lowest) for smoothing
-    Wire.endTransmission(true);
+    // The filter starts over from the first sample
+    sampleCount = 0;
+    isSampling  = true;
 
     LOG(DEBUG_INFO, "[GYRO]:: Started");
 }
@@ -63,43 +93,131 @@ void Gyro::shutdown()
 */
 {
     LOG(DEBUG_INFO, "[GYRO]: Shutdown");
-    // Nothing to do
+    isSampling  = false;
+    sampleCount = 0;
+}
+
+void Gyro::addSample(const uint8_t *data)
+/* Adds a raw sample (big endian X, Y, Z acceleration and temperature) to the filter.
+   Each channel takes the median of the last three values, which drops single spikes (e.g. from knocking
+   the mount), and smooths that with an IIR filter over about GYRO_FILTER_SAMPLES samples.
+*/
+{
+    for (int channel = 0; channel < SAMPLE_CHANNELS; channel++)
+    {
+        const int16_t value = static_cast<int16_t>(data[2 * channel] << 8 | data[2 * channel + 1]);
+        if (sampleCount == 0)
+        {
+            history[channel][0] = value;
+            history[channel][1] = value;
+            filtered[channel]   = value * 256L;
+            continue;
+        }
+
+        // Median of three
+        const int16_t a     = history[channel][0];
+        const int16_t b     = history[channel][1];
+        int16_t median      = max(min(a, b), min(max(a, b), value));
+        history[channel][1] = a;
+        history[channel][0] = value;
+
+        filtered[channel] += (median * 256L - filtered[channel]) / GYRO_FILTER_SAMPLES;
+    }
+    if (sampleCount < 2)
+    {
+        sampleCount++;
+    }
+}
+
+void Gyro::sample()
+/* Reads the samples taken since the last call into the filter.
+   Without the FIFO that is a single 8 byte burst of the current register values. With the FIFO, the device
+   samples every GYRO_SAMPLE_MS on its own and up to FIFO_BURST_SAMPLES are read in one burst.
+*/
+{
+    if (!isSampling)
+        return;
+
+    #if GYRO_USE_FIFO == 1
+    uint8_t countBytes[2];
+    readRegisters(MPU6050_REG_FIFO_COUNT_H, countBytes, 2);
+    const uint16_t available = countBytes[0] << 8 | countBytes[1];
+    if (available > FIFO_STALE_BYTES)
+    {
+        // Not read for a long time (or full, which loses the sample alignment), start over with fresh samples
+        LOG(DEBUG_GYRO, "[GYRO]: FIFO holds %d bytes, resetting", available);
+        writeRegister(MPU6050_REG_USER_CTRL, 0x44);
+        return;
+    }
+
+    uint8_t samples = available / SAMPLE_BYTES;
+    if (samples > FIFO_BURST_SAMPLES)
+        samples = FIFO_BURST_SAMPLES;  // The rest is read on the next run
+    if (samples == 0)
+        return;
+
+    uint8_t buffer[FIFO_BURST_SAMPLES * SAMPLE_BYTES];
+    readRegisters(MPU6050_REG_FIFO_R_W, buffer, samples * SAMPLE_BYTES);
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        addSample(buffer + i * SAMPLE_BYTES);
+    }
+    #else
+    sampleRegisters();
+    #endif
+}
+
+void Gyro::sampleRegisters()
+/* Adds the current register values to the filter, in a single 8 byte burst.
+*/
+{
+    uint8_t buffer[SAMPLE_BYTES];
+    readRegisters(MPU6050_REG_ACCEL_XOUT_H, buffer, SAMPLE_BYTES);
+    addSample(buffer);
+}
+
+void Gyro::primeFilter()
+/* Makes sure the filter holds a value. When not sampling in the background, every call takes a fresh
+   (unfiltered) sample, so the value is never stale.
+*/
+{
+    if (!isSampling)
+    {
+        sampleCount = 0;
+    }
+    if (sampleCount == 0)
+    {
+        sampleRegisters();
+    }
 }
 
 angle_t Gyro::getCurrentAngles()
 /* Returns roll & tilt angles from MPU-6050 device in angle_t object in degrees.
    If MPU-6050 is not found then returns {0,0}.
+   Returns the filtered value right away, sample() keeps it up to date.
 */
 {
-    const int windowSize = 16;
-    // Read the accelerometer data
     struct angle_t result;
     result.pitchAngle = 0;
     result.rollAngle  = 0;
     if (!isPresent)
         return result;  // Gyro is not available
 
-    for (int i = 0; i < windowSize; i++)
-    {
-        // Execute 6 byte read from MPU6050_REG_WHO_AM_I
-        Wire.beginTransmission(MPU6050_I2C_ADDR);
-        Wire.write(MPU6050_REG_ACCEL_XOUT_H);
-        Wire.endTransmission(false);
-        Wire.requestFrom(MPU6050_I2C_ADDR, 6, 1);      // Read 6 registers total, each axis value is stored in 2 registers
-        int16_t AcX = Wire.read() << 8 | Wire.read();  // X-axis value
-        int16_t AcY = Wire.read() << 8 | Wire.read();  // Y-axis value
-        int16_t AcZ = Wire.read() << 8 | Wire.read();  // Z-axis value
-
-        // Calculating the Pitch angle (rotation around Y-axis)
-        result.pitchAngle += ((atanf(-1 * AcX / sqrtf(powf(AcY, 2) + powf(AcZ, 2))) * 180.0f / static_cast<float>(PI)) * 2.0f) / 2.0f;
-        // Calculating the Roll angle (rotation around X-axis)
-        result.rollAngle += ((atanf(-1 * AcY / sqrtf(powf(AcX, 2) + powf(AcZ, 2))) * 180.0f / static_cast<float>(PI)) * 2.0f) / 2.0f;
-
-        delay(10);  // Decorrelate measurements
-    }
+    primeFilter();
+
+    // Back to raw units, so the squares fit in 32 bits
+    const int32_t accX = (filtered[0] + 128) >> 8;
+    const int32_t accY = (filtered[1] + 128) >> 8;
+    const int32_t accZ = (filtered[2] + 128) >> 8;
+
+    // Fixed point math, soft-float atan/sqrt take thousands of cycles on the ATmega
+    // Calculating the Pitch angle (rotation around Y-axis)
+    const uint16_t lengthYZ = FixedTrig::squareRoot(static_cast<uint32_t>(accY * accY) + static_cast<uint32_t>(accZ * accZ));
+    result.pitchAngle       = FixedTrig::toDegrees(FixedTrig::arctan2(-accX, lengthYZ));
+    // Calculating the Roll angle (rotation around X-axis)
+    const uint16_t lengthXZ = FixedTrig::squareRoot(static_cast<uint32_t>(accX * accX) + static_cast<uint32_t>(accZ * accZ));
+    result.rollAngle        = FixedTrig::toDegrees(FixedTrig::arctan2(-accY, lengthXZ));
 
-    result.pitchAngle /= windowSize;
-    result.rollAngle /= windowSize;
     #if GYRO_AXIS_SWAP == 1
     float temp        = result.pitchAngle;
     result.pitchAngle = result.rollAngle;
@@ -116,15 +234,9 @@ float Gyro::getCurrentTemperature()
     if (!isPresent)
         return 99.0f;  // Gyro is not available
 
-    // Execute 2 byte read from MPU6050_REG_TEMP_OUT_H
-    Wire.beginTransmission(MPU6050_I2C_ADDR);
-    Wire.write(MPU6050_REG_TEMP_OUT_H);
-    Wire.endTransmission(false);
-    Wire.requestFrom(MPU6050_I2C_ADDR, 2, 1);            // Read 2 registers total, the temperature value is stored in 2 registers
-    int16_t tempValue = Wire.read() << 8 | Wire.read();  // Raw Temperature value
+    primeFilter();
 
     // Calculating the actual temperature value
-    float result = static_cast<float>(tempValue) / 340.0f + 36.53f;
-    return result;
+    return filtered[3] / (256.0f * 340.0f) + 36.53f;
 }
 #endif
@@ -6,6 +6,13 @@ struct angle_t {
     float rollAngle  = 0;
 };
 
+    // Period of the sampling task. A FIFO burst takes up to three samples, so it can run less often.
+    #if GYRO_USE_FIFO == 1
+        #define GYRO_TASK_MS (2 * GYRO_SAMPLE_MS)
+    #else
+        #define GYRO_TASK_MS GYRO_SAMPLE_MS
+    #endif
+
 class Gyro
 {
   public:
@@ -14,6 +21,9 @@ class Gyro
     static angle_t getCurrentAngles();
     static float getCurrentTemperature();
 
+    // Scheduler task that reads the new accelerometer samples into the filter
+    static void sample();
+
   private:
     // MPU6050 constants
     enum
@@ -21,13 +31,38 @@ class Gyro
         MPU6050_I2C_ADDR = 0x68,  // I2C address of the MPU6050 accelerometer
 
         // Register addresses
+        MPU6050_REG_SMPLRT_DIV   = 0x19,
         MPU6050_REG_CONFIG       = 0x1A,
+        MPU6050_REG_FIFO_EN      = 0x23,
         MPU6050_REG_ACCEL_XOUT_H = 0x3B,
         MPU6050_REG_TEMP_OUT_H   = 0x41,
+        MPU6050_REG_USER_CTRL    = 0x6A,
         MPU6050_REG_PWR_MGMT_1   = 0x6B,
+        MPU6050_REG_FIFO_COUNT_H = 0x72,
+        MPU6050_REG_FIFO_R_W     = 0x74,
         MPU6050_REG_WHO_AM_I     = 0x75
     };
 
-    static bool isPresent;  // True if gyro correctly detected on startup
+    // A sample is the accelerometer X, Y, Z and the temperature, 2 bytes each. The registers are in this order and
+    // so are the FIFO frames.
+    enum
+    {
+        SAMPLE_CHANNELS    = 4,
+        SAMPLE_BYTES       = 2 * SAMPLE_CHANNELS,
+        FIFO_BURST_SAMPLES = 3,    // 24 bytes, the AVR Wire buffer holds 32
+        FIFO_STALE_BYTES   = 512,  // More than this and the FIFO is reset, it is too far behind (or overflowed)
+    };
+
+    static void writeRegister(uint8_t reg, uint8_t value);
+    static void readRegisters(uint8_t reg, uint8_t *buffer, uint8_t count);
+    static void addSample(const uint8_t *data);
+    static void sampleRegisters();
+    static void primeFilter();
+
+    static bool isPresent;                       // True if gyro correctly detected on startup
+    static bool isSampling;                      // Between startup() and shutdown()
+    static uint8_t sampleCount;                  // Samples in the filter, stops counting at 2
+    static int16_t history[SAMPLE_CHANNELS][2];  // Previous two raw values, for the median of three
+    static int32_t filtered[SAMPLE_CHANNELS];    // Median then IIR filtered raw values, 8 fractional bits
 };
 #endif
@@ -2,11 +2,131 @@
 #include "Utility.hpp"
 #include "EPROMStore.hpp"
 #include "HallSensorHoming.hpp"
+#include "CriticalSection.hpp"
 #include "libs/MappedDict/MappedDict.hpp"
 
 #define HOMING_START_PIN_POSITION 0
 #define HOMING_END_PIN_POSITION   1
 
+HomingStats HallSensorHoming::_stats[2] = {};
+
+#if HALL_SENSOR_LATCH_EDGES == 1
+    #if defined(ESP32)
+        #define HOMING_ISR_ATTR IRAM_ATTR
+    #else
+        #define HOMING_ISR_ATTR
+    #endif
+
+HallSensorHoming *HallSensorHoming::_latchInstance[2] = {nullptr, nullptr};
+
+/////////////////////////////////
+//
+// latchRaEdge
+//
+/////////////////////////////////
+// attachInterrupt() handlers get no context, so each axis has its own
+void HOMING_ISR_ATTR HallSensorHoming::latchRaEdge()
+{
+    if (_latchInstance[StepperAxis::RA_STEPS] != nullptr)
+    {
+        _latchInstance[StepperAxis::RA_STEPS]->latchEdge();
+    }
+}
+
+/////////////////////////////////
+//
+// latchDecEdge
+//
+/////////////////////////////////
+void HOMING_ISR_ATTR HallSensorHoming::latchDecEdge()
+{
+    if (_latchInstance[StepperAxis::DEC_STEPS] != nullptr)
+    {
+        _latchInstance[StepperAxis::DEC_STEPS]->latchEdge();
+    }
+}
+
+/////////////////////////////////
+//
+// latchEdge
+//
+/////////////////////////////////
+// Runs in the sensor pin interrupt. On ATmega the stepper interrupt cannot run while this does, and on ESP32 the
+// position is read in a single access, so the latched position is the step the sensor switched at.
+void HOMING_ISR_ATTR HallSensorHoming::latchEdge()
+{
+    const int index      = (_sensorInput.read() == HIGH) ? 1 : 0;
+    _edgePosition[index] = _pMount->getCurrentStepperPosition(_axis);
+    _edgeSeen[index]     = true;
+}
+
+/////////////////////////////////
+//
+// attachLatch
+//
+/////////////////////////////////
+void HallSensorHoming::attachLatch()
+{
+    const int interrupt = digitalPinToInterrupt(_sensorPin);
+    if (interrupt == NOT_AN_INTERRUPT)
+    {
+        LOG(DEBUG_STEPPERS, "[HOMING]: Pin %d has no interrupt, sensor will be polled", _sensorPin);
+        return;
+    }
+
+    clearLatchedEdges();
+    _latchInstance[_axis] = this;
+    attachInterrupt(interrupt, (_axis == StepperAxis::RA_STEPS) ? latchRaEdge : latchDecEdge, CHANGE);
+    _latching = true;
+    LOG(DEBUG_STEPPERS, "[HOMING]: Latching sensor edges on interrupt %d", interrupt);
+}
+
+/////////////////////////////////
+//
+// detachLatch
+//
+/////////////////////////////////
+void HallSensorHoming::detachLatch()
+{
+    if (_latching)
+    {
+        detachInterrupt(digitalPinToInterrupt(_sensorPin));
+        _latchInstance[_axis] = nullptr;
+        _latching             = false;
+    }
+}
+
+/////////////////////////////////
+//
+// clearLatchedEdges
+//
+/////////////////////////////////
+void HallSensorHoming::clearLatchedEdges()
+{
+    CriticalSection lock;
+    _edgeSeen[0] = false;
+    _edgeSeen[1] = false;
+}
+
+/////////////////////////////////
+//
+// sensorEdgePosition
+//
+/////////////////////////////////
+// Returns where the sensor last switched to the given state, as latched by the interrupt. If no such edge was
+// latched (no interrupt on the pin, or the edge was missed) the polled position is returned.
+long HallSensorHoming::sensorEdgePosition(int pinState, long polledPosition)
+{
+    const int index = (pinState == HIGH) ? 1 : 0;
+    CriticalSection lock;
+    if (_latching && _edgeSeen[index])
+    {
+        return _edgePosition[index];
+    }
+    return polledPosition;
+}
+#endif
+
 /////////////////////////////////
 //
 // getHomingState
@@ -24,6 +144,7 @@ String HallSensorHoming::getHomingState(HomingState state) const
         {HOMING_FINDING_START_REVERSE, F("FINDING_START_REVERSE")},
         {HOMING_FINDING_END, F("FINDING_END")},
         {HOMING_RANGE_FOUND, F("RANGE_FOUND")},
+        {HOMING_START_APPROACH, F("START_APPROACH")},
         {HOMING_FAILED, F("FAILED")},
         {HOMING_SUCCESSFUL, F("SUCCESSFUL")},
         {HOMING_NOT_ACTIVE, F("NOT_ACTIVE")},
@@ -57,6 +178,7 @@ String HallSensorHoming::getLastResult() const
         {HOMING_RESULT_CANT_MOVE_OFF_SENSOR, F("CANT MOVE OFF SENSOR")},
         {HOMING_RESULT_CANT_FIND_SENSOR_ON_REVERSE, F("CANT FIND SENSOR BEGIN")},
         {HOMING_RESULT_CANT_FIND_SENSOR_END, F("CANT FIND SENSOR END")},
+        {HOMING_RESULT_CANT_FIND_SENSOR_ON_APPROACH, F("CANT FIND SENSOR ON APPROACH")},
     };
 
     auto strLookup = MappedDict<int, String>(lookupTable, ARRAY_SIZE(lookupTable));
@@ -68,6 +190,46 @@ String HallSensorHoming::getLastResult() const
     return F("WTF_RESULT");
 }
 
+/////////////////////////////////
+//
+// getStatistics
+//
+/////////////////////////////////
+// Returns ",seconds,runs,stddev" for the last successful run on the axis, or an empty string if there was none.
+// The standard deviation of the measured sensor range width (in steps) shows how repeatably the edges are found.
+String HallSensorHoming::getStatistics(StepperAxis axis)
+{
+    const HomingStats &stats = _stats[axis];
+    if (stats.runs == 0)
+    {
+        return "";
+    }
+    const float stdDev = (stats.runs > 1) ? sqrtf(stats.widthM2 / (stats.runs - 1)) : 0.0f;
+    return String(",") + String(stats.lastMs / 1000.0f, 1) + "," + String(stats.runs) + "," + String(stdDev, 2);
+}
+
+/////////////////////////////////
+//
+// addStatistics
+//
+/////////////////////////////////
+void HallSensorHoming::addStatistics()
+{
+    HomingStats &stats = _stats[_axis];
+    const float width  = labs(_homingData.position[HOMING_END_PIN_POSITION] - _homingData.position[HOMING_START_PIN_POSITION]);
+    const float delta  = width - stats.meanWidth;
+    stats.runs++;
+    stats.lastMs    = millis() - _homingData.startedAt;
+    stats.meanWidth = stats.meanWidth + delta / stats.runs;
+    stats.widthM2   = stats.widthM2 + delta * (width - stats.meanWidth);
+    LOG(DEBUG_STEPPERS,
+        "[HOMING]: Run %d took %lms, sensor range %f steps wide (mean %f)",
+        stats.runs,
+        stats.lastMs,
+        width,
+        stats.meanWidth);
+}
+
 /////////////////////////////////
 //
 // findHomeByHallSensor
@@ -80,9 +242,15 @@ bool HallSensorHoming::findHomeByHallSensor(int initialDirection, int searchDist
     _homingData.savedRate      = _pMount->getSlewRate();
     _homingData.initialDir     = initialDirection;
     _homingData.searchDistance = searchDistance;
+    _homingData.startedAt      = millis();
+    _homingData.approaching    = false;
+    _homingData.approachDir    = initialDirection;
 
     _pMount->setSlewRate(4);
     _pMount->setStatusFlag(STATUS_FINDING_HOME);
+#if HALL_SENSOR_LATCH_EDGES == 1
+    attachLatch();
+#endif
 
     LOG(DEBUG_STEPPERS,
         "[HOMING]: Start homing procedure. Axis %d, StepsPerDegree: %l, SearchDist: %d",
@@ -91,7 +259,7 @@ bool HallSensorHoming::findHomeByHallSensor(int initialDirection, int searchDist
         searchDistance);
 
     // Check where we are over the sensor already
-    if (digitalRead(_sensorPin) == _activeState)
+    if (_sensorInput.read() == _activeState)
     {
         _homingData.state = HomingState::HOMING_MOVE_OFF;
         LOG(DEBUG_STEPPERS, "[HOMING]: Sensor is signalled, move off sensor started");
@@ -158,7 +326,7 @@ void HallSensorHoming::processHomingProgress()
             {
                 if (_pMount->isAxisRunning(_axis))
                 {
-                    int homingPinState = digitalRead(_sensorPin);
+                    int homingPinState = _sensorInput.read();
                     if (homingPinState != _activeState)
                     {
                         LOG(DEBUG_STEPPERS,
@@ -188,9 +356,12 @@ void HallSensorHoming::processHomingProgress()
                     _homingData.searchDistance,
                     distance,
                     getHomingState(HomingState::HOMING_FINDING_START).c_str());
-                _homingData.pinState = _homingData.lastPinState = digitalRead(_sensorPin);
+                _homingData.pinState = _homingData.lastPinState = _sensorInput.read();
                 _homingData.position[HOMING_START_PIN_POSITION] = 0;
                 _homingData.position[HOMING_END_PIN_POSITION]   = 0;
+#if HALL_SENSOR_LATCH_EDGES == 1
+                clearLatchedEdges();
+#endif
 
                 // Move in initial direction
                 _pMount->moveStepperBy(_axis, distance);
@@ -203,7 +374,7 @@ void HallSensorHoming::processHomingProgress()
             {
                 if (_pMount->isAxisRunning(_axis))
                 {
-                    int homingPinState = digitalRead(_sensorPin);
+                    int homingPinState = _sensorInput.read();
                     if (_homingData.lastPinState != homingPinState)
                     {
                         if (_homingData.pinChangeCount == 0)
@@ -222,6 +393,11 @@ void HallSensorHoming::processHomingProgress()
                         {
                             // If we have seen this pin stay triggered for 5 cycles, assume we've found the start of the sensor, now
                             // change state to keep going until we find the end
+#if HALL_SENSOR_LATCH_EDGES == 1
+                            _homingData.position[HOMING_START_PIN_POSITION]
+                                = sensorEdgePosition(homingPinState, _homingData.position[HOMING_START_PIN_POSITION]);
+                            clearLatchedEdges();
+#endif
                             LOG(DEBUG_STEPPERS,
                                 "[HOMING]: Found start of sensor at %l, continuing until end is found. Advance to %s",
                                 _homingData.position[HOMING_START_PIN_POSITION],
@@ -243,6 +419,16 @@ void HallSensorHoming::processHomingProgress()
                         _homingData.pinChangeCount                      = 0;
                     }
                 }
+#if HALL_SENSOR_SLOW_APPROACH == 1
+                else if (_homingData.approaching)
+                {
+                    LOG(DEBUG_STEPPERS,
+                        "[HOMING]: Sensor not found on slow approach. Homing Failed. Advance to %s",
+                        getHomingState(HomingState::HOMING_FAILED).c_str());
+                    _homingData.state = HomingState::HOMING_FAILED;
+                    _lastResult       = HOMING_RESULT_CANT_FIND_SENSOR_ON_APPROACH;
+                }
+#endif
                 else
                 {
                     // Did not find start. Go reverse direction for twice the distance
@@ -253,6 +439,9 @@ void HallSensorHoming::processHomingProgress()
                         distance,
                         getHomingState(HomingState::HOMING_FINDING_START_REVERSE).c_str());
                     _pMount->moveStepperBy(_axis, distance);
+#if HALL_SENSOR_LATCH_EDGES == 1
+                    clearLatchedEdges();
+#endif
                     _homingData.state = HomingState::HOMING_FINDING_START_REVERSE;
                 }
             }
@@ -262,7 +451,7 @@ void HallSensorHoming::processHomingProgress()
             {
                 if (_pMount->isAxisRunning(_axis))
                 {
-                    int homingPinState = digitalRead(_sensorPin);
+                    int homingPinState = _sensorInput.read();
                     if (_homingData.lastPinState != homingPinState)
                     {
                         if (_homingData.pinChangeCount == 0)
@@ -281,6 +470,11 @@ void HallSensorHoming::processHomingProgress()
                         {
                             // If we have seen this pin stay triggered for 5 cycles, assume we've found the start of the sensor, now
                             // change state to keep going until we find the end
+#if HALL_SENSOR_LATCH_EDGES == 1
+                            _homingData.position[HOMING_START_PIN_POSITION]
+                                = sensorEdgePosition(homingPinState, _homingData.position[HOMING_START_PIN_POSITION]);
+                            clearLatchedEdges();
+#endif
                             LOG(DEBUG_STEPPERS,
                                 "[HOMING]: Found start of sensor in reverse at %l, continuing until end is found. Advance to %s",
                                 _homingData.position[HOMING_START_PIN_POSITION],
@@ -309,7 +503,8 @@ void HallSensorHoming::processHomingProgress()
                         "[HOMING]: Sensor not found on reverse pass either. Homing Failed. Advance to %s",
                         getHomingState(HomingState::HOMING_FAILED).c_str());
                     _homingData.state = HomingState::HOMING_FAILED;
-                    _lastResult       = HOMING_RESULT_CANT_FIND_SENSOR_ON_REVERSE;
+                    _lastResult       = _homingData.approaching ? HOMING_RESULT_CANT_FIND_SENSOR_ON_APPROACH
+                                                                : HOMING_RESULT_CANT_FIND_SENSOR_ON_REVERSE;
                 }
             }
             break;
@@ -318,7 +513,7 @@ void HallSensorHoming::processHomingProgress()
             {
                 if (_pMount->isAxisRunning(_axis))
                 {
-                    int homingPinState = digitalRead(_sensorPin);
+                    int homingPinState = _sensorInput.read();
                     if (_homingData.lastPinState != homingPinState)
                     {
                         if (_homingData.pinChangeCount == 0)
@@ -336,6 +531,10 @@ void HallSensorHoming::processHomingProgress()
                         {
                             // If we have seen this pin stay triggered for 5 cycles, assume we've found the start of the sensor, now
                             // change state to keep going until we find the end
+#if HALL_SENSOR_LATCH_EDGES == 1
+                            _homingData.position[HOMING_END_PIN_POSITION]
+                                = sensorEdgePosition(homingPinState, _homingData.position[HOMING_END_PIN_POSITION]);
+#endif
                             LOG(DEBUG_STEPPERS,
                                 "[HOMING]: Found end of sensor at %l, stopping... Advance to %s",
                                 _homingData.position[HOMING_END_PIN_POSITION],
@@ -366,6 +565,27 @@ void HallSensorHoming::processHomingProgress()
 
         case HomingState::HOMING_RANGE_FOUND:
             {
+#if HALL_SENSOR_SLOW_APPROACH == 1
+                if (!_homingData.approaching)
+                {
+                    // The fast search only located the range roughly. Back off to before its start so that the slow
+                    // approach crosses both edges in the same direction again.
+                    long start              = _homingData.position[HOMING_START_PIN_POSITION];
+                    long backOff            = static_cast<long>(_stepsPerDegree * HALL_SENSOR_APPROACH_BACKOFF_DEGREES);
+                    _homingData.approachDir = (_homingData.position[HOMING_END_PIN_POSITION] > start) ? 1 : -1;
+                    long approach           = start - _homingData.approachDir * backOff;
+                    LOG(DEBUG_STEPPERS,
+                        "[HOMING]: Rough range [%l to %l], backing off to %l for slow approach. Advance to %s",
+                        _homingData.position[HOMING_START_PIN_POSITION],
+                        _homingData.position[HOMING_END_PIN_POSITION],
+                        approach,
+                        getHomingState(HomingState::HOMING_WAIT_FOR_STOP).c_str());
+                    _pMount->moveStepperTo(_axis, approach);
+                    _homingData.state     = HomingState::HOMING_WAIT_FOR_STOP;
+                    _homingData.nextState = HomingState::HOMING_START_APPROACH;
+                    break;
+                }
+#endif
                 long midPos = (_homingData.position[HOMING_START_PIN_POSITION] + _homingData.position[HOMING_END_PIN_POSITION]) / 2;
 
                 LOG(DEBUG_STEPPERS,
@@ -390,6 +610,35 @@ void HallSensorHoming::processHomingProgress()
             }
             break;
 
+#if HALL_SENSOR_SLOW_APPROACH == 1
+        case HomingState::HOMING_START_APPROACH:
+            {
+                // Cross the whole range once more at the slow rate, the start and end states then take over as on the
+                // fast search, only in the direction the range was found in.
+                long width    = labs(_homingData.position[HOMING_END_PIN_POSITION] - _homingData.position[HOMING_START_PIN_POSITION]);
+                long backOff  = static_cast<long>(_stepsPerDegree * HALL_SENSOR_APPROACH_BACKOFF_DEGREES);
+                long distance = _homingData.approachDir * (width + 2 * backOff);
+                LOG(DEBUG_STEPPERS,
+                    "[HOMING]: Slow approach at rate %d by %l steps. Advance to %s",
+                    HALL_SENSOR_APPROACH_SLEW_RATE,
+                    distance,
+                    getHomingState(HomingState::HOMING_FINDING_START).c_str());
+                _pMount->setSlewRate(HALL_SENSOR_APPROACH_SLEW_RATE);
+                _homingData.approaching                         = true;
+                _homingData.pinState = _homingData.lastPinState = _sensorInput.read();
+                _homingData.pinChangeCount                      = 0;
+                _homingData.position[HOMING_START_PIN_POSITION] = 0;
+                _homingData.position[HOMING_END_PIN_POSITION]   = 0;
+    #if HALL_SENSOR_LATCH_EDGES == 1
+                clearLatchedEdges();
+    #endif
+                _pMount->moveStepperBy(_axis, distance);
+                _homingData.state = (_homingData.approachDir == _homingData.initialDir) ? HomingState::HOMING_FINDING_START
+                                                                                         : HomingState::HOMING_FINDING_START_REVERSE;
+            }
+            break;
+#endif
+
         case HomingState::HOMING_SUCCESSFUL:
             {
                 LOG(DEBUG_STEPPERS,
@@ -397,6 +646,10 @@ void HallSensorHoming::processHomingProgress()
                     getHomingState(HomingState::HOMING_NOT_ACTIVE).c_str());
                 _lastResult       = HOMING_RESULT_SUCCEEDED;
                 _homingData.state = HomingState::HOMING_NOT_ACTIVE;
+                addStatistics();
+#if HALL_SENSOR_LATCH_EDGES == 1
+                detachLatch();
+#endif
                 _pMount->setHome(false);
                 _pMount->setSlewRate(_homingData.savedRate);
                 _pMount->clearStatusFlag(STATUS_FINDING_HOME);
@@ -414,6 +667,9 @@ void HallSensorHoming::processHomingProgress()
                     getHomingState(HomingState::HOMING_NOT_ACTIVE).c_str());
                 _pMount->setSlewRate(_homingData.savedRate);
                 _homingData.state = HomingState::HOMING_NOT_ACTIVE;
+#if HALL_SENSOR_LATCH_EDGES == 1
+                detachLatch();
+#endif
                 _pMount->clearStatusFlag(STATUS_FINDING_HOME);
                 _pMount->setStatusFlag(STATUS_SLEWING | STATUS_SLEWING_TO_TARGET);
                 _pMount->moveStepperTo(_axis, _homingData.startPos);
@@ -3,13 +3,15 @@
 
 #include "Types.hpp"
 #include "Mount.hpp"
+#include "FastPin.hpp"
 
-#define HOMING_RESULT_SUCCEEDED                   1
-#define HOMING_RESULT_HOMING_NEVER_RUN            0
-#define HOMING_RESULT_HOMING_IN_PROGRESS          -1
-#define HOMING_RESULT_CANT_MOVE_OFF_SENSOR        -2
-#define HOMING_RESULT_CANT_FIND_SENSOR_ON_REVERSE -3
-#define HOMING_RESULT_CANT_FIND_SENSOR_END        -4
+#define HOMING_RESULT_SUCCEEDED                    1
+#define HOMING_RESULT_HOMING_NEVER_RUN             0
+#define HOMING_RESULT_HOMING_IN_PROGRESS           -1
+#define HOMING_RESULT_CANT_MOVE_OFF_SENSOR         -2
+#define HOMING_RESULT_CANT_FIND_SENSOR_ON_REVERSE  -3
+#define HOMING_RESULT_CANT_FIND_SENSOR_END         -4
+#define HOMING_RESULT_CANT_FIND_SENSOR_ON_APPROACH -5
 
 class Mount;
 
@@ -24,6 +26,7 @@ enum HomingState
     HOMING_FINDING_START_REVERSE,
     HOMING_FINDING_END,
     HOMING_RANGE_FOUND,
+    HOMING_START_APPROACH,
     HOMING_FAILED,
     HOMING_SUCCESSFUL,
 
@@ -43,6 +46,16 @@ struct HomingData {
     long offset;
     long startPos;
     unsigned long stopAt;
+    unsigned long startedAt;
+    bool approaching;
+    int approachDir;
+};
+
+struct HomingStats {
+    unsigned int runs;     // Number of successful homing runs since boot
+    unsigned long lastMs;  // Duration of the last successful run
+    float meanWidth;       // Mean width of the sensor range in steps
+    float widthM2;         // Sum of squared deviations from the mean width (Welford)
 };
 
 /////////////////////////////////
@@ -58,10 +71,30 @@ class HallSensorHoming
     StepperAxis _axis;
     long _stepsPerDegree;
     int _sensorPin;
+    FastInputPin _sensorInput;  // processHomingProgress() also runs from the stepper interrupt
     int _activeState;
     int _lastResult;
     bool _wasTracking;
 
+#if HALL_SENSOR_LATCH_EDGES == 1
+    bool _latching;                              // True while the sensor pin interrupt is attached
+    volatile long _edgePosition[2];              // Stepper position at the last edge into LOW (0) and into HIGH (1)
+    volatile bool _edgeSeen[2];                  // Whether an edge into LOW (0) and into HIGH (1) was latched
+    static HallSensorHoming *_latchInstance[2];  // Instance latching the RA and DEC sensor, for the interrupt handlers
+
+    static void latchRaEdge();
+    static void latchDecEdge();
+    void latchEdge();
+    void attachLatch();
+    void detachLatch();
+    void clearLatchedEdges();
+    long sensorEdgePosition(int pinState, long polledPosition);
+#endif
+
+    static HomingStats _stats[2];  // Statistics of the RA and DEC axis, kept across homing runs
+
+    void addStatistics();
+
   public:
     HallSensorHoming(Mount *mount, StepperAxis axis, long stepsPerDegree, int sensorPin, int activeState, int32_t offset)
     {
@@ -75,6 +108,17 @@ class HallSensorHoming
         _activeState               = activeState;
         _lastResult                = HOMING_RESULT_HOMING_NEVER_RUN;
         _wasTracking               = mount->isSlewingTRK();
+        _sensorInput.attach(sensorPin);
+#if HALL_SENSOR_LATCH_EDGES == 1
+        _latching = false;
+#endif
+    }
+
+    ~HallSensorHoming()
+    {
+#if HALL_SENSOR_LATCH_EDGES == 1
+        detachLatch();
+#endif
     }
 
     bool findHomeByHallSensor(int initialDirection, int searchDistanceDegrees);
@@ -83,6 +127,7 @@ class HallSensorHoming
     HomingState getHomingState() const;
     bool isIdleOrComplete() const;
     String getLastResult() const;
+    static String getStatistics(StepperAxis axis);
 };
 
 #endif
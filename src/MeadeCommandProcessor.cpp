@@ -6,9 +6,13 @@
 #include "MeadeCommandProcessor.hpp"
 #include "WifiControl.hpp"
 #include "Gyro.hpp"
+#include "Profiler.hpp"
+#include "Scheduler.hpp"
+#include "StepTiming.hpp"
 
 #if USE_GPS == 1
 bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
+void gpsTask();                               // defined in c72_menuHA_GPS.hpp
 #endif
 /////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -282,6 +286,9 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //        [4] The Tracking stepper position
 //        [5] The current RA position
 //        [6] The current DEC position
+//        [7] The focuser position (empty if there is no focuser)
+//        [8] The dither state. One of 'Dithering', 'Settling', 'Settled' or empty if no dither was started (see :XMD#)
+//        [9] The meridian flip state. One of 'FlipPending' (pause guiding), 'Flipping', 'Flipped' or empty (see :XSF#)
 //      Remarks:
 //        The motion state
 //        First character is RA slewing state ('R' is East, 'r' is West, '-' is stopped).
@@ -447,6 +454,27 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //        nothing
 //
 //------------------------------------------------------------------
+// TRACKING RATE FAMILY
+//
+// :TQ#
+//      Description:
+//        Select sidereal tracking rate
+//      Returns:
+//        nothing
+//
+// :TL#
+//      Description:
+//        Select lunar tracking rate
+//      Returns:
+//        nothing
+//
+// :TS#
+//      Description:
+//        Select solar tracking rate
+//      Returns:
+//        nothing
+//
+//------------------------------------------------------------------
 // MOVEMENT FAMILY
 //
 // :MS#
@@ -544,6 +572,32 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //        "1" if search is started
 //        "0" if homing has not been enabled in the local config
 //
+// :MHRS#
+//      Description:
+//        Home RA stepper via StallGuard
+//      Information:
+//        This drives the RA ring against its hard stop until the TMC2209 driver detects a stall, then homes from there.
+//      Remarks:
+//        The ring moves in the configured direction (RA_STALL_HOMING_DIRECTION) at the configured slew rate for at most
+//        RA_STALL_HOMING_SEARCH_DEGREES. Once the stall is detected, it moves the StallGuard Home offset (set with the ":XSHRSnnnn#"
+//        command) away from the stop and sets that position as home. The progress is reported by ":XGAH#".
+//      Returns:
+//        "1" if homing is started
+//        "0" if StallGuard homing has not been enabled in the local config, or its Home offset was never set
+//
+// :MHDS#
+//      Description:
+//        Home DEC stepper via StallGuard
+//      Information:
+//        This drives the DEC axis against its hard stop until the TMC2209 driver detects a stall, then homes from there.
+//      Remarks:
+//        The axis moves in the configured direction (DEC_STALL_HOMING_DIRECTION) at the configured slew rate for at most
+//        DEC_STALL_HOMING_SEARCH_DEGREES. Once the stall is detected, it moves the StallGuard Home offset (set with the ":XSHDSnnnn#"
+//        command) away from the stop and sets that position as home. The progress is reported by ":XGAH#".
+//      Returns:
+//        "1" if homing is started
+//        "0" if StallGuard homing has not been enabled in the local config, or its Home offset was never set
+//
 // :MAAH#
 //      Description:
 //        Move Azimuth and Altitude to home
@@ -654,6 +708,141 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        "1#"
 //
+// :XEC#
+//      Description:
+//        Clear ephemeris track
+//      Information:
+//        Stops ephemeris tracking, discards all track points and restarts the track time at 0.
+//        Only available if EPHEMERIS_TRACKING is set.
+//      Returns:
+//        "1#" if successful
+//        "0#" if ephemeris tracking is not available
+//
+// :XEPt,r,d#
+//      Description:
+//        Add ephemeris track point
+//      Information:
+//        Adds a position of a moving object (comet, asteroid, satellite) to the track. Up to EPHEMERIS_POINTS points
+//        are buffered and the ones that have been passed are dropped while following, so a long pass can be sent in
+//        while there is space (see :XEG#). Between the points the track is a smooth curve.
+//      Parameters:
+//        "t" is the track time in milliseconds since :XEC#, and must be later than the previous point
+//        "r" is the RA in 1/100 arcseconds (15 arcseconds per second of time)
+//        "d" is the DEC in 1/100 arcseconds
+//      Returns:
+//        "1#" if the point was added
+//        "0#" if the buffer is full, the point is not later than the previous one or ephemeris tracking is not available
+//
+// :XEF#
+//      Description:
+//        Follow ephemeris track
+//      Information:
+//        Starts tracking if needed and sets the tracking rates every EPHEMERIS_UPDATE_MS so that the mount follows the
+//        track from the current track time on. The mount should already point at the track position, so slew there first.
+//        Any residual is corrected in the next update. Following stops with sidereal tracking at the end of the track, at a
+//        DEC limit, on a slew or when tracking is stopped.
+//      Returns:
+//        "1#" if following
+//        "0#" if the track does not cover the current track time or ephemeris tracking is not available
+//
+// :XEX#
+//      Description:
+//        Stop following ephemeris track
+//      Information:
+//        Goes back to sidereal tracking. The track points are kept.
+//      Returns:
+//        "1#" if successful
+//        "0#" if ephemeris tracking is not available
+//
+// :XEG#
+//      Description:
+//        Get ephemeris tracking state
+//      Returns:
+//        "f,t,n,s,e,r,d#" where:
+//          f is 1 if following the track, else 0
+//          t is the current track time in milliseconds
+//          n is the number of buffered points and s the number of points that can still be added
+//          e is the track time of the last point in milliseconds
+//          r and d are the RA and DEC residuals of the last update in 1/100 arcseconds
+//        "0#" if ephemeris tracking is not available
+//
+// :XMDr.r#
+//      Description:
+//        Dither
+//      Information:
+//        Moves the pointing by a random offset of up to r.r arcseconds with guide pulses on both axes. Afterwards
+//        the mount waits a settle time that depends on the axis acceleration and, if DEC had to reverse, the backlash
+//        (see DITHER_SETTLE_MS). The dither state is field [8] of :GX#, which becomes 'Settled' when imaging can continue.
+//      Returns:
+//        "1#" if the dither was started
+//        "0#" if the mount is not tracking, or is slewing or guiding
+//
+// :XQAr,d,w,x#
+//      Description:
+//        Add target to the queue
+//      Information:
+//        Appends a GoTo target to the on-mount target queue. Only available if TARGET_QUEUE is set.
+//        Targets can only be added while the queue is not running.
+//      Parameters:
+//        "r" is the RA in seconds of time (0 to 86399)
+//        "d" is the DEC in arcseconds (-324000 to 324000)
+//        "w" is the dwell time in seconds, the time the queue stays on the target after arriving
+//        "x" is the dither in arcseconds (0 to 255). The target is moved by a random amount of up to this on
+//        both axes. Use 0 for no dither.
+//      Returns:
+//        "1#" if the target was added
+//        "0#" if the queue is full, running or not available
+//
+// :XQRr,d,w,x#
+//      Description:
+//        Add relative target to the queue
+//      Information:
+//        Like :XQA#, but "r" and "d" are offsets from the previous target (without its dither), for example for
+//        mosaic panels. If the first target is relative, it is relative to the last GoTo target.
+//      Returns:
+//        "1#" if the target was added
+//        "0#" if the queue is full, running or not available
+//
+// :XQS#
+//      Description:
+//        Start the target queue
+//      Information:
+//        Slews to each queued target in turn and stays on it for its dwell time, while tracking. Stopping both axes
+//        (:Q#, parking, homing) aborts the queue. Use :XQG# to follow its progress.
+//      Returns:
+//        "1#" if the queue was started
+//        "0#" if the queue is empty or not available
+//
+// :XQX#
+//      Description:
+//        Abort the target queue
+//      Information:
+//        Stops moving on to further targets. A slew in progress is completed. The targets are kept.
+//      Returns:
+//        "1#" if successful
+//        "0#" if the target queue is not available
+//
+// :XQC#
+//      Description:
+//        Clear the target queue
+//      Information:
+//        Aborts the queue and removes all targets.
+//      Returns:
+//        "1#" if successful
+//        "0#" if the target queue is not available
+//
+// :XQG#
+//      Description:
+//        Get target queue state
+//      Returns:
+//        "state,index,count,completed,dwell#" where:
+//          state is IDLE, SLEWING or DWELLING
+//          index is the index of the current target (starting at 0) and count the number of queued targets
+//          completed is the number of targets whose dwell time is over. It goes up by one for every finished target,
+//          so the host can see each completion with a single poll.
+//          dwell is the number of seconds left on the current target
+//        "0#" if the target queue is not available
+//
 // :XDnnn#
 //      Description:
 //        Run drift alignment (only supported if SUPPORT_DRIFT_ALIGNMENT is enabled)
@@ -693,6 +882,8 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //        Digital Level - Get Values
 //      Information:
 //        Gets the current pitch and roll values of the mount (Digital Level addon).
+//      Remarks:
+//        Returns right away with the filtered value while the level is on (:XL1#), it is sampled in the background.
 //      Returns:
 //        "<pitch>,<roll>#"
 //        "0#" if there is no Digital Level
@@ -740,7 +931,7 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //        Get auto homing state
 //      Information:
 //        Get the current state of RA and DEC Autohoming status. Only valid when at least
-//        one Hall sensor based autohoming axis is enabled.
+//        one Hall sensor or StallGuard based autohoming axis is enabled.
 //      Returns:
 //        "rastate|decstate#" if either axis is enabled
 //        "|#" if no autohoming is enabled
@@ -755,6 +946,7 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //          FINDING_START_REVERSE
 //          FINDING_END
 //          RANGE_FOUND
+//          START_APPROACH
 //
 //        If the mount status (:GX#) is not 'Homing' the command returns one of these:
 //          SUCCEEDED
@@ -763,6 +955,15 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //          CANT MOVE OFF SENSOR
 //          CANT FIND SENSOR BEGIN
 //          CANT FIND SENSOR END
+//          CANT FIND SENSOR ON APPROACH
+//
+//        Once an axis has homed successfully since boot, its result is followed by ",secs,runs,stddev", where secs is
+//        the duration of the last successful run, runs the number of successful runs and stddev the standard
+//        deviation of the measured Hall sensor range width in steps, which shows how repeatably the edges are found.
+//        For example "SUCCEEDED,41.2,3,1.73|NEVER RUN#".
+//
+//        An axis homed by StallGuard returns SEEKING_STOP, WAIT_FOR_STOP or MOVING_HOME while homing, and
+//        SUCCEEDED, NEVER RUN, IN PROGRESS or NO STALL DETECTED otherwise.
 //
 // :XGB#
 //      Description:
@@ -844,6 +1045,30 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        "float#"
 //
+// :XGK#
+//      Description:
+//        Get clock drift
+//      Information:
+//        Get how fast the clock of the mount runs, as estimated from successive time syncs (:SL, GPS).
+//        The drift is taken out of the local time, UTC and LST.
+//      Returns:
+//        "drift,error#"
+//      Parameters:
+//        "drift" is in ppm, positive if the clock runs fast
+//        "error" is the error of the estimate in ppm
+//
+// :XGKT#
+//      Description:
+//        Get clock timestamp
+//      Information:
+//        First half of a sub-second time sync. Note the host time just before sending this and just after
+//        the reply came in. The host time at which the mount took its timestamp is the middle of that round trip.
+//        Send it with :XSK right away.
+//      Returns:
+//        "ms#"
+//      Parameters:
+//        "ms" is the mount's millisecond counter
+//
 // :XGH#
 //      Description:
 //        Get HA (Hour Angle of Polaris)
@@ -876,6 +1101,22 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        "n#" - the number of steps
 //
+// :XGHRS#
+//      Description:
+//        Get RA StallGuard Homing offset
+//      Information:
+//        The number of steps from the hard stop the RA ring is driven against by ":MHRS#" to the home position.
+//      Returns:
+//        "n#" - the number of steps
+//
+// :XGHDS#
+//      Description:
+//        Get DEC StallGuard Homing offset
+//      Information:
+//        The number of steps from the hard stop the DEC axis is driven against by ":MHDS#" to the home position.
+//      Returns:
+//        "n#" - the number of steps
+//
 // :XGHS#
 //      Description:
 //        Get Hemisphere
@@ -937,6 +1178,206 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        "HHMMSS#"
 //
+// :XGJ#
+//      Description:
+//        Get RA step timing samples
+//      Information:
+//        Gets the next (up to 16) timestamps of RA tracking steps captured since capturing was started with :XSJ1#.
+//        The returned samples are removed from the capture buffer, so call this repeatedly to download the whole capture.
+//        Only available if STEP_TIMING_CAPTURE is enabled. Builds with NEW_STEPPER_LIB cannot capture, since that library
+//        issues the steps itself, so they always return "0#" (and STEP_TIMING_CAPTURE is rejected at compile time).
+//      Returns:
+//        "ticks|overruns|t1,t2,...#"
+//        "0#" if step timing capture is not supported
+//      Parameters:
+//        "ticks" is the number of timestamp ticks per second (CPU clock on ESP32, 1000000 on ATmega)
+//        "overruns" is the number of steps that were not recorded since the last call because the buffer was full
+//        "t1,t2,..." are the timestamps of the steps in ticks. They wrap around at 2^32.
+//
+// :XGGP#
+//      Description:
+//        Get guide pulse steps
+//      Information:
+//        Gets the number of steps delivered by the last completed RA and DEC guide pulses and their step budgets
+//        (pulse duration times guide speed). A pulse normally ends exactly when its budget is used up, so the
+//        delivered steps only differ from the budget if the pulse was interrupted.
+//      Returns:
+//        "raSteps,raBudget,decSteps,decBudget#"
+//      Parameters:
+//        A budget of 0 means that the pulse was ended by time instead (e.g. zero RA guide speed).
+//
+// :XGGS#
+//      Description:
+//        Get guide statistics
+//      Information:
+//        Gets the statistics of all guide pulses per axis since boot or the last reset. The net displacement of
+//        every pulse (steps taken minus what tracking would have done in the same time) is also folded into the
+//        current RA and DEC position, so slews and syncs after a long guiding session stay accurate.
+//      Returns:
+//        "RA,pulses,steps,westMs,eastMs,netArcsec,rmsArcsec|DEC,pulses,steps,northMs,southMs,netArcsec,rmsArcsec#"
+//      Parameters:
+//        "steps" is the total number of steps delivered at guide speed
+//        "westMs", "eastMs", "northMs" and "southMs" are the total pulse durations in each direction
+//        "netArcsec" is the net displacement of the axis, positive is west or north
+//        "rmsArcsec" is the RMS of the displacement of the individual pulses
+//
+// :XGGSR#
+//      Description:
+//        Get and reset guide statistics
+//      Information:
+//        Same as :XGGS#, but clears all the statistics after reading them.
+//      Returns:
+//        "RA,pulses,steps,westMs,eastMs,netArcsec,rmsArcsec|DEC,pulses,steps,northMs,southMs,netArcsec,rmsArcsec#"
+//
+// :XGGL#
+//      Description:
+//        Get guide rate learning
+//      Information:
+//        Gets the RA tracking rate error learned from the guide pulses since tracking was started or the mount last
+//        slewed, and the speed factor that would correct it. Only available if GUIDE_RATE_LEARNING is enabled.
+//      Returns:
+//        "valid,bins,spanMinutes,arcsecPerHour,stdErrArcsecPerHour,proposedFactor,rejectedPulses#"
+//      Parameters:
+//        "valid" is 1 if the proposed factor can be applied with :XSGL#, otherwise 0
+//        "bins" is the number of bins of guide pulses that fit the rate, "spanMinutes" the time they cover
+//        "arcsecPerHour" is the net RA guide correction per hour, positive means the mount tracks too slow
+//        "rejectedPulses" is the number of pulses that were ignored because they were much larger than usual
+//
+// :XGPF#
+//      Description:
+//        Get loop profile
+//      Information:
+//        Gets the run time statistics of the main loop sections, measured in microseconds since boot or the last reset.
+//        The sections are CMD (Meade command handling), LOOP (mount motion task), DISP (LCD and info display rendering),
+//        EEPROM (EEPROM/flash writes), WIFI (Wifi handling) and GPS (GPS sentence decoding). Sections can be nested,
+//        for example WIFI includes the CMD time of commands received over Wifi.
+//      Returns:
+//        "name,count,min,max,mean,histogram|name,...#"
+//        "#" if the profiler is disabled (LOOP_PROFILER is 0)
+//      Parameters:
+//        "histogram" is a semicolon separated list of counts. The first count is for durations of 0us, count n is
+//            for durations from 2^(n-1) to 2^n - 1 us. The last of the 18 buckets includes all longer durations.
+//            Trailing empty buckets are not sent.
+//
+// :XGPFR#
+//      Description:
+//        Get and reset loop profile
+//      Information:
+//        Same as :XGPF#, but clears all the statistics after reading them.
+//      Returns:
+//        "name,count,min,max,mean,histogram|name,...#"
+//
+// :XGPT#
+//      Description:
+//        Get scheduler task statistics
+//      Information:
+//        Gets the statistics of the main loop scheduler tasks since boot or the last reset. The tasks are
+//        GUIDE (guide pulse expiry), MOUNT (stepper state), SERIAL (ESP32 only), WIFI, GPS, OLED (info display)
+//        and LCD. Tasks that are not built into the firmware are not listed.
+//      Returns:
+//        "name,runs,maxUs,meanUs,maxLateMs,misses|name,...#"
+//      Parameters:
+//        "maxUs" and "meanUs" are the longest and average run times in microseconds
+//        "maxLateMs" is the longest time in milliseconds the task was due before it could start
+//        "misses" is the number of times the task started later than its deadline
+//
+// :XGPTR#
+//      Description:
+//        Get and reset scheduler task statistics
+//      Information:
+//        Same as :XGPT#, but clears all the statistics after reading them.
+//      Returns:
+//        "name,runs,maxUs,meanUs,maxLateMs,misses|name,...#"
+//
+// :XGW#
+//      Description:
+//        Get tracking time forecast
+//      Information:
+//        Gets how long tracking can go on at the current position before it reaches each limit. The DEC limits
+//        can only be reached with a tracking rate that moves DEC.
+//      Returns:
+//        "t,p,d#"
+//      Parameters:
+//        "t" is the number of minutes until RA_TRACKING_LIMIT (where tracking stops or the meridian flip happens)
+//        "p" is the number of minutes until RA_PHYSICAL_LIMIT
+//        "d" is the number of minutes until the DEC limit, -1 if it is never reached
+//
+// :XGWsDD*MM:SS.HH:MM:SS#
+//      Description:
+//        Get tracking time forecast for a position
+//      Information:
+//        Gets the same forecast as :XGW# for a GoTo to the given DEC and RA (same format as :SY#), on both sides
+//        of the pier. Can be used to order targets and to avoid GoTos that would need a flip soon.
+//      Returns:
+//        "s|t,p,d|t,p,d#"
+//        "0#" if the coordinates could not be parsed
+//      Parameters:
+//        "s" is 'N' if a GoTo would end up on the normal side of the pier and 'F' if it would flip both axes
+//        The first "t,p,d" is the forecast on the normal side, the second the forecast on the flipped side (see :XGW#)
+//        Either one is "X" instead if a GoTo can't end up on that side of the pier (it would be out of the RA limits)
+//
+// :XGF#
+//      Description:
+//        Get automatic meridian flip state
+//      Returns:
+//        "e,m,state#"
+//      Parameters:
+//        "e" is 1 if the automatic meridian flip is enabled, else 0
+//        "m" is the lead time in minutes before RA_TRACKING_LIMIT at which the flip is started
+//        "state" is empty, 'FlipPending', 'Flipping' or 'Flipped' (same as field [9] of :GX#)
+//
+// :XGV#
+//      Description:
+//        Get tracking rate
+//      Returns:
+//        "m,r.rrrr,d.dddd#"
+//      Parameters:
+//        "m" is 'Q' for sidereal, 'L' for lunar, 'S' for solar, 'K' for King or 'C' for a custom rate
+//        "r.rrrr" is the RA rate in arcsec/sec, "d.dddd" the DEC rate in arcsec/sec (positive is north)
+//
+// :XGPE#
+//      Description:
+//        Get periodic error correction status
+//      Information:
+//        Gets the state of the periodic error correction (PEC). Only available if PEC_ENABLED is set.
+//      Returns:
+//        "playback,recording,segment,recordedPercent,peakToPeakArcsec#"
+//      Parameters:
+//        "playback" and "recording" are 1 if active, otherwise 0
+//        "segment" is the current segment (0 to 63) of the period of the RA drive
+//        "recordedPercent" is the progress of a recording
+//        "peakToPeakArcsec" is the peak to peak periodic error corrected by the current table
+//
+// :XGPET#
+//      Description:
+//        Get periodic error correction table
+//      Information:
+//        Gets the RA correction added in each of the 64 segments of the RA drive period, in 1/16 arcsec.
+//        Only available if PEC_ENABLED is set.
+//      Returns:
+//        "n0,n1,...,n63#"
+//
+// :XGO#
+//      Description:
+//        Get log buffer
+//      Information:
+//        Get all log lines currently held in the log buffer (only if BUFFER_LOGS is enabled). Lines are
+//        separated by a newline. Any '#' in the log text is replaced by '%'.
+//      Returns:
+//        "lines#"
+//        "Debugging disabled.#" if log buffering is not enabled
+//
+// :XGON#
+//      Description:
+//        Get next log record
+//      Information:
+//        Streams the log buffer one record at a time (only if BUFFER_LOGS is enabled). Each call returns
+//        the oldest record that was not returned yet. Call repeatedly until an empty reply is received.
+//        Records are overwritten when the buffer is full, so a gap in the sequence numbers means records were lost.
+//      Returns:
+//        "sequence|millis|text#" for the next record
+//        "#" if there are no more records
+//
 // :XSBn#
 //      Description:
 //        Set Backlash correction steps
@@ -945,6 +1386,88 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        nothing
 //
+// :XSKms,HH:MM:SS.sss,MM/DD/YY,rtt#
+//      Description:
+//        Set Site Local Time and Date to the millisecond
+//      Information:
+//        Second half of a sub-second time sync started with :XGKT. Sets the local time and date the host had
+//        when the mount took the timestamp, so the clock is off by no more than half the round trip instead of
+//        up to a second with :SL. Also recalculates the HA like :SL.
+//      Returns:
+//        "1" if the clock was set
+//        "0" if the timestamp is older than 10 seconds or the command is malformed
+//      Parameters:
+//        "ms" is the timestamp returned by :XGKT
+//        "HH:MM:SS.sss" is the local time at that timestamp
+//        "MM/DD/YY" is the local date at that timestamp
+//        "rtt" is the round trip of the :XGKT exchange in milliseconds
+//
+// :XSPEn#
+//      Description:
+//        Set periodic error correction
+//      Information:
+//        Controls the periodic error correction (PEC). Only available if PEC_ENABLED is set.
+//        Recording needs the mount to be tracking and guiding. It averages the RA guide corrections over
+//        PEC_RECORD_CYCLES periods of the RA drive, adds them to the table (if played back) and stores it in EEPROM.
+//      Parameters:
+//        "n" is '1' to play back the table, '0' to stop playback, 'R' to start recording, 'X' to abort
+//        recording and 'C' to clear the table
+//      Returns:
+//        "1" if successful, "0" if recording could not be started because the mount is not tracking
+//
+// :XSFn#
+//      Description:
+//        Set automatic meridian flip
+//      Information:
+//        When enabled, tracking that gets within the lead time of RA_TRACKING_LIMIT does not stop. Instead the
+//        mount reports 'FlipPending' in :GX# for AUTO_MERIDIAN_FLIP_PAUSE_SECONDS, so the host can pause guiding,
+//        then slews to the same position on the other side of the pier and keeps tracking. At most one flip is
+//        done per GoTo. The default comes from AUTO_MERIDIAN_FLIP, the setting is not stored.
+//      Parameters:
+//        "n" is 1 to enable or 0 to disable
+//      Returns:
+//        "1"
+//
+// :XSFLnnn#
+//      Description:
+//        Set meridian flip lead time
+//      Parameters:
+//        "nnn" is the number of minutes (1 to 120) before the tracking limit at which the flip is started
+//      Returns:
+//        "1"
+//
+// :XSVm#
+//      Description:
+//        Set tracking rate
+//      Information:
+//        Selects the rate used while tracking, also after a slew. The rate is not stored and is sidereal after a reboot.
+//      Parameters:
+//        "m" is 'Q' for sidereal, 'L' for lunar, 'S' for solar or 'K' for King rate
+//      Returns:
+//        "1" if successful, "0" if the rate is unknown
+//
+// :XSVCr.rrrr,d.dddd#
+//      Description:
+//        Set custom tracking rate
+//      Information:
+//        Tracks at the given rates, e.g. for comets or asteroids. The DEC rate moves the DEC axis continuously
+//        while tracking.
+//      Parameters:
+//        "r.rrrr" is the RA rate in arcsec/sec (sidereal is 15.0411)
+//        "d.dddd" is the DEC rate in arcsec/sec, positive is north. Optional, 0 if not given.
+//      Returns:
+//        "1" if successful, "0" if no rate was given
+//
+// :XSJn#
+//      Description:
+//        Set RA step timing capture
+//      Information:
+//        Starts (n is '1') or stops (any other value) capturing the timestamps of RA tracking steps. Starting a capture
+//        discards any samples that were not downloaded yet. Only available if STEP_TIMING_CAPTURE is enabled, so not
+//        with NEW_STEPPER_LIB (see :XGJ#).
+//      Returns:
+//        nothing
+//
 // :XSHRnnn#
 //      Description:
 //        Set homing offset for RA ring from Hall sensor center
@@ -967,6 +1490,26 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        nothing
 //
+// :XSHRSnnn#
+//      Description:
+//        Set StallGuard homing offset for RA ring from the hard stop
+//      Information:
+//        After ":MHRS#" has driven the RA ring against its hard stop, it moves this offset away from the stop to home.
+//      Parameters:
+//        "n" is the number of steps from the hard stop to the actual home position.
+//      Returns:
+//        nothing
+//
+// :XSHDSnnn#
+//      Description:
+//        Set StallGuard homing offset for DEC ring from the hard stop
+//      Information:
+//        After ":MHDS#" has driven the DEC axis against its hard stop, it moves this offset away from the stop to home.
+//      Parameters:
+//        "n" is the number of steps from the hard stop to the actual home position.
+//      Returns:
+//        nothing
+//
 // :XSRn.n#
 //      Description:
 //        Set RA steps
@@ -1046,6 +1589,23 @@ bool gpsAqcuisitionComplete(int &indicator);  // defined in c72_menuHA_GPS.hpp
 //      Returns:
 //        nothing
 //
+// :XSGL#
+//      Description:
+//        Apply learned Tracking speed adjustment
+//      Information:
+//        Sets and stores the tracking speed adjustment factor proposed by :XGGL# and restarts the learning.
+//        Only available if GUIDE_RATE_LEARNING is enabled.
+//      Returns:
+//        "1" if the factor was applied, "0" if there is no valid proposal
+//
+// :XSGLR#
+//      Description:
+//        Reset guide rate learning
+//      Information:
+//        Discards the guide pulse history used to learn the tracking rate.
+//      Returns:
+//        nothing
+//
 // :XSTnnnn#
 //      Description:
 //        Set Tracking motor position (no movement)
@@ -1354,6 +1914,10 @@ String MeadeCommandProcessor::handleMeadeGPSCommands(String inCmd)
         int indicator             = 0;
         while (millis() < timeoutTime)
         {
+            // Keep the mount serviced and the GPS parser fed while waiting. Only these tasks are run, the
+            // serial and WiFi tasks would re-enter the command processor in the middle of this command.
+            _mount->loop();
+            gpsTask();
             if (gpsAqcuisitionComplete(indicator))
             {
                 LOG(DEBUG_MEADE, "[MEADE]: GPS startup, GPS acquired");
@@ -1636,6 +2200,12 @@ String MeadeCommandProcessor::handleMeadeMovement(String inCmd)
     }
     else if ((inCmd[0] == 'H') && (inCmd.length() > 2) && inCmd[1] == 'R')
     {
+#if USE_STALLGUARD_RA_AUTOHOME == 1
+        if (inCmd[2] == 'S')  // :MHRS
+        {
+            return _mount->findHomeByStallGuard(StepperAxis::RA_STEPS) ? "1" : "0";
+        }
+#endif
 #if USE_HALL_SENSOR_RA_AUTOHOME == 1
         int distance = RA_HOMING_SENSOR_SEARCH_DEGREES;
         if (inCmd.length() > 3)
@@ -1657,6 +2227,12 @@ String MeadeCommandProcessor::handleMeadeMovement(String inCmd)
     }
     else if ((inCmd[0] == 'H') && (inCmd.length() > 2) && inCmd[1] == 'D')
     {
+#if USE_STALLGUARD_DEC_AUTOHOME == 1
+        if (inCmd[2] == 'S')  // :MHDS
+        {
+            return _mount->findHomeByStallGuard(StepperAxis::DEC_STEPS) ? "1" : "0";
+        }
+#endif
 #if USE_HALL_SENSOR_DEC_AUTOHOME == 1
         int decDistance = DEC_HOMING_SENSOR_SEARCH_DEGREES;
         if (inCmd.length() > 3)
@@ -1715,6 +2291,17 @@ String MeadeCommandProcessor::handleMeadeDistance(String inCmd)
     return " #";
 }
 
+// Formats a forecast as "t,p,d" for :XGW#, or "X" if that side of the pier can't be reached
+static String limitForecastString(const LimitForecast &forecast)
+{
+    if (!forecast.reachable)
+    {
+        return "X";
+    }
+    return String(forecast.trackingLimitMinutes, 1) + "," + String(forecast.physicalLimitMinutes, 1) + ","
+           + String(forecast.decLimitMinutes, 1);
+}
+
 /////////////////////////////
 // EXTRA COMMANDS
 /////////////////////////////
@@ -1809,6 +2396,14 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
         {
             return String(_mount->getSpeed(TRACKING), 7) + "#";
         }
+        else if (inCmd[1] == 'K')  // :XGK#
+        {
+            if ((inCmd.length() > 2) && (inCmd[2] == 'T'))  // :XGKT#
+            {
+                return String(millis()) + "#";
+            }
+            return String(_mount->getClockDriftPpm(), 2) + "," + String(_mount->getClockDriftErrorPpm(), 2) + "#";
+        }
         else if (inCmd[1] == 'B')  // :XGB#
         {
             return String(_mount->getBacklashCorrection()) + "#";
@@ -1848,16 +2443,30 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
             }
             return _mount->getMountHardwareInfo() + "#";  // :XGM#
         }
-        else if (inCmd[1] == 'O')  // :XGO#
+        else if (inCmd[1] == 'O')
         {
-            return getLogBuffer();
+            if ((inCmd.length() > 2) && (inCmd[2] == 'N'))  // :XGON#
+            {
+                return getNextLogRecord();
+            }
+            return getLogBuffer();  // :XGO#
         }
         else if (inCmd[1] == 'H')  // :XGH#
         {
             if (inCmd.length() > 2)
             {
                 LOG(DEBUG_MEADE, "[MEADE]: XGH  -> %s", inCmd.c_str());
-                if (inCmd[2] == 'R')  // :XGHR#
+                if ((inCmd[2] == 'R') && (inCmd.length() > 3) && (inCmd[3] == 'S'))  // :XGHRS#
+                {
+                    LOG(DEBUG_MEADE, "[MEADE]: XGHRS  -> %s", inCmd.c_str());
+                    return String(_mount->getStallHomingOffset(StepperAxis::RA_STEPS)) + "#";
+                }
+                else if ((inCmd[2] == 'D') && (inCmd.length() > 3) && (inCmd[3] == 'S'))  // :XGHDS#
+                {
+                    LOG(DEBUG_MEADE, "[MEADE]: XGHDS  -> %s", inCmd.c_str());
+                    return String(_mount->getStallHomingOffset(StepperAxis::DEC_STEPS)) + "#";
+                }
+                else if (inCmd[2] == 'R')  // :XGHR#
                 {
                     LOG(DEBUG_MEADE, "[MEADE]: XGHR  -> %s", inCmd.c_str());
                     return String(_mount->getHomingOffset(StepperAxis::RA_STEPS)) + "#";
@@ -1884,6 +2493,93 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
                 return String(scratchBuffer);
             }
         }
+        else if (inCmd[1] == 'J')  // :XGJ#
+        {
+#if STEP_TIMING_CAPTURE == 1
+            return StepTiming::getNextSamples();
+#else
+            return "0#";
+#endif
+        }
+        else if ((inCmd[1] == 'G') && (inCmd.length() > 2) && (inCmd[2] == 'P'))  // :XGGP#
+        {
+            return _mount->getLastGuidePulseSteps() + "#";
+        }
+        else if ((inCmd[1] == 'G') && (inCmd.length() > 2) && (inCmd[2] == 'S'))  // :XGGS#
+        {
+            String statistics = _mount->getGuideStatistics();
+            if ((inCmd.length() > 3) && (inCmd[3] == 'R'))  // :XGGSR#
+            {
+                _mount->resetGuideStatistics();
+            }
+            return statistics + "#";
+        }
+        else if ((inCmd[1] == 'G') && (inCmd.length() > 2) && (inCmd[2] == 'L'))  // :XGGL#
+        {
+#if GUIDE_RATE_LEARNING != 0
+            return _mount->getGuideRateLearning() + "#";
+#else
+            return "0#";
+#endif
+        }
+        else if ((inCmd[1] == 'P') && (inCmd.length() > 2) && (inCmd[2] == 'F'))  // :XGPF#
+        {
+            String report = Profiler::getReport();
+            if ((inCmd.length() > 3) && (inCmd[3] == 'R'))  // :XGPFR#
+            {
+                Profiler::reset();
+            }
+            return report;
+        }
+        else if ((inCmd[1] == 'P') && (inCmd.length() > 2) && (inCmd[2] == 'E'))  // :XGPE#
+        {
+#if PEC_ENABLED == 1
+            if ((inCmd.length() > 3) && (inCmd[3] == 'T'))  // :XGPET#
+            {
+                return _mount->getPecTable() + "#";
+            }
+            return _mount->getPecStatus() + "#";
+#else
+            return "0#";
+#endif
+        }
+        else if (inCmd[1] == 'W')  // :XGW#
+        {
+            if (inCmd.length() == 2)
+            {
+                return limitForecastString(_mount->getLimitForecast()) + "#";
+            }
+            //   01234567890123456789
+            // :XGW+84*03:02.18:34:12
+            if ((inCmd.length() == 20) && (inCmd[11] == '.'))
+            {
+                Declination dec = Declination::ParseFromMeade(inCmd.substring(2, 11));
+                DayTime ra      = DayTime::ParseFromMeade(inCmd.substring(12));
+                String side     = (_mount->getGoToPierSide(ra, dec) == PIER_SIDE_FLIPPED) ? "F|" : "N|";
+                return side + limitForecastString(_mount->getLimitForecast(ra, dec, PIER_SIDE_NORMAL)) + "|"
+                       + limitForecastString(_mount->getLimitForecast(ra, dec, PIER_SIDE_FLIPPED)) + "#";
+            }
+            return "0#";
+        }
+        else if (inCmd[1] == 'F')  // :XGF#
+        {
+            return _mount->getMeridianFlipStatus() + "#";
+        }
+        else if (inCmd[1] == 'V')  // :XGV#
+        {
+            const char rateCodes[] = "QLSKC";  // Indexed by TrackingRate
+            return String(rateCodes[_mount->getTrackingRate()]) + "," + String(_mount->getRaTrackingRate(), 4) + ","
+                   + String(_mount->getDecTrackingRate(), 4) + "#";
+        }
+        else if ((inCmd[1] == 'P') && (inCmd.length() > 2) && (inCmd[2] == 'T'))  // :XGPT#
+        {
+            String report = Scheduler::getReport();
+            if ((inCmd.length() > 3) && (inCmd[3] == 'R'))  // :XGPTR#
+            {
+                Scheduler::resetStats();
+            }
+            return report;
+        }
         else if (inCmd[1] == 'L')  // :XGL#
         {
             char scratchBuffer[10];
@@ -1956,6 +2652,21 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
                 }
             }
         }
+        else if ((inCmd[1] == 'G') && (inCmd.length() > 2) && (inCmd[2] == 'L'))  // :XSGL
+        {
+#if GUIDE_RATE_LEARNING != 0
+            if ((inCmd.length() > 3) && (inCmd[3] == 'R'))  // :XSGLR
+            {
+                _mount->resetGuideRateLearning();
+            }
+            else
+            {
+                return _mount->applyLearnedSpeedCalibration() ? "1" : "0";
+            }
+#else
+            return "0";
+#endif
+        }
         else if (inCmd[1] == 'S')  // :XSS
         {
             _mount->setSpeedCalibration(inCmd.substring(2).toFloat(), true);
@@ -1964,6 +2675,33 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
         {
             _mount->setTrackingStepperPos(inCmd.substring(2).toInt());
         }
+        else if (inCmd[1] == 'K')  // :XSKms,HH:MM:SS.sss,MM/DD/YY,rtt
+        {
+            //   012345678901234567890123
+            //   ,19:33:03.250,04/30/20,5
+            // The round trip needs at least one digit, an empty one would claim a 1ms error
+            const int timeStart = inCmd.indexOf(',');
+            if ((timeStart < 0) || (inCmd.length() < static_cast<unsigned int>(timeStart) + 24) || (inCmd[timeStart + 9] != '.')
+                || (inCmd[timeStart + 13] != ',') || (inCmd[timeStart + 22] != ',') || !isDigit(inCmd[timeStart + 23]))
+            {
+                return "0";
+            }
+            const unsigned long timestamp = strtoul(inCmd.substring(2, timeStart).c_str(), nullptr, 10);
+            if (millis() - timestamp > 10000UL)
+            {
+                return "0";
+            }
+            const DayTime localTime = DayTime::ParseFromMeade(inCmd.substring(timeStart + 1, timeStart + 9));
+            const unsigned long ms  = inCmd.substring(timeStart + 10, timeStart + 13).toInt();
+            LocalDate localDate;
+            localDate.month        = inCmd.substring(timeStart + 14, timeStart + 16).toInt();
+            localDate.day          = inCmd.substring(timeStart + 17, timeStart + 19).toInt();
+            localDate.year         = 2000 + inCmd.substring(timeStart + 20, timeStart + 22).toInt();
+            const unsigned int rtt = inCmd.substring(timeStart + 23).toInt();
+            _mount->syncLocalClock(localTime, localDate, timestamp - ms, rtt / 2 + 1);
+            _mount->autoCalcHa();
+            return "1";
+        }
         else if (inCmd[1] == 'M')  // :XSM
         {
             _mount->setManualSlewMode(inCmd[2] == '1');
@@ -1976,6 +2714,84 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
         {
             _mount->setSpeed(DEC_STEPS, inCmd.substring(2).toFloat());
         }
+        else if (inCmd[1] == 'J')  // :XSJ
+        {
+#if STEP_TIMING_CAPTURE == 1
+            StepTiming::setEnabled(inCmd[2] == '1');
+#endif
+        }
+        else if ((inCmd[1] == 'P') && (inCmd.length() > 3) && (inCmd[2] == 'E'))  // :XSPE
+        {
+#if PEC_ENABLED == 1
+            switch (inCmd[3])
+            {
+                case '1':
+                    _mount->setPecPlayback(true);
+                    break;
+                case '0':
+                    _mount->setPecPlayback(false);
+                    break;
+                case 'R':
+                    return _mount->startPecRecording() ? "1" : "0";
+                case 'X':
+                    _mount->stopPecRecording();
+                    break;
+                case 'C':
+                    _mount->clearPecTable();
+                    break;
+                default:
+                    return "0";
+            }
+            return "1";
+#else
+            return "0";
+#endif
+        }
+        else if ((inCmd[1] == 'F') && (inCmd.length() > 2))  // :XSF
+        {
+            if (inCmd[2] == 'L')  // :XSFL
+            {
+                _mount->setMeridianFlipLeadMinutes(inCmd.substring(3).toInt());
+            }
+            else
+            {
+                _mount->setAutoMeridianFlip(inCmd[2] == '1');
+            }
+            return "1";
+        }
+        else if ((inCmd[1] == 'V') && (inCmd.length() > 2))  // :XSV
+        {
+            switch (inCmd[2])
+            {
+                case 'Q':
+                    _mount->setTrackingRate(TRACKING_SIDEREAL);
+                    break;
+                case 'L':
+                    _mount->setTrackingRate(TRACKING_LUNAR);
+                    break;
+                case 'S':
+                    _mount->setTrackingRate(TRACKING_SOLAR);
+                    break;
+                case 'K':
+                    _mount->setTrackingRate(TRACKING_KING);
+                    break;
+                case 'C':  // :XSVC
+                    {
+                        if (inCmd.length() < 4)
+                        {
+                            return "0";
+                        }
+                        const int comma     = inCmd.indexOf(',');
+                        const float raRate  = (comma < 0) ? inCmd.substring(3).toFloat() : inCmd.substring(3, comma).toFloat();
+                        const float decRate = (comma < 0) ? 0.0f : inCmd.substring(comma + 1).toFloat();
+                        _mount->setTrackingRate(TRACKING_CUSTOM, raRate, decRate);
+                        break;
+                    }
+                default:
+                    return "0";
+            }
+            return "1";
+        }
         else if (inCmd[1] == 'B')  // :XSB
         {
             _mount->setBacklashCorrection(inCmd.substring(2).toInt());
@@ -1984,7 +2800,15 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
         {
             if (inCmd.length() > 2)
             {
-                if (inCmd[2] == 'R')  // :XSHR
+                if ((inCmd[2] == 'R') && (inCmd.length() > 3) && (inCmd[3] == 'S'))  // :XSHRS
+                {
+                    _mount->setStallHomingOffset(StepperAxis::RA_STEPS, inCmd.substring(4).toInt());
+                }
+                else if ((inCmd[2] == 'D') && (inCmd.length() > 3) && (inCmd[3] == 'S'))  // :XSHDS
+                {
+                    _mount->setStallHomingOffset(StepperAxis::DEC_STEPS, inCmd.substring(4).toInt());
+                }
+                else if (inCmd[2] == 'R')  // :XSHR
                 {
                     _mount->setHomingOffset(StepperAxis::RA_STEPS, inCmd.substring(3).toInt());
                 }
@@ -2045,6 +2869,93 @@ String MeadeCommandProcessor::handleMeadeExtraCommands(String inCmd)
 #endif
         return String("0#");
     }
+    else if (inCmd[0] == 'E')
+    {  // Ephemeris tracking
+#if EPHEMERIS_TRACKING == 1
+        if (inCmd[1] == 'C')  // :XEC
+        {
+            _mount->clearEphemeris();
+            return String("1#");
+        }
+        else if (inCmd[1] == 'P')  // :XEP
+        {
+            int firstComma  = inCmd.indexOf(',', 2);
+            int secondComma = inCmd.indexOf(',', firstComma + 1);
+            if ((firstComma < 0) || (secondComma < 0))
+            {
+                return String("0#");
+            }
+            const uint32_t timeMs = inCmd.substring(2, firstComma).toInt();
+            const int32_t ra      = inCmd.substring(firstComma + 1, secondComma).toInt();
+            const int32_t dec     = inCmd.substring(secondComma + 1).toInt();
+            return _mount->addEphemerisPoint(timeMs, ra, dec) ? String("1#") : String("0#");
+        }
+        else if (inCmd[1] == 'F')  // :XEF
+        {
+            return _mount->startEphemerisTracking() ? String("1#") : String("0#");
+        }
+        else if (inCmd[1] == 'X')  // :XEX
+        {
+            _mount->stopEphemerisTracking();
+            return String("1#");
+        }
+        else if (inCmd[1] == 'G')  // :XEG
+        {
+            return _mount->getEphemerisStatus() + "#";
+        }
+#endif
+        return String("0#");
+    }
+    else if (inCmd[0] == 'Q')
+    {  // Target queue
+#if TARGET_QUEUE == 1
+        if ((inCmd[1] == 'A') || (inCmd[1] == 'R'))  // :XQA, :XQR
+        {
+            long values[4];
+            int start = 2;
+            for (int i = 0; i < 4; i++)
+            {
+                int end = inCmd.indexOf(',', start);
+                if ((end < 0) && (i < 3))
+                {
+                    return String("0#");
+                }
+                values[i] = ((end < 0) ? inCmd.substring(start) : inCmd.substring(start, end)).toInt();
+                start     = end + 1;
+            }
+            if ((values[2] < 0) || (values[2] > 65535) || (values[3] < 0) || (values[3] > 255))
+            {
+                return String("0#");
+            }
+            const bool added = _mount->addQueuedTarget(
+                values[0], values[1], static_cast<uint16_t>(values[2]), static_cast<uint8_t>(values[3]), inCmd[1] == 'R');
+            return added ? String("1#") : String("0#");
+        }
+        else if (inCmd[1] == 'S')  // :XQS
+        {
+            return _mount->startTargetQueue() ? String("1#") : String("0#");
+        }
+        else if (inCmd[1] == 'X')  // :XQX
+        {
+            _mount->abortTargetQueue();
+            return String("1#");
+        }
+        else if (inCmd[1] == 'C')  // :XQC
+        {
+            _mount->clearTargetQueue();
+            return String("1#");
+        }
+        else if (inCmd[1] == 'G')  // :XQG
+        {
+            return _mount->getTargetQueueStatus() + "#";
+        }
+#endif
+        return String("0#");
+    }
+    else if ((inCmd[0] == 'M') && (inCmd[1] == 'D'))  // :XMD
+    {
+        return _mount->dither(inCmd.substring(2).toFloat()) ? String("1#") : String("0#");
+    }
     else if ((inCmd[0] == 'F') && (inCmd[1] == 'R'))
     {
         _mount->clearConfiguration();  // :XFR
@@ -2120,6 +3031,28 @@ String MeadeCommandProcessor::handleMeadeSetSlewRate(String inCmd)
     return "";
 }
 
+/////////////////////////////
+// Tracking Rates
+/////////////////////////////
+String MeadeCommandProcessor::handleMeadeTrackingRate(String inCmd)
+{
+    switch (inCmd[0])
+    {
+        case 'Q':
+            _mount->setTrackingRate(TRACKING_SIDEREAL);
+            break;  // :TQ# Sidereal
+        case 'L':
+            _mount->setTrackingRate(TRACKING_LUNAR);
+            break;  // :TL# Lunar
+        case 'S':
+            _mount->setTrackingRate(TRACKING_SOLAR);
+            break;  // :TS# Solar
+        default:
+            break;
+    }
+    return "";
+}
+
 /////////////////////////////
 // FOCUS COMMANDS
 /////////////////////////////
@@ -2197,6 +3130,7 @@ String MeadeCommandProcessor::handleMeadeFocusCommands(String inCmd)
 
 String MeadeCommandProcessor::processCommand(String inCmd)
 {
+    ProfileScope profile(PROFILE_COMMAND);
     if (inCmd[0] == ':')
     {
         LOG(DEBUG_MEADE, "[MEADE]: Received command '%s'", inCmd.c_str());
@@ -2232,6 +3166,8 @@ String MeadeCommandProcessor::processCommand(String inCmd)
                 return handleMeadeQuit(inCmd);
             case 'R':
                 return handleMeadeSetSlewRate(inCmd);
+            case 'T':
+                return handleMeadeTrackingRate(inCmd);
             case 'D':
                 return handleMeadeDistance(inCmd);
             case 'X':
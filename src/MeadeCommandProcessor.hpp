@@ -23,6 +23,7 @@ class MeadeCommandProcessor
     String handleMeadeQuit(String inCmd);
     String handleMeadeDistance(String inCmd);
     String handleMeadeSetSlewRate(String inCmd);
+    String handleMeadeTrackingRate(String inCmd);
     String handleMeadeExtraCommands(String inCmd);
     String handleMeadeFocusCommands(String inCmd);
     Mount *_mount;
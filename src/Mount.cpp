@@ -3,10 +3,16 @@
 #include "EPROMStore.hpp"
 #include "LcdMenu.hpp"
 #include "HallSensorHoming.hpp"
+#include "StallGuardHoming.hpp"
 #include "EndSwitches.hpp"
 #include "Mount.hpp"
 #include "Sidereal.hpp"
+#include "Profiler.hpp"
+#include "Scheduler.hpp"
+#include "CriticalSection.hpp"
+#include "StepTiming.hpp"
 #include "libs/MappedDict/MappedDict.hpp"
+#include "libs/FixedTrig/FixedTrig.hpp"
 
 PUSH_NO_WARNINGS
 #ifdef NEW_STEPPER_LIB
@@ -46,6 +52,13 @@ POP_NO_WARNINGS
 
 #define UART_CONNECTION_TEST_RETRIES 5
 
+#define CLOCK_DRIFT_MAX_PPM          10000   // Syncs that disagree more than this reset the clock, they are not drift
+#define CLOCK_DRIFT_MAX_ERROR_PPM    100.0f  // Estimates less certain than this are not used
+#define CLOCK_DRIFT_STORED_ERROR_PPM 10.0f   // The drift changes with temperature, so a stored estimate is trusted no more than this
+#define CLOCK_DRIFT_MAX_BASELINE_S   86400L
+
+#define STEP_ENVELOPE_BRAKE_LATENCY_S 0.02f  // The deadline of the MOUNT task, which brakes for the step envelope
+
 const char *formatStringsDEC[] = {
     "",
     " {d}@ {m}' {s}\"",  // LCD Menu w/ cursor
@@ -66,6 +79,14 @@ const char *formatStringsRA[] = {
 
 const float siderealDegreesInHour = 14.95904348958;
 
+// RA axis rotation in arcsec/sec for each TrackingRate except TRACKING_CUSTOM
+const float trackingRateArcsecPerSecond[] = {
+    15.041067f,  // Sidereal
+    14.685f,     // Lunar
+    15.0f,       // Solar
+    15.0369f,    // King
+};
+
 /////////////////////////////////
 //
 // CTOR
@@ -86,9 +107,6 @@ Mount::Mount(LcdMenu *lcdMenu)
 
 {
     _commandReceived = 0;
-#if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
-    _loops = 0;
-#endif
     _lcdMenu = lcdMenu;
     initializeVariables();
 }
@@ -127,12 +145,89 @@ void Mount::initializeVariables()
     _rollCalibrationAngle  = 0;
 #endif
 
-    _localUtcOffset          = 0;
-    _localStartDate.year     = 2021;
-    _localStartDate.month    = 1;
-    _localStartDate.day      = 1;
-    _localStartTimeSetMillis = -1;
-    _lastTRKCheck            = 0;
+    _localUtcOffset           = 0;
+    _localStartDate.year      = 2021;
+    _localStartDate.month     = 1;
+    _localStartDate.day       = 1;
+    _localStartTimeSetMillis  = -1;
+    _clockDriftPpm            = 0;
+    _clockDriftErrorPpm       = CLOCK_DRIFT_MAX_ERROR_PPM;
+    _storedClockDriftErrorPpm = 2 * CLOCK_DRIFT_MAX_ERROR_PPM;
+    _driftReferenceSet        = false;
+    _driftReferenceSeconds    = 0;
+    _driftReferenceMillis     = 0;
+    _driftReferenceErrorMs    = 0;
+    _lastTRKCheck             = 0;
+
+    _guideRaStartTime        = 0;
+    _guideDecStartTime       = 0;
+    _guideRaDuration         = 0;
+    _guideDecDuration        = 0;
+    _guideRaBudget           = 0;
+    _guideDecBudget          = 0;
+    _guideRaStepsLeft        = 0;
+    _guideRaBudgetUsed       = false;
+    _guideRaStartPosition    = 0;
+    _guideDecStartPosition   = 0;
+    _lastGuideRaSteps        = 0;
+    _lastGuideDecSteps       = 0;
+    _guideRaSpeed            = 0;
+    _guideDecSpeed           = 0;
+    _guideRaRemainderSeconds = 0;
+    _ditherState             = DITHER_NONE;
+    _ditherSettleMs          = 0;
+    _ditherSettleStart       = 0;
+    resetGuideStatistics();
+
+    _autoMeridianFlip         = (AUTO_MERIDIAN_FLIP == 1);
+    _meridianFlipLeadMinutes  = AUTO_MERIDIAN_FLIP_LEAD_MINUTES;
+    _meridianFlipState        = FLIP_NONE;
+    _meridianFlipPendingSince = 0;
+    _forcedPierSide           = PIER_SIDE_AUTO;
+
+    _trackingRate              = TRACKING_SIDEREAL;
+    _trackingRateFactor        = 1.0f;
+    _trackingRateSpeed         = 0;
+    _decTrackingRate           = 0;
+    _decTrackingSpeed          = 0;
+    _decTrackingFoldedPosition = 0;
+    _trackingRateFoldTime      = 0;
+
+#if PEC_ENABLED == 1
+    memset(_pecTable, 0, sizeof(_pecTable));
+    memset(_pecRates, 0, sizeof(_pecRates));
+    memset(_pecRecordSums, 0, sizeof(_pecRecordSums));
+    _pecSegmentArcsec    = 0;
+    _pecRecordedSegments = 0;
+    _pecRecordSegment    = 0;
+    _pecRecording        = false;
+    _pecPlayback         = false;
+    _pecSegment          = 0;
+    _pecStepsLeft        = PEC_CYCLE_STEPS / PEC_SEGMENTS;
+    _pecSegmentChanged   = false;
+#endif
+
+#if EPHEMERIS_TRACKING == 1
+    _ephemerisStartMs   = 0;
+    _ephemerisUpdateMs  = 0;
+    _ephemerisFollowing = false;
+#endif
+
+#if STEP_ENVELOPE == 1
+    // Open until the first move sets the envelope
+    _raEnvelope  = {INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX, 0.0f, false, false};
+    _decEnvelope = _raEnvelope;
+#endif
+
+#if TARGET_QUEUE == 1
+    _targetQueueCount      = 0;
+    _targetQueueIndex      = 0;
+    _targetQueueCompleted  = 0;
+    _targetQueueState      = QUEUE_IDLE;
+    _targetQueueRA         = 0;
+    _targetQueueDEC        = 0;
+    _targetQueueDwellStart = 0;
+#endif
 }
 
 /////////////////////////////////
@@ -201,6 +296,12 @@ void Mount::readPersistentData()
     _stepsPerDECDegree = EEPROMStore::getDECStepsPerDegree();
     LOG(DEBUG_INFO, "[MOUNT]: EEPROM: DEC steps/deg is %f", _stepsPerDECDegree);
 
+#if PEC_ENABLED == 1
+    // Read before the speed calibration, which builds the PEC rates from it
+    _pecPlayback = EEPROMStore::getPECTable(_pecTable, PEC_SEGMENTS, PEC_CYCLE_STEPS);
+    LOG(DEBUG_INFO, "[MOUNT]: EEPROM: PEC table %s", _pecPlayback ? "loaded" : "not present");
+#endif
+
     float speed = EEPROMStore::getSpeedFactor();
     LOG(DEBUG_INFO, "[MOUNT]: EEPROM: Speed factor is %f", speed);
     setSpeedCalibration(speed, false);
@@ -217,6 +318,14 @@ void Mount::readPersistentData()
     _localUtcOffset = EEPROMStore::getUtcOffset();
     LOG(DEBUG_INFO, "[MOUNT]: EEPROM: UTC offset is %d", _localUtcOffset);
 
+    float driftErrorPpm;
+    if (EEPROMStore::getClockDrift(_clockDriftPpm, driftErrorPpm))
+    {
+        _clockDriftErrorPpm       = fmaxf(driftErrorPpm, CLOCK_DRIFT_STORED_ERROR_PPM);
+        _storedClockDriftErrorPpm = _clockDriftErrorPpm;
+    }
+    LOG(DEBUG_INFO, "[MOUNT]: EEPROM: Clock drift is %f ppm (+/- %f)", _clockDriftPpm, _clockDriftErrorPpm);
+
 #if USE_GYRO_LEVEL == 1
     _pitchCalibrationAngle = EEPROMStore::getPitchCalibrationAngle();
     LOG(DEBUG_INFO, "[MOUNT]: EEPROM: Pitch Offset is %f", _pitchCalibrationAngle);
@@ -269,6 +378,9 @@ void Mount::configureHemisphere(bool inNorthern, bool force)
         LOG(DEBUG_ANY, "[SYSTEM]: Configured RA steppers, DIR Invert is %d", invertDir);
         _stepperRA->setPinsInverted(invertDir, false, false);
         _stepperTRK->setPinsInverted(invertDir, false, false);
+#ifndef NEW_STEPPER_LIB
+        _stepperRAGUIDE->setPinsInverted(invertDir, false, false);
+#endif
 
         LOG(DEBUG_ANY, "[SYSTEM]: Reset RA and TRK positions to 0");
         _stepperTRK->setCurrentPosition(0);
@@ -302,6 +414,11 @@ void Mount::configureRAStepper(byte pin1, byte pin2, uint32_t maxSpeed, uint32_t
 
     // Use another AccelStepper to run the RA motor as well. This instance tracks earths rotation.
     _stepperTRK = new AccelStepper(AccelStepper::DRIVER, pin1, pin2);
+
+    // And one more for the RA guide pulses, so that TRK never has to change its speed to end a pulse.
+    _stepperRAGUIDE = new AccelStepper(AccelStepper::DRIVER, pin1, pin2);
+    _stepperRAGUIDE->setMaxSpeed(5000);
+    _stepperRAGUIDE->setAcceleration(15000);
 #endif
 
     _stepperRA->setMaxSpeed(maxSpeed);
@@ -892,15 +1009,77 @@ void Mount::setSpeedCalibration(float val, bool saveToStorage)
 
     LOG(DEBUG_MOUNT, "[MOUNT]: FactorToSpeed : %s, %s", String(val, 6).c_str(), String(_trackingSpeed, 6).c_str());
 
+    // The TRK stepper runs at the selected tracking rate, _trackingSpeed stays the sidereal speed of the RA ring.
+    _trackingRateSpeed = _trackingSpeed * _trackingRateFactor;
+
     if (saveToStorage)
         EEPROMStore::storeSpeedFactor(_trackingSpeedCalibration);
 
+#if PEC_ENABLED == 1
+    buildPecRates();
+#endif
+
     // If we are currently tracking, update the speed. No need to update microstepping mode
     if (isSlewingTRK())
     {
-        LOG(DEBUG_STEPPERS, "[MOUNT]: SpeedCalibration TRK.setSpeed(%f)", _trackingSpeed);
-        _stepperTRK->setSpeed(_trackingSpeed);
+        LOG(DEBUG_STEPPERS, "[MOUNT]: SpeedCalibration TRK.setSpeed(%f)", _trackingRateSpeed);
+        _stepperTRK->setSpeed(currentTrackingSpeed());
+    }
+}
+
+/////////////////////////////////
+//
+// setTrackingRate
+//
+/////////////////////////////////
+void Mount::setTrackingRate(TrackingRate rate, float raArcsecPerSec, float decArcsecPerSec)
+{
+    if (rate != TRACKING_CUSTOM)
+    {
+        raArcsecPerSec  = trackingRateArcsecPerSecond[rate];
+        decArcsecPerSec = 0;
     }
+    LOG(DEBUG_MOUNT, "[MOUNT]: Tracking rate %d, RA %f arcsec/s, DEC %f arcsec/s", rate, raArcsecPerSec, decArcsecPerSec);
+
+    // Whatever the old rate moved so far belongs to the old rate
+    foldTrackingRateMotion();
+    _trackingRate       = rate;
+    _trackingRateFactor = raArcsecPerSec / trackingRateArcsecPerSecond[TRACKING_SIDEREAL];
+    _decTrackingRate    = decArcsecPerSec;
+
+    // Rebuilds the TRK speed (and the PEC rates) and sets it if tracking
+    setSpeedCalibration(_trackingSpeedCalibration, false);
+    updateDecTrackingSpeed();
+}
+
+/////////////////////////////////
+//
+// getTrackingRate
+//
+/////////////////////////////////
+TrackingRate Mount::getTrackingRate() const
+{
+    return _trackingRate;
+}
+
+/////////////////////////////////
+//
+// getRaTrackingRate
+//
+/////////////////////////////////
+float Mount::getRaTrackingRate() const
+{
+    return _trackingRateFactor * trackingRateArcsecPerSecond[TRACKING_SIDEREAL];
+}
+
+/////////////////////////////////
+//
+// getDecTrackingRate
+//
+/////////////////////////////////
+float Mount::getDecTrackingRate() const
+{
+    return _decTrackingRate;
 }
 
 #if USE_GYRO_LEVEL == 1
@@ -1350,6 +1529,8 @@ const Declination Mount::currentDEC() const
 void Mount::syncPosition(DayTime ra, Declination dec)
 {
     long solutions[6];
+    // The sync replaces the position, so the tracking rate motion so far must not be folded in afterwards
+    foldTrackingRateMotion();
     _targetDEC = dec;
     _targetRA  = ra;
     LOG(DEBUG_COORD_CALC,
@@ -1375,6 +1556,7 @@ void Mount::syncPosition(DayTime ra, Declination dec)
     }
     LOG(DEBUG_COORD_CALC, "[MOUNT]: syncPosition: AdjustRA is %f", raAdjust);
     _zeroPosRA.addHours(raAdjust);
+    _guideRaRemainderSeconds = 0;
     LOG(DEBUG_COORD_CALC, "[MOUNT]: syncPosition: ZeroPosRA is now %f", _zeroPosRA.getTotalHours());
 
     // Adjust the home DEC position by the delta between the sync'd target and current position.
@@ -1418,6 +1600,14 @@ void Mount::syncPosition(DayTime ra, Declination dec)
 void Mount::startSlewingToTarget()
 {
     stopGuiding();
+#if GUIDE_RATE_LEARNING != 0
+    _guideRateLearner.reset();
+#endif
+#if EPHEMERIS_TRACKING == 1
+    stopEphemerisTracking();
+#endif
+    _meridianFlipState = FLIP_NONE;
+    foldTrackingRateMotion();
 
     // Make sure we're slewing at full speed on a GoTo
     LOG(DEBUG_STEPPERS, "[STEPPERS]: startSlewingToTarget: Set DEC to MaxSpeed(%l)", _maxDECSpeed);
@@ -1541,28 +1731,108 @@ void Mount::stopGuiding(bool ra, bool dec)
     // Stop RA guide first, since it's just a speed change back to tracking speed
     if (ra && (_mountStatus & STATUS_GUIDE_PULSE_RA))
     {
+        long stepsLeft;
+        long position;
+        {
+            CriticalSection lock;
+            stepsLeft          = _guideRaStepsLeft;
+            _guideRaStepsLeft  = 0;
+            _guideRaBudgetUsed = false;
+#ifndef NEW_STEPPER_LIB
+            // Fold the steps of the RA guide stepper into TRK. setCurrentPosition() clears the speed of both, TRK
+            // keeps the time of its last step, so tracking goes on without losing an interval.
+            const long guideSteps = _stepperRAGUIDE->currentPosition();
+            _stepperRAGUIDE->setCurrentPosition(0);
+            _stepperTRK->setCurrentPosition(_stepperTRK->currentPosition() + guideSteps);
+#endif
+            _stepperTRK->setSpeed(currentTrackingSpeed());
+            _mountStatus &= ~STATUS_GUIDE_PULSE_RA;
+            position = _stepperTRK->currentPosition();
+        }
+        unsigned long elapsed = millis() - _guideRaStartTime;
+
+        // Net displacement is the steps taken minus what tracking would have done in the same time.
+        float netSteps;
+        if (_guideRaBudget != 0)
+        {
+            // Only count the steps taken at guide speed, not the tracking steps after the budget ran out
+            _lastGuideRaSteps = _guideRaBudget - stepsLeft;
+            netSteps          = _lastGuideRaSteps * (1.0f - _trackingRateSpeed / _guideRaSpeed);
+        }
+        else
+        {
+            _lastGuideRaSteps = labs(position - _guideRaStartPosition);
+            netSteps          = position - _guideRaStartPosition;
+            if (_mountStatus & STATUS_TRACKING)
+            {
+                netSteps -= _trackingRateSpeed * elapsed / 1000.0f;
+            }
+        }
+
+        addRaDisplacement(netSteps);
+        const float stepsPerArcsec = _stepsPerRADegree * (1.0f * RA_TRACKING_MICROSTEPPING / RA_SLEW_MICROSTEPPING) / 3600.0f;
+        const float netArcsec      = netSteps / stepsPerArcsec;
+        recordGuidePulse(_guideStatsRA, _guideRaSpeed > _trackingRateSpeed, elapsed, _lastGuideRaSteps, netArcsec);
+#if GUIDE_RATE_LEARNING != 0
+        if ((_mountStatus & STATUS_TRACKING) && _guideRateLearner.addPulse(millis(), netArcsec))
+        {
+            learnTrackingRate();
+        }
+#endif
+#if PEC_ENABLED == 1
+        if (_pecRecording)
+        {
+            recordPecCorrection(netArcsec);
+        }
+#endif
         LOG(DEBUG_STEPPERS | DEBUG_GUIDE,
-            "[GUIDE]: stopGuide:    RA  set speed       : %f (at %l)",
-            _trackingSpeed,
-            _stepperTRK->currentPosition());
-        _stepperTRK->setSpeed(_trackingSpeed);
-        _mountStatus &= ~STATUS_GUIDE_PULSE_RA;
+            "[GUIDE]: stopGuide:    RA  set speed       : %f (at %l), %l of %l steps delivered, net %f steps",
+            _trackingRateSpeed,
+            position,
+            _lastGuideRaSteps,
+            _guideRaBudget,
+            netSteps);
     }
 
     if (dec && (_mountStatus & STATUS_GUIDE_PULSE_DEC))
     {
         LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: stopGuide:    DEC stop guide at   : %l", _stepperGUIDE->currentPosition());
 
-        // Stop DEC guiding and wait for it to stop.
-        _stepperGUIDE->stop();
-
-        while (_stepperGUIDE->isRunning())
+        if (_stepperGUIDE->distanceToGo() == 0)
         {
-            _stepperGUIDE->run();
-            _stepperTRK->runSpeed();
+            // Step budget used up, the stepper is already standing still.
+            _stepperGUIDE->setSpeed(_decTrackingSpeed);
+        }
+        else
+        {
+            // Stop DEC guiding and wait for it to stop.
+            _stepperGUIDE->stop();
+
+            while (_stepperGUIDE->isRunning())
+            {
+                _stepperGUIDE->run();
+                _stepperTRK->runSpeed();
+            }
+            _stepperGUIDE->setSpeed(_decTrackingSpeed);
         }
 
-        LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: stopGuide:    DEC stopped at      : %l", _stepperGUIDE->currentPosition());
+        const long netSteps = _stepperGUIDE->currentPosition() - _guideDecStartPosition;
+        _lastGuideDecSteps  = labs(netSteps);
+
+        // The guide stepper drives the DEC ring like the DEC stepper, only at guide microstepping.
+        const float stepsPerGuideDegree = _stepsPerDECDegree * (1.0f * DEC_GUIDE_MICROSTEPPING / DEC_SLEW_MICROSTEPPING);
+        _zeroPosDEC += netSteps / stepsPerGuideDegree;
+        _decTrackingFoldedPosition = _stepperGUIDE->currentPosition();
+        recordGuidePulse(_guideStatsDEC,
+                         _guideDecSpeed > 0,
+                         millis() - _guideDecStartTime,
+                         _lastGuideDecSteps,
+                         netSteps * 3600.0f / stepsPerGuideDegree);
+        LOG(DEBUG_STEPPERS | DEBUG_GUIDE,
+            "[GUIDE]: stopGuide:    DEC stopped at      : %l, %l of %l steps delivered",
+            _stepperGUIDE->currentPosition(),
+            _lastGuideDecSteps,
+            _guideDecBudget);
         _mountStatus &= ~STATUS_GUIDE_PULSE_DEC;
     }
 
@@ -1614,27 +1884,21 @@ void Mount::guidePulse(byte direction, int duration)
     float raGuidingSpeed = _stepsPerRADegree * (RA_TRACKING_MICROSTEPPING / RA_SLEW_MICROSTEPPING) * siderealDegreesInHour
                            / 3600.0f;  // u-steps/deg * deg/hr / sec/hr = u-steps/sec
 
-    // TODO: Do we need to track how many steps the steppers took and add them to the GoHome calculation?
-    // If so, we need to remember where we were when we started the guide pulse. Then at the end,
-    // we can calculate the difference. Ignore DEC Guide for now.
-    // TODO: Take guide pulses on DEC into account
+    // The net displacement of each pulse is folded into the zero positions in stopGuiding(), so that
+    // currentRA()/currentDEC() (and thus syncs and slews) include it.
 
     switch (direction)
     {
         case NORTH:
             LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC base speed      : %f", decGuidingSpeed);
             LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC guide speed     : %f", DEC_PULSE_MULTIPLIER * decGuidingSpeed);
-            _stepperGUIDE->setSpeed(DEC_PULSE_MULTIPLIER * decGuidingSpeed);
-            _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
-            _guideDecEndTime = millis() + duration;
+            startDecGuidePulse(DEC_PULSE_MULTIPLIER * decGuidingSpeed, duration);
             break;
 
         case SOUTH:
             LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC base speed      : %f", decGuidingSpeed);
             LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC guide speed     : %f", -DEC_PULSE_MULTIPLIER * decGuidingSpeed);
-            _stepperGUIDE->setSpeed(-DEC_PULSE_MULTIPLIER * decGuidingSpeed);
-            _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
-            _guideDecEndTime = millis() + duration;
+            startDecGuidePulse(-DEC_PULSE_MULTIPLIER * decGuidingSpeed, duration);
             break;
 
         case WEST:
@@ -1647,9 +1911,8 @@ void Mount::guidePulse(byte direction, int duration)
                 "[GUIDE]: guidePulse:   RA  guide speed     : %f (%f x adjusted speed)",
                 (RA_PULSE_MULTIPLIER * raGuidingSpeed),
                 RA_PULSE_MULTIPLIER);
-            _stepperTRK->setSpeed(RA_PULSE_MULTIPLIER * raGuidingSpeed);  // Faster than siderael
-            _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
-            _guideRaEndTime = millis() + duration;
+            // The guide rate is added to the selected tracking rate
+            startRaGuidePulse(raGuidingSpeed * (_trackingRateFactor + RA_PULSE_MULTIPLIER - 1.0f), duration);  // Faster than siderael
             break;
 
         case EAST:
@@ -1662,177 +1925,1123 @@ void Mount::guidePulse(byte direction, int duration)
                 "[GUIDE]: guidePulse:   RA  guide speed     : %f (%f x adjusted speed)",
                 (2.0 - RA_PULSE_MULTIPLIER * raGuidingSpeed),
                 (2.0 - RA_PULSE_MULTIPLIER));
-            _stepperTRK->setSpeed(raGuidingSpeed * (2.0f - RA_PULSE_MULTIPLIER));  // Slower than siderael
-            _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
-            _guideRaEndTime = millis() + duration;
+            // The guide rate is subtracted from the selected tracking rate
+            startRaGuidePulse(raGuidingSpeed * (_trackingRateFactor + 1.0f - RA_PULSE_MULTIPLIER), duration);  // Slower than siderael
             break;
     }
-// Since we will not be updating the display during a guide pulse, update the display here.
-#if INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE
-    updateInfoDisplay();
-#endif
+    // Show the guiding state right away
+    Scheduler::trigger(TASK_INFO_DISPLAY);
 
     LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse: < Guide Pulse");
 }
 
 /////////////////////////////////
 //
-// commandReceived()
+// startRaGuidePulse
 //
-// Keeps track of how many Meade commands have been processed.
 /////////////////////////////////
-void Mount::commandReceived()
+// Runs the RA motor at the given speed (u-steps/sec) for the given number of ms. The RA guide stepper takes the
+// pulse steps while TRK keeps the tracking speed. interruptLoop() counts the steps and hands the motor back to TRK
+// on the step that uses up the budget, so tracking goes on at once without a speed change in the interrupt.
+// processGuidePulses() then ends the pulse. With NEW_STEPPER_LIB, TRK itself runs the pulse, ended by time.
+void Mount::startRaGuidePulse(float speed, int duration)
 {
-    _commandReceived++;
+    long budget = lroundf(fabsf(speed) * duration / 1000.0f);
+#ifdef NEW_STEPPER_LIB
+    budget = 0;  // The stepper library generates the steps, so the pulse is ended by time.
+#else
+    if ((budget == 0) && (speed != 0) && (duration > 0))
+    {
+        // A short pulse at a low rate rounds to no steps, which would leave it to end by time. Take one step instead.
+        LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   RA  step budget rounded up to 1");
+        budget = 1;
+    }
+#endif
+    {
+        CriticalSection lock;
+        _guideRaStartPosition = _stepperTRK->currentPosition();
+        _guideRaStepsLeft     = budget;
+#ifdef NEW_STEPPER_LIB
+        _guideRaBudgetUsed = false;
+        _stepperTRK->setSpeed(speed);
+#else
+        _guideRaBudgetUsed = (budget == 0);
+        _stepperRAGUIDE->setCurrentPosition(0);
+        _stepperRAGUIDE->setSpeed(speed);
+#endif
+        _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
+    }
+    _guideRaBudget    = budget;
+    _guideRaSpeed     = speed;
+    _guideRaDuration  = duration;
+    _guideRaStartTime = millis();
+    LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   RA  step budget     : %l", budget);
 }
 
-#if SUPPORT_DRIFT_ALIGNMENT == 1
 /////////////////////////////////
 //
-// runDriftAlignmentPhase
+// startDecGuidePulse
 //
-// Runs one of the phases of the Drift alignment
-// This runs the RA motor 400 steps (about 5.3 arcminutes) in the given duration
-// This function should be callsed 3 times:
-// The first time with EAST, second with WEST and then with 0.
 /////////////////////////////////
-void Mount::runDriftAlignmentPhase(int direction, int durationSecs)
+// Moves the DEC guide stepper at the given speed (u-steps/sec) by the number of steps it makes in the
+// given number of ms, interruptLoop() stops at that target.
+void Mount::startDecGuidePulse(float speed, int duration)
 {
-    float const numArcMinutes(5.3);
-    long numSteps = floorf((_stepsPerRADegree * (numArcMinutes / 60.0f)));  // u-steps/deg * minutes / (minutes/deg) = u-steps
-
-    // Calculate the speed at which it takes the given duration to cover the steps.
-    float speed = numSteps / durationSecs;
-    switch (direction)
+    // The pulse replaces the DEC tracking rate, so fold what the rate moved so far
+    foldTrackingRateMotion();
+    long budget = lroundf(fabsf(speed) * duration / 1000.0f);
+#ifdef NEW_STEPPER_LIB
+    budget = 0;  // The stepper library generates the steps, so the pulse is ended by time.
+#else
+    if ((budget == 0) && (speed != 0) && (duration > 0))
     {
-        case EAST:
-            // Move steps east at the calculated speed, synchronously
-            _stepperRA->setMaxSpeed(speed);
-            _stepperRA->move(numSteps);
-            _stepperRA->runToPosition();
-
-            // Overcome the gearing gap
-            _stepperRA->setMaxSpeed(300);
-            _stepperRA->move(-20);
-            _stepperRA->runToPosition();
-            break;
-
-        case WEST:
-            // Move steps west at the calculated speed, synchronously
-            _stepperRA->setMaxSpeed(speed);
-            _stepperRA->move(-numSteps);
-            _stepperRA->runToPosition();
-            break;
+        // A short pulse at a low rate rounds to no steps, which would leave it to end by time. Take one step instead.
+        LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC step budget rounded up to 1");
+        budget = 1;
+    }
+#endif
+    {
+        CriticalSection lock;
+        _guideDecStartPosition = _stepperGUIDE->currentPosition();
+#ifndef NEW_STEPPER_LIB
+        _stepperGUIDE->moveTo(_guideDecStartPosition + ((speed < 0) ? -budget : budget));
+#endif
+        _stepperGUIDE->setSpeed(speed);
+        _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
+    }
+    _guideDecBudget    = budget;
+    _guideDecSpeed     = speed;
+    _guideDecDuration  = duration;
+    _guideDecStartTime = millis();
+    LOG(DEBUG_STEPPERS | DEBUG_GUIDE, "[GUIDE]: guidePulse:   DEC step budget     : %l", budget);
+}
 
-        case 0:
-            // Fix the gearing to go back the other way
-            _stepperRA->setMaxSpeed(300);
-            _stepperRA->move(20);
-            _stepperRA->runToPosition();
+/////////////////////////////////
+//
+// recordGuidePulse
+//
+/////////////////////////////////
+void Mount::recordGuidePulse(GuideAxisStatistics &stats, bool positive, unsigned long durationMs, long steps, float netArcsec)
+{
+    stats.pulses++;
+    stats.steps += steps;
+    stats.durationMs[positive ? 0 : 1] += durationMs;
+    stats.netArcsec += netArcsec;
+    stats.sumSquaresArcsec += netArcsec * netArcsec;
+}
 
-            // Re-configure the stepper to the correct parameters.
-            _stepperRA->setMaxSpeed(_maxRASpeed);
-            break;
+/////////////////////////////////
+//
+// getGuideStatistics
+//
+/////////////////////////////////
+String Mount::getGuideStatistics() const
+{
+    const char *names[2]                     = {"RA", "DEC"};
+    const GuideAxisStatistics *const axes[2] = {&_guideStatsRA, &_guideStatsDEC};
+    String result;
+    for (int i = 0; i < 2; i++)
+    {
+        const GuideAxisStatistics &stats = *axes[i];
+        float rms                        = 0;
+        if (stats.pulses != 0)
+        {
+            rms = sqrtf(stats.sumSquaresArcsec / stats.pulses);
+        }
+        if (i > 0)
+        {
+            result += '|';
+        }
+        result += String(names[i]) + ',' + String(stats.pulses) + ',' + String(stats.steps) + ',' + String(stats.durationMs[0]) + ','
+                  + String(stats.durationMs[1]) + ',' + String(stats.netArcsec, 2) + ',' + String(rms, 2);
     }
+    return result;
 }
-#endif
 
 /////////////////////////////////
 //
-// setManualSlewMode
+// resetGuideStatistics
 //
 /////////////////////////////////
-void Mount::setManualSlewMode(bool state)
+void Mount::resetGuideStatistics()
 {
-    if (state)
+    memset(&_guideStatsRA, 0, sizeof(_guideStatsRA));
+    memset(&_guideStatsDEC, 0, sizeof(_guideStatsDEC));
+}
+
+/////////////////////////////////
+//
+// dither
+//
+/////////////////////////////////
+bool Mount::dither(float radiusArcsec)
+{
+    if ((radiusArcsec <= 0) || !isSlewingTRK() || isSlewingRAorDEC() || isGuiding())
     {
-        stopSlewing(ALL_DIRECTIONS);
-        stopSlewing(TRACKING);
-        waitUntilStopped(ALL_DIRECTIONS);
-        _mountStatus |= STATUS_SLEWING | STATUS_SLEWING_MANUAL;
-#if RA_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Switching RA driver to microsteps(%d)", RA_SLEW_MICROSTEPPING);
-        _driverRA->microsteps(RA_SLEW_MICROSTEPPING == 1 ? 0 : RA_SLEW_MICROSTEPPING);
-#endif
+        return false;
     }
-    else
+
+    // Uniform over the disk of the given radius. The square root of a uniform Q30 value is the Q15 radius fraction.
+    const int16_t angle   = static_cast<int16_t>(random(0, 65536L));
+    const float distance  = radiusArcsec * FixedTrig::squareRoot(random(0, (1L << 30) + 1)) / 32768.0f;
+    const float raArcsec  = distance * FixedTrig::cosine(angle) / FixedTrig::ONE;
+    const float decArcsec = distance * FixedTrig::sine(angle) / FixedTrig::ONE;
+
+    // The RA axis has to turn further away from the equator for the same offset in the sky
+    const float decDegrees   = 90.0f - fabsf(currentDEC().getTotalDegrees());
+    const float decCosine    = 1.0f * FixedTrig::cosine(FixedTrig::fromDegrees(decDegrees)) / FixedTrig::ONE;
+    const float raAxisArcsec = raArcsec / max(decCosine, 0.1f);
+
+    // Net motion of the pulses against tracking, in arcsec per second (see guidePulse())
+    const int raDuration  = min(lroundf(fabsf(raAxisArcsec) * 1000.0f / ((RA_PULSE_MULTIPLIER - 1.0f) * siderealDegreesInHour)), 30000L);
+    const int decDuration = min(lroundf(fabsf(decArcsec) * 1000.0f / (DEC_PULSE_MULTIPLIER * siderealDegreesInHour)), 30000L);
+
+    // Guide pulses end without a ramp, so give each axis the time it would take to stop from the pulse speed at its
+    // configured acceleration. Speeds are in slew u-steps/sec, like the accelerations.
+    const float raPulseSpeed  = (RA_PULSE_MULTIPLIER - 1.0f) * _stepsPerRADegree * siderealDegreesInHour / 3600.0f;
+    const float decPulseSpeed = DEC_PULSE_MULTIPLIER * _stepsPerDECDegree * siderealDegreesInHour / 3600.0f;
+    float raSettleMs          = 0;
+    float decSettleMs         = 0;
+    if (raDuration > 0)
     {
-        _mountStatus &= ~STATUS_SLEWING_MANUAL;
-        stopSlewing(ALL_DIRECTIONS);
-        waitUntilStopped(ALL_DIRECTIONS);
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Set RA  speed/accel:  %l  / %l", _maxRASpeed, _maxRAAcceleration);
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Set DEC speed/accel:  %l  / %l", _maxDECSpeed, _maxDECAcceleration);
-        _stepperRA->setAcceleration(_maxRAAcceleration);
-        _stepperRA->setMaxSpeed(_maxRASpeed);
-        _stepperDEC->setMaxSpeed(_maxDECSpeed);
-        _stepperDEC->setAcceleration(_maxDECAcceleration);
-        startSlewing(TRACKING);
+        raSettleMs = 1000.0f * raPulseSpeed / max(1.0f * _maxRAAcceleration, 1.0f);
+    }
+    if (decDuration > 0)
+    {
+        decSettleMs = 1000.0f * decPulseSpeed / max(1.0f * _maxDECAcceleration, 1.0f);
+
+        // If DEC reverses (the last DEC pulse tells which way the gears are loaded), the backlash has to be taken up
+        // at the pulse speed first. BACKLASH_STEPS is in RA slew u-steps, but describes the motor gearbox.
+        if ((_guideDecSpeed != 0) && ((_guideDecSpeed > 0) != (decArcsec > 0)) && (decPulseSpeed > 0))
+        {
+            const float backlashSteps = 1.0f * _backlashCorrectionSteps * DEC_SLEW_MICROSTEPPING / RA_SLEW_MICROSTEPPING;
+            decSettleMs += 1000.0f * backlashSteps / decPulseSpeed;
+        }
+    }
+    _ditherSettleMs = DITHER_SETTLE_MS + lroundf(max(raSettleMs, decSettleMs));
+    LOG(DEBUG_GUIDE,
+        "[GUIDE]: Dither by %f arcsec RA, %f arcsec DEC: %dms RA, %dms DEC, settle %lms",
+        raArcsec,
+        decArcsec,
+        raDuration,
+        decDuration,
+        _ditherSettleMs);
+
+    if (raDuration > 0)
+    {
+        guidePulse((raAxisArcsec > 0) ? WEST : EAST, raDuration);
     }
+    if (decDuration > 0)
+    {
+        guidePulse((decArcsec > 0) ? NORTH : SOUTH, decDuration);
+    }
+    _ditherState = DITHER_MOVING;
+    return true;
 }
 
 /////////////////////////////////
 //
-// setSpeed
+// processDither
 //
 /////////////////////////////////
-void Mount::setSpeed(StepperAxis which, float speedDegsPerSec)
+// Starts the settle timer once the dither pulses have ended. A slew cancels the dither.
+void Mount::processDither()
 {
-    if (which == RA_STEPS)
-    {
-        float stepsPerSec = speedDegsPerSec * _stepsPerRADegree;  // deg/sec * u-steps/deg = u-steps/sec
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set RA speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
-        // TODO: Are we already in slew mode?
-        _stepperRA->setSpeed(stepsPerSec);
-    }
-    else if (which == DEC_STEPS)
+    if (_ditherState == DITHER_NONE)
     {
-        float stepsPerSec = speedDegsPerSec * _stepsPerDECDegree;  // deg/sec * u-steps/deg = u-steps/sec
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set DEC speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
-        // TODO: Are we already in slew mode?
-        _stepperDEC->setSpeed(stepsPerSec);
+        return;
     }
-#if (AZ_STEPPER_TYPE != STEPPER_TYPE_NONE)
-    else if (which == AZIMUTH_STEPS)
+    if (_mountStatus & STATUS_SLEWING)
     {
-        float stepsPerSec = speedDegsPerSec * _stepsPerAZDegree;  // deg/sec * u-steps/deg = u-steps/sec
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set AZ speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
-        _stepperAZ->setSpeed(stepsPerSec);
+        _ditherState = DITHER_NONE;
     }
-#endif
-#if (ALT_STEPPER_TYPE != STEPPER_TYPE_NONE)
-    else if (which == ALTITUDE_STEPS)
+    else if ((_ditherState == DITHER_MOVING) && !isGuiding())
     {
-        float stepsPerSec = speedDegsPerSec * _stepsPerALTDegree;  // deg/sec * u-steps/deg = u-steps/sec
-        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set ALT speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
-        _stepperALT->setSpeed(stepsPerSec);
+        _ditherState       = DITHER_SETTLING;
+        _ditherSettleStart = millis();
     }
-#endif
-
-#if (FOCUS_STEPPER_TYPE != STEPPER_TYPE_NONE)
-    else if (which == FOCUS_STEPS)
+    else if ((_ditherState == DITHER_SETTLING) && (millis() - _ditherSettleStart >= _ditherSettleMs))
     {
-        LOG(DEBUG_MOUNT | DEBUG_FOCUS, "[FOCUS]: setSpeed() Focuser setSpeed %f", speedDegsPerSec);
-        if (speedDegsPerSec != 0)
-        {
-            LOG(DEBUG_STEPPERS | DEBUG_FOCUS,
-                "[FOCUS]: Mount:setSpeed(): Enabling motor, setting speed to %f. Continuous",
-                speedDegsPerSec);
-            enableFocusMotor();
-            _stepperFocus->setMaxSpeed(speedDegsPerSec);
-            _stepperFocus->moveTo(sign(speedDegsPerSec) * 300000);
-            _focuserMode = FOCUS_TO_TARGET;
-        }
-        else
-        {
-            LOG(DEBUG_STEPPERS | DEBUG_FOCUS, "[FOCUS]: setSpeed(): Stopping motor.");
-            _stepperFocus->stop();
-        }
+        LOG(DEBUG_GUIDE, "[GUIDE]: Dither settled");
+        _ditherState = DITHER_SETTLED;
     }
-#endif
 }
 
-void Mount::getAZALTPositions(long &azPos, long &altPos)
-{
+#if GUIDE_RATE_LEARNING != 0
+/////////////////////////////////
+//
+// getLearnedSpeedCalibration
+//
+/////////////////////////////////
+// Works out the speed calibration that would have made the guide corrections of the fit unnecessary.
+// Returns false if the correction is too small to matter or too large to be a tracking rate error.
+bool Mount::getLearnedSpeedCalibration(const GuideRateLearner::Fit &fit, float &speedCalibration) const
+{
+    // A positive slope means the guider keeps adding steps, i.e. tracking is too slow.
+    const float correction = fit.arcsecPerHour / (3600.0f * siderealDegreesInHour);
+    speedCalibration       = _trackingSpeedCalibration * (1.0f + correction);
+    // Less than half a step of the CAL menu (0.0001) is not worth storing, more than 1% is not a rate error.
+    return fit.valid && (fabsf(correction) >= 0.00005f) && (fabsf(correction) <= 0.01f);
+}
+
+/////////////////////////////////
+//
+// learnTrackingRate
+//
+/////////////////////////////////
+// Called whenever the learner completed a bin of guide pulses.
+void Mount::learnTrackingRate()
+{
+    const GuideRateLearner::Fit fit = _guideRateLearner.fit();
+    float speedCalibration;
+    const bool useful = getLearnedSpeedCalibration(fit, speedCalibration);
+    LOG(DEBUG_GUIDE,
+        "[GUIDE]: Rate learning: %d bins over %ls, %f +/- %f arcsec/h, proposed factor %f",
+        fit.bins,
+        fit.spanSeconds,
+        fit.arcsecPerHour,
+        fit.stdErrArcsecPerHour,
+        speedCalibration);
+    #if GUIDE_RATE_LEARNING == 2
+    if (useful)
+    {
+        applyLearnedSpeedCalibration();
+    }
+    #else
+    (void) useful;
+    #endif
+}
+
+/////////////////////////////////
+//
+// getGuideRateLearning
+//
+/////////////////////////////////
+String Mount::getGuideRateLearning() const
+{
+    const GuideRateLearner::Fit fit = _guideRateLearner.fit();
+    float speedCalibration;
+    const bool useful = getLearnedSpeedCalibration(fit, speedCalibration);
+    return String(useful ? 1 : 0) + ',' + String(fit.bins) + ',' + String(fit.spanSeconds / 60) + ',' + String(fit.arcsecPerHour, 2) + ','
+           + String(fit.stdErrArcsecPerHour, 2) + ',' + String(speedCalibration, 5) + ',' + String(_guideRateLearner.getRejectedPulses());
+}
+
+/////////////////////////////////
+//
+// resetGuideRateLearning
+//
+/////////////////////////////////
+void Mount::resetGuideRateLearning()
+{
+    _guideRateLearner.reset();
+}
+
+/////////////////////////////////
+//
+// applyLearnedSpeedCalibration
+//
+/////////////////////////////////
+bool Mount::applyLearnedSpeedCalibration()
+{
+    float speedCalibration;
+    if (!getLearnedSpeedCalibration(_guideRateLearner.fit(), speedCalibration))
+    {
+        return false;
+    }
+    LOG(DEBUG_GUIDE | DEBUG_MOUNT, "[GUIDE]: Applying learned speed factor %f", speedCalibration);
+    setSpeedCalibration(speedCalibration, true);
+    // The guide history was recorded at the old rate, start over.
+    _guideRateLearner.reset();
+    return true;
+}
+#endif
+
+/////////////////////////////////
+//
+// currentTrackingSpeed
+//
+/////////////////////////////////
+float Mount::currentTrackingSpeed() const
+{
+#if PEC_ENABLED == 1
+    if (_pecPlayback)
+    {
+        return _pecRates[_pecSegment];
+    }
+#endif
+    return _trackingRateSpeed;
+}
+
+/////////////////////////////////
+//
+// addRaDisplacement
+//
+/////////////////////////////////
+// Folds TRK steps that were not needed to follow the stars (guide pulses, non-sidereal rates) into _zeroPosRA.
+void Mount::addRaDisplacement(float netSteps)
+{
+    // Tracking steps move the RA ring like slew steps, so a positive net moves the pointing to a lower RA.
+    const float stepsPerTrackingHour = _stepsPerRADegree * (1.0f * RA_TRACKING_MICROSTEPPING / RA_SLEW_MICROSTEPPING)
+                                       * siderealDegreesInHour;  // u-steps/deg * deg/hr = u-steps/hr
+    // _zeroPosRA only holds whole seconds, so carry the fraction over to the next call.
+    _guideRaRemainderSeconds -= 3600.0f * netSteps / stepsPerTrackingHour;
+    const long wholeSeconds = _guideRaRemainderSeconds;
+    _zeroPosRA.addSeconds(wholeSeconds);
+    _guideRaRemainderSeconds -= wholeSeconds;
+}
+
+/////////////////////////////////
+//
+// updateDecTrackingSpeed
+//
+/////////////////////////////////
+// Works out the GUIDE speed for the DEC rate of the tracking mode. Which way the stepper has to turn to go north
+// depends on the hemisphere and on which side of home the DEC axis is (see Declination.cpp).
+void Mount::updateDecTrackingSpeed()
+{
+    float speed = 0;
+    if (_decTrackingRate != 0)
+    {
+        const float stepsPerGuideDegree = _stepsPerDECDegree * (1.0f * DEC_GUIDE_MICROSTEPPING / DEC_SLEW_MICROSTEPPING);
+        const float degreePos           = (_stepperDEC->currentPosition() / _stepsPerDECDegree) + _zeroPosDEC;
+        const float northSign           = ((degreePos >= 0) == inNorthernHemisphere) ? -1.0f : 1.0f;
+        speed                           = northSign * _decTrackingRate * stepsPerGuideDegree / 3600.0f;
+    }
+    _decTrackingSpeed = speed;
+
+    // interruptLoop() runs the GUIDE stepper at this speed while tracking and not pulsing DEC
+    if ((_mountStatus & STATUS_TRACKING) && !(_mountStatus & STATUS_GUIDE_PULSE_DEC))
+    {
+        CriticalSection lock;
+        _stepperGUIDE->setSpeed(speed);
+    }
+}
+
+/////////////////////////////////
+//
+// foldTrackingRateMotion
+//
+/////////////////////////////////
+// Moves the motion of a non-sidereal tracking rate into the zero positions, so that currentRA() and currentDEC()
+// follow the tracked object. Called regularly by processMotion() and before anything that needs the exact position.
+void Mount::foldTrackingRateMotion()
+{
+    const unsigned long now = millis();
+    if ((_mountStatus & STATUS_TRACKING) && (_trackingRateFactor != 1.0f))
+    {
+        // Only the TRK steps beyond the sidereal rate move the pointing
+        addRaDisplacement((_trackingRateFactor - 1.0f) * _trackingSpeed * (now - _trackingRateFoldTime) / 1000.0f);
+    }
+    _trackingRateFoldTime = now;
+
+    // A DEC guide pulse folds its own steps when it ends
+    if (!(_mountStatus & STATUS_GUIDE_PULSE_DEC))
+    {
+        long position;
+        {
+            CriticalSection lock;
+            position = _stepperGUIDE->currentPosition();
+        }
+        if (position != _decTrackingFoldedPosition)
+        {
+            const float stepsPerGuideDegree = _stepsPerDECDegree * (1.0f * DEC_GUIDE_MICROSTEPPING / DEC_SLEW_MICROSTEPPING);
+            _zeroPosDEC += (position - _decTrackingFoldedPosition) / stepsPerGuideDegree;
+            _decTrackingFoldedPosition = position;
+        }
+        // The direction flips when DEC crosses home
+        updateDecTrackingSpeed();
+    }
+}
+
+#if PEC_ENABLED == 1
+/////////////////////////////////
+//
+// pecStep
+//
+/////////////////////////////////
+// Called from interruptLoop() for every TRK or RA guide step. Follows the motor phase in the direction of the step
+// (a fast enough guide pulse or tracking rate can turn the motor backwards) and flags a segment change,
+// processMotion() then switches the TRK speed to the rate of the new segment.
+void Mount::pecStep(bool forward)
+{
+    CriticalSection lock;
+    if (forward)
+    {
+        _pecStepsLeft = _pecStepsLeft - 1;
+        if (_pecStepsLeft <= 0)
+        {
+            _pecSegment        = (_pecSegment + 1) % PEC_SEGMENTS;
+            _pecStepsLeft      = PEC_CYCLE_STEPS / PEC_SEGMENTS;
+            _pecSegmentChanged = true;
+        }
+    }
+    else
+    {
+        _pecStepsLeft = _pecStepsLeft + 1;
+        if (_pecStepsLeft > PEC_CYCLE_STEPS / PEC_SEGMENTS)
+        {
+            _pecSegment        = (_pecSegment + PEC_SEGMENTS - 1) % PEC_SEGMENTS;
+            _pecStepsLeft      = 1;
+            _pecSegmentChanged = true;
+        }
+    }
+}
+
+/////////////////////////////////
+//
+// synchronizePec
+//
+/////////////////////////////////
+// Works out the segment from the RA motor phase. RA slews move the same motor as TRK, only at slew
+// microstepping, and the phase is counted from the home position.
+void Mount::synchronizePec()
+{
+    long phase;
+    {
+        CriticalSection lock;
+        phase = _stepperTRK->currentPosition() + _stepperRA->currentPosition() * RA_TRACKING_MICROSTEPPING / RA_SLEW_MICROSTEPPING;
+    }
+    phase %= PEC_CYCLE_STEPS;
+    if (phase < 0)
+    {
+        phase += PEC_CYCLE_STEPS;
+    }
+
+    {
+        CriticalSection lock;
+        _pecSegment   = phase / (PEC_CYCLE_STEPS / PEC_SEGMENTS);
+        _pecStepsLeft = PEC_CYCLE_STEPS / PEC_SEGMENTS - phase % (PEC_CYCLE_STEPS / PEC_SEGMENTS);
+    }
+    updatePecTrackingSpeed();
+}
+
+/////////////////////////////////
+//
+// updatePecTrackingSpeed
+//
+/////////////////////////////////
+// Sets the TRK speed of the current segment right away, unless tracking is off or an RA guide pulse runs.
+void Mount::updatePecTrackingSpeed()
+{
+    if (isSlewingTRK() && !(_mountStatus & STATUS_GUIDE_PULSE_RA))
+    {
+        CriticalSection lock;
+        _stepperTRK->setSpeed(currentTrackingSpeed());
+    }
+}
+
+/////////////////////////////////
+//
+// buildPecRates
+//
+/////////////////////////////////
+// Turns the correction of each segment into the TRK speed that adds it over the length of the segment.
+void Mount::buildPecRates()
+{
+    const float stepsPerArcsec  = _stepsPerRADegree * (1.0f * RA_TRACKING_MICROSTEPPING / RA_SLEW_MICROSTEPPING) / 3600.0f;
+    const float stepsPerSegment = PEC_CYCLE_STEPS / PEC_SEGMENTS;
+    for (uint8_t i = 0; i < PEC_SEGMENTS; i++)
+    {
+        const float rate = _trackingRateSpeed * (1.0f + _pecTable[i] / 16.0f * stepsPerArcsec / stepsPerSegment);
+        CriticalSection lock;
+        _pecRates[i] = rate;
+    }
+    updatePecTrackingSpeed();
+}
+
+/////////////////////////////////
+//
+// recordPecCorrection
+//
+/////////////////////////////////
+// Adds the net displacement of an RA guide pulse to the segment it ended in.
+void Mount::recordPecCorrection(float netArcsec)
+{
+    const uint8_t segment = _pecSegment;
+    if (segment != _pecRecordSegment)
+    {
+        // Close the previous segment. If guiding paused, the skipped segments count as without corrections.
+        const long sum = _pecRecordSums[_pecRecordSegment] + lroundf(_pecSegmentArcsec * 16.0f);
+        _pecRecordSums[_pecRecordSegment] = constrain(sum, -32767L, 32767L);
+        _pecRecordedSegments += (segment + PEC_SEGMENTS - _pecRecordSegment) % PEC_SEGMENTS;
+        _pecRecordSegment = segment;
+        _pecSegmentArcsec = 0;
+
+        if (_pecRecordedSegments >= PEC_RECORD_CYCLES * PEC_SEGMENTS)
+        {
+            finishPecRecording();
+            return;
+        }
+    }
+    _pecSegmentArcsec += netArcsec;
+}
+
+/////////////////////////////////
+//
+// finishPecRecording
+//
+/////////////////////////////////
+void Mount::finishPecRecording()
+{
+    // The mean of the corrections is a tracking rate error and not periodic, leave that to the speed calibration.
+    long total = 0;
+    for (uint8_t i = 0; i < PEC_SEGMENTS; i++)
+    {
+        total += _pecRecordSums[i];
+    }
+    const float mean = 1.0f * total / PEC_SEGMENTS;
+
+    // The guider corrected what the current table left over, so add to it while it is played back.
+    for (uint8_t i = 0; i < PEC_SEGMENTS; i++)
+    {
+        const long base  = _pecPlayback ? _pecTable[i] : 0;
+        const long value = base + lroundf((_pecRecordSums[i] - mean) / PEC_RECORD_CYCLES);
+        _pecTable[i]     = constrain(value, -127L, 127L);
+    }
+    _pecRecording = false;
+    LOG(DEBUG_GUIDE, "[PEC]: Recording finished after %d segments", _pecRecordedSegments);
+
+    EEPROMStore::storePECTable(_pecTable, PEC_SEGMENTS, PEC_CYCLE_STEPS);
+    _pecPlayback = true;
+    buildPecRates();
+}
+
+/////////////////////////////////
+//
+// startPecRecording
+//
+/////////////////////////////////
+bool Mount::startPecRecording()
+{
+    if (!isSlewingTRK())
+    {
+        return false;
+    }
+    memset(_pecRecordSums, 0, sizeof(_pecRecordSums));
+    _pecSegmentArcsec    = 0;
+    _pecRecordedSegments = 0;
+    _pecRecordSegment    = _pecSegment;
+    _pecRecording        = true;
+    LOG(DEBUG_GUIDE, "[PEC]: Recording started in segment %d", _pecRecordSegment);
+    return true;
+}
+
+/////////////////////////////////
+//
+// stopPecRecording
+//
+/////////////////////////////////
+void Mount::stopPecRecording()
+{
+    _pecRecording = false;
+}
+
+/////////////////////////////////
+//
+// setPecPlayback
+//
+/////////////////////////////////
+void Mount::setPecPlayback(bool enabled)
+{
+    _pecPlayback = enabled;
+    updatePecTrackingSpeed();
+}
+
+/////////////////////////////////
+//
+// clearPecTable
+//
+/////////////////////////////////
+void Mount::clearPecTable()
+{
+    memset(_pecTable, 0, sizeof(_pecTable));
+    EEPROMStore::storePECTable(_pecTable, PEC_SEGMENTS, PEC_CYCLE_STEPS);
+    buildPecRates();
+}
+
+/////////////////////////////////
+//
+// getPecStatus
+//
+/////////////////////////////////
+String Mount::getPecStatus() const
+{
+    // Peak to peak of the position error, which is the running sum of the corrections
+    long position    = 0;
+    long minPosition = 0;
+    long maxPosition = 0;
+    for (uint8_t i = 0; i < PEC_SEGMENTS; i++)
+    {
+        position += _pecTable[i];
+        minPosition = min(minPosition, position);
+        maxPosition = max(maxPosition, position);
+    }
+    const int percent = _pecRecording ? 100L * _pecRecordedSegments / (PEC_RECORD_CYCLES * PEC_SEGMENTS) : 0;
+    return String(_pecPlayback ? 1 : 0) + ',' + String(_pecRecording ? 1 : 0) + ',' + String(_pecSegment) + ',' + String(percent) + ','
+           + String((maxPosition - minPosition) / 16.0f, 2);
+}
+
+/////////////////////////////////
+//
+// getPecTable
+//
+/////////////////////////////////
+String Mount::getPecTable() const
+{
+    String result;
+    for (uint8_t i = 0; i < PEC_SEGMENTS; i++)
+    {
+        if (i > 0)
+        {
+            result += ',';
+        }
+        result += String(static_cast<int>(_pecTable[i]));
+    }
+    return result;
+}
+#endif
+
+#if EPHEMERIS_TRACKING == 1
+/////////////////////////////////
+//
+// clearEphemeris
+//
+/////////////////////////////////
+void Mount::clearEphemeris()
+{
+    stopEphemerisTracking();
+    _ephemeris.clear();
+    _ephemerisStartMs = millis();
+}
+
+/////////////////////////////////
+//
+// addEphemerisPoint
+//
+/////////////////////////////////
+bool Mount::addEphemerisPoint(uint32_t timeMs, int32_t ra, int32_t dec)
+{
+    return _ephemeris.add(timeMs, ra, dec);
+}
+
+/////////////////////////////////
+//
+// startEphemerisTracking
+//
+/////////////////////////////////
+// The mount is expected to point at the track position of the current track time, so the host slews there first.
+bool Mount::startEphemerisTracking()
+{
+    if (!_ephemeris.start(millis() - _ephemerisStartMs))
+    {
+        LOG(DEBUG_MOUNT, "[EPHEMERIS]: Track does not cover the current time");
+        return false;
+    }
+    if (!isSlewingTRK())
+    {
+        startSlewing(TRACKING);
+    }
+    LOG(DEBUG_MOUNT, "[EPHEMERIS]: Following %d points", _ephemeris.size());
+    _ephemerisFollowing = true;
+    followEphemeris();
+    return _ephemerisFollowing;
+}
+
+/////////////////////////////////
+//
+// stopEphemerisTracking
+//
+/////////////////////////////////
+void Mount::stopEphemerisTracking()
+{
+    if (_ephemerisFollowing)
+    {
+        _ephemerisFollowing = false;
+        setTrackingRate(TRACKING_SIDEREAL);
+    }
+}
+
+/////////////////////////////////
+//
+// followEphemeris
+//
+/////////////////////////////////
+// Called every EPHEMERIS_UPDATE_MS while following. Sets the custom tracking rate that gets the mount to the track
+// position of the next update. The RA limit is checked by checkRALimit(), the DEC limits are checked here since
+// the DEC rate moves the GUIDE stepper, which the slew limits do not see.
+void Mount::followEphemeris()
+{
+    _ephemerisUpdateMs = millis();
+    int32_t raRate;
+    int32_t decRate;
+    if (!_ephemeris.update(_ephemerisUpdateMs - _ephemerisStartMs, EPHEMERIS_UPDATE_MS, raRate, decRate))
+    {
+        LOG(DEBUG_MOUNT, "[EPHEMERIS]: End of track, back to sidereal");
+        stopEphemerisTracking();
+        return;
+    }
+
+    // Sidereal tracking holds RA, so an object moving east needs a slower rate
+    setTrackingRate(TRACKING_CUSTOM, trackingRateArcsecPerSecond[TRACKING_SIDEREAL] - raRate / 100.0f, decRate / 100.0f);
+
+    long guidePosition;
+    {
+        CriticalSection lock;
+        guidePosition = _stepperGUIDE->currentPosition();
+    }
+    const long decPosition = _stepperDEC->currentPosition() + guidePosition * DEC_SLEW_MICROSTEPPING / DEC_GUIDE_MICROSTEPPING;
+    if (((_decTrackingSpeed > 0) && (_decUpperLimit != 0) && (decPosition >= _decUpperLimit))
+        || ((_decTrackingSpeed < 0) && (_decLowerLimit != 0) && (decPosition <= _decLowerLimit)))
+    {
+        LOG(DEBUG_MOUNT, "[EPHEMERIS]: DEC limit reached at %l, back to sidereal", decPosition);
+        stopEphemerisTracking();
+    }
+}
+
+/////////////////////////////////
+//
+// getEphemerisStatus
+//
+/////////////////////////////////
+String Mount::getEphemerisStatus() const
+{
+    return String(_ephemerisFollowing ? 1 : 0) + ',' + String(millis() - _ephemerisStartMs) + ',' + String(_ephemeris.size()) + ','
+           + String(_ephemeris.space()) + ',' + String(_ephemeris.endTimeMs()) + ',' + String(_ephemeris.getRaResidual()) + ','
+           + String(_ephemeris.getDecResidual());
+}
+#endif
+
+#if TARGET_QUEUE == 1
+/////////////////////////////////
+//
+// clearTargetQueue
+//
+/////////////////////////////////
+void Mount::clearTargetQueue()
+{
+    abortTargetQueue();
+    _targetQueueCount     = 0;
+    _targetQueueIndex     = 0;
+    _targetQueueCompleted = 0;
+}
+
+/////////////////////////////////
+//
+// addQueuedTarget
+//
+/////////////////////////////////
+bool Mount::addQueuedTarget(long ra, long dec, uint16_t dwellSecs, uint8_t ditherArcsec, bool relative)
+{
+    if ((_targetQueueState != QUEUE_IDLE) || (_targetQueueCount == TARGET_QUEUE_SIZE))
+    {
+        return false;
+    }
+    QueuedTarget &target = _targetQueue[_targetQueueCount++];
+    target.ra            = ra;
+    target.dec           = dec;
+    target.dwellSecs     = dwellSecs;
+    target.ditherArcsec  = ditherArcsec;
+    target.relative      = relative;
+    return true;
+}
+
+/////////////////////////////////
+//
+// startTargetQueue
+//
+/////////////////////////////////
+bool Mount::startTargetQueue()
+{
+    if (_targetQueueCount == 0)
+    {
+        return false;
+    }
+
+    // Relative targets at the start of the queue are offsets from the last GoTo target
+    const long decSeconds = labs(_targetDEC.getTotalSeconds());
+    _targetQueueRA        = _targetRA.getTotalSeconds();
+    _targetQueueDEC       = inNorthernHemisphere ? (90L * 3600L) - decSeconds : decSeconds - (90L * 3600L);
+    _targetQueueIndex     = 0;
+    _targetQueueCompleted = 0;
+    LOG(DEBUG_MOUNT, "[QUEUE]: Starting with %d targets", _targetQueueCount);
+    slewToQueuedTarget();
+    return true;
+}
+
+/////////////////////////////////
+//
+// abortTargetQueue
+//
+/////////////////////////////////
+void Mount::abortTargetQueue()
+{
+    if (_targetQueueState != QUEUE_IDLE)
+    {
+        LOG(DEBUG_MOUNT, "[QUEUE]: Aborted at target %d", _targetQueueIndex);
+        _targetQueueState = QUEUE_IDLE;
+    }
+}
+
+/////////////////////////////////
+//
+// slewToQueuedTarget
+//
+/////////////////////////////////
+void Mount::slewToQueuedTarget()
+{
+    const QueuedTarget &target = _targetQueue[_targetQueueIndex];
+    if (target.relative)
+    {
+        _targetQueueRA += target.ra;
+        _targetQueueDEC += target.dec;
+    }
+    else
+    {
+        _targetQueueRA  = target.ra;
+        _targetQueueDEC = target.dec;
+    }
+    _targetQueueDEC = constrain(_targetQueueDEC, -90L * 3600L, 90L * 3600L);
+
+    long ra  = _targetQueueRA;
+    long dec = _targetQueueDEC;
+    if (target.ditherArcsec > 0)
+    {
+        // A second of RA is 15 arcsec on the equator and less towards the poles
+        const float decCosine         = 1.0f * FixedTrig::cosine(FixedTrig::fromDegrees(dec / 3600.0f)) / FixedTrig::ONE;
+        const float raArcsecPerSecond = 15.0f * max(decCosine, 0.1f);
+        ra += lroundf(random(-target.ditherArcsec, target.ditherArcsec + 1) / raArcsecPerSecond);
+        dec = constrain(dec + random(-target.ditherArcsec, target.ditherArcsec + 1), -90L * 3600L, 90L * 3600L);
+    }
+    ra = ((ra % 86400L) + 86400L) % 86400L;
+
+    LOG(DEBUG_MOUNT, "[QUEUE]: Slewing to target %d at RA %l sec, DEC %l arcsec", _targetQueueIndex, ra, dec);
+    _targetRA  = DayTime(static_cast<int>(ra / 3600), static_cast<int>((ra / 60) % 60), static_cast<int>(ra % 60));
+    _targetDEC = Declination::FromSeconds(dec);
+    startSlewingToTarget();
+    _targetQueueState = QUEUE_SLEWING;
+}
+
+/////////////////////////////////
+//
+// processTargetQueue
+//
+/////////////////////////////////
+// Moves the queue on once the mount arrived at a target and the dwell time is over, so the host does not need
+// to issue each GoTo and poll for its end.
+void Mount::processTargetQueue()
+{
+    if ((_targetQueueState == QUEUE_SLEWING) && !isSlewingRAorDEC())
+    {
+        LOG(DEBUG_MOUNT, "[QUEUE]: Arrived at target %d", _targetQueueIndex);
+        _targetQueueState      = QUEUE_DWELLING;
+        _targetQueueDwellStart = millis();
+    }
+    else if ((_targetQueueState == QUEUE_DWELLING)
+             && (millis() - _targetQueueDwellStart >= 1000UL * _targetQueue[_targetQueueIndex].dwellSecs))
+    {
+        _targetQueueCompleted++;
+        if (++_targetQueueIndex < _targetQueueCount)
+        {
+            slewToQueuedTarget();
+        }
+        else
+        {
+            LOG(DEBUG_MOUNT, "[QUEUE]: All %d targets done", _targetQueueCount);
+            _targetQueueState = QUEUE_IDLE;
+        }
+    }
+}
+
+/////////////////////////////////
+//
+// getTargetQueueStatus
+//
+/////////////////////////////////
+String Mount::getTargetQueueStatus() const
+{
+    const char *states[] = {"IDLE", "SLEWING", "DWELLING"};
+    long dwellSecsLeft   = 0;
+    if (_targetQueueState == QUEUE_DWELLING)
+    {
+        dwellSecsLeft = _targetQueue[_targetQueueIndex].dwellSecs - static_cast<long>((millis() - _targetQueueDwellStart) / 1000UL);
+        dwellSecsLeft = max(dwellSecsLeft, 0L);
+    }
+    return String(states[_targetQueueState]) + ',' + String(_targetQueueIndex) + ',' + String(_targetQueueCount) + ','
+           + String(_targetQueueCompleted) + ',' + String(dwellSecsLeft);
+}
+#endif
+
+/////////////////////////////////
+//
+// getLastGuidePulseSteps
+//
+/////////////////////////////////
+String Mount::getLastGuidePulseSteps() const
+{
+    return String(_lastGuideRaSteps) + "," + String(_guideRaBudget) + "," + String(_lastGuideDecSteps) + "," + String(_guideDecBudget);
+}
+
+/////////////////////////////////
+//
+// commandReceived()
+//
+// Keeps track of how many Meade commands have been processed.
+/////////////////////////////////
+void Mount::commandReceived()
+{
+    _commandReceived++;
+}
+
+#if SUPPORT_DRIFT_ALIGNMENT == 1
+/////////////////////////////////
+//
+// runDriftAlignmentPhase
+//
+// Runs one of the phases of the Drift alignment
+// This runs the RA motor 400 steps (about 5.3 arcminutes) in the given duration
+// This function should be callsed 3 times:
+// The first time with EAST, second with WEST and then with 0.
+/////////////////////////////////
+void Mount::runDriftAlignmentPhase(int direction, int durationSecs)
+{
+    float const numArcMinutes(5.3);
+    long numSteps = floorf((_stepsPerRADegree * (numArcMinutes / 60.0f)));  // u-steps/deg * minutes / (minutes/deg) = u-steps
+
+    // Calculate the speed at which it takes the given duration to cover the steps.
+    float speed = numSteps / durationSecs;
+    switch (direction)
+    {
+        case EAST:
+            // Move steps east at the calculated speed, synchronously
+            _stepperRA->setMaxSpeed(speed);
+            _stepperRA->move(numSteps);
+            _stepperRA->runToPosition();
+
+            // Overcome the gearing gap
+            _stepperRA->setMaxSpeed(300);
+            _stepperRA->move(-20);
+            _stepperRA->runToPosition();
+            break;
+
+        case WEST:
+            // Move steps west at the calculated speed, synchronously
+            _stepperRA->setMaxSpeed(speed);
+            _stepperRA->move(-numSteps);
+            _stepperRA->runToPosition();
+            break;
+
+        case 0:
+            // Fix the gearing to go back the other way
+            _stepperRA->setMaxSpeed(300);
+            _stepperRA->move(20);
+            _stepperRA->runToPosition();
+
+            // Re-configure the stepper to the correct parameters.
+            _stepperRA->setMaxSpeed(_maxRASpeed);
+            break;
+    }
+}
+#endif
+
+/////////////////////////////////
+//
+// setManualSlewMode
+//
+/////////////////////////////////
+void Mount::setManualSlewMode(bool state)
+{
+    if (state)
+    {
+        stopSlewing(ALL_DIRECTIONS);
+        stopSlewing(TRACKING);
+        waitUntilStopped(ALL_DIRECTIONS);
+        _mountStatus |= STATUS_SLEWING | STATUS_SLEWING_MANUAL;
+#if STEP_ENVELOPE == 1
+        updateStepEnvelope();
+#endif
+#if RA_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Switching RA driver to microsteps(%d)", RA_SLEW_MICROSTEPPING);
+        _driverRA->microsteps(RA_SLEW_MICROSTEPPING == 1 ? 0 : RA_SLEW_MICROSTEPPING);
+#endif
+    }
+    else
+    {
+        _mountStatus &= ~STATUS_SLEWING_MANUAL;
+        stopSlewing(ALL_DIRECTIONS);
+        waitUntilStopped(ALL_DIRECTIONS);
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Set RA  speed/accel:  %l  / %l", _maxRASpeed, _maxRAAcceleration);
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setManualSlewMode: Set DEC speed/accel:  %l  / %l", _maxDECSpeed, _maxDECAcceleration);
+        _stepperRA->setAcceleration(_maxRAAcceleration);
+        _stepperRA->setMaxSpeed(_maxRASpeed);
+        _stepperDEC->setMaxSpeed(_maxDECSpeed);
+        _stepperDEC->setAcceleration(_maxDECAcceleration);
+        startSlewing(TRACKING);
+    }
+}
+
+/////////////////////////////////
+//
+// setSpeed
+//
+/////////////////////////////////
+void Mount::setSpeed(StepperAxis which, float speedDegsPerSec)
+{
+    if (which == RA_STEPS)
+    {
+        float stepsPerSec = speedDegsPerSec * _stepsPerRADegree;  // deg/sec * u-steps/deg = u-steps/sec
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set RA speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
+        // TODO: Are we already in slew mode?
+        _stepperRA->setSpeed(stepsPerSec);
+    }
+    else if (which == DEC_STEPS)
+    {
+        float stepsPerSec = speedDegsPerSec * _stepsPerDECDegree;  // deg/sec * u-steps/deg = u-steps/sec
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set DEC speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
+        // TODO: Are we already in slew mode?
+        _stepperDEC->setSpeed(stepsPerSec);
+    }
+#if (AZ_STEPPER_TYPE != STEPPER_TYPE_NONE)
+    else if (which == AZIMUTH_STEPS)
+    {
+        float stepsPerSec = speedDegsPerSec * _stepsPerAZDegree;  // deg/sec * u-steps/deg = u-steps/sec
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set AZ speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
+        _stepperAZ->setSpeed(stepsPerSec);
+    }
+#endif
+#if (ALT_STEPPER_TYPE != STEPPER_TYPE_NONE)
+    else if (which == ALTITUDE_STEPS)
+    {
+        float stepsPerSec = speedDegsPerSec * _stepsPerALTDegree;  // deg/sec * u-steps/deg = u-steps/sec
+        LOG(DEBUG_STEPPERS, "[STEPPERS]: setSpeed: Set ALT speed %f degs/s, which is %f steps/s", speedDegsPerSec, stepsPerSec);
+        _stepperALT->setSpeed(stepsPerSec);
+    }
+#endif
+
+#if (FOCUS_STEPPER_TYPE != STEPPER_TYPE_NONE)
+    else if (which == FOCUS_STEPS)
+    {
+        LOG(DEBUG_MOUNT | DEBUG_FOCUS, "[FOCUS]: setSpeed() Focuser setSpeed %f", speedDegsPerSec);
+        if (speedDegsPerSec != 0)
+        {
+            LOG(DEBUG_STEPPERS | DEBUG_FOCUS,
+                "[FOCUS]: Mount:setSpeed(): Enabling motor, setting speed to %f. Continuous",
+                speedDegsPerSec);
+            enableFocusMotor();
+            _stepperFocus->setMaxSpeed(speedDegsPerSec);
+            _stepperFocus->moveTo(sign(speedDegsPerSec) * 300000);
+            _focuserMode = FOCUS_TO_TARGET;
+        }
+        else
+        {
+            LOG(DEBUG_STEPPERS | DEBUG_FOCUS, "[FOCUS]: setSpeed(): Stopping motor.");
+            _stepperFocus->stop();
+        }
+    }
+#endif
+}
+
+void Mount::getAZALTPositions(long &azPos, long &altPos)
+{
 #if (AZ_STEPPER_TYPE != STEPPER_TYPE_NONE)
     azPos = _stepperAZ->currentPosition();
 #else
@@ -2170,6 +3379,9 @@ void Mount::focusStop()
 void Mount::setTrackingStepperPos(long stepPos)
 {
     _stepperTRK->setCurrentPosition(stepPos);
+#if PEC_ENABLED == 1
+    synchronizePec();
+#endif
 }
 
 void Mount::setStatusFlag(int flag)
@@ -2282,6 +3494,11 @@ String Mount::getStatusString()
     status += ",";
 #endif
 
+    const char *ditherStates[] = {"", "Dithering", "Settling", "Settled"};
+    status += String(ditherStates[_ditherState]) + ",";
+    const char *flipStates[] = {"", "FlipPending", "Flipping", "Flipped"};
+    status += String(flipStates[_meridianFlipState]) + ",";
+
     return status;
 }
 
@@ -2398,10 +3615,16 @@ void Mount::startSlewing(int direction)
             LOG(DEBUG_STEPPERS, "[STEPPERS]: startSlewing: Tracking: Switching RA driver to microsteps(%d)", RA_TRACKING_MICROSTEPPING);
             _driverRA->microsteps(RA_TRACKING_MICROSTEPPING == 1 ? 0 : RA_TRACKING_MICROSTEPPING);
 #endif
-            _stepperTRK->setSpeed(_trackingSpeed);
+#if PEC_ENABLED == 1
+            // RA may have moved since tracking stopped
+            synchronizePec();
+#endif
+            _stepperTRK->setSpeed(currentTrackingSpeed());
 
-            // Turn on tracking
+            // Turn on tracking, the tracking rate motion is counted from now on
+            foldTrackingRateMotion();
             _mountStatus |= STATUS_TRACKING;
+            updateDecTrackingSpeed();
         }
         else
         {
@@ -2492,6 +3715,9 @@ void Mount::startSlewing(int direction)
                 _stepperRA->moveTo(sign * targetWestPos);
                 _mountStatus |= STATUS_SLEWING;
             }
+#if STEP_ENVELOPE == 1
+            updateStepEnvelope();
+#endif
         }
     }
 }
@@ -2506,13 +3732,36 @@ void Mount::stopSlewing(int direction)
 {
     if (direction & TRACKING)
     {
+#if EPHEMERIS_TRACKING == 1
+        stopEphemerisTracking();
+#endif
         // Turn off tracking
+        foldTrackingRateMotion();
         _mountStatus &= ~STATUS_TRACKING;
+#if GUIDE_RATE_LEARNING != 0
+        _guideRateLearner.reset();
+#endif
+#if PEC_ENABLED == 1
+        if (_pecRecording)
+        {
+            LOG(DEBUG_GUIDE, "[PEC]: Tracking stopped, recording aborted");
+            _pecRecording = false;
+        }
+#endif
 
         LOG(DEBUG_STEPPERS, "[STEPPERS]: stopSlewing: TRK stepper stop()");
         _stepperTRK->stop();
     }
 
+    // Stopping both axes (:Q#, parking, the menus) also stops the queue and a meridian flip
+    if ((direction & ALL_DIRECTIONS) == ALL_DIRECTIONS)
+    {
+#if TARGET_QUEUE == 1
+        abortTargetQueue();
+#endif
+        _meridianFlipState = FLIP_NONE;
+    }
+
     if ((direction & (NORTH | SOUTH)) != 0)
     {
         LOG(DEBUG_STEPPERS, "[STEPPERS]: stopSlewing: DEC stepper stop()");
@@ -2635,37 +3884,74 @@ long Mount::getCurrentStepperPosition(StepperAxis axis)
 
 /////////////////////////////////
 //
-// setHomingOffset
+// setHomingOffset
+//
+/////////////////////////////////
+void Mount::setHomingOffset(StepperAxis axis, long offset)
+{
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        EEPROMStore::storeRAHomingOffset(offset);
+        LOG(DEBUG_MOUNT, "[MOUNT]: setHomingOffset(RA): Offset: %l", offset);
+    }
+    if (axis == StepperAxis::DEC_STEPS)
+    {
+        EEPROMStore::storeDECHomingOffset(offset);
+        LOG(DEBUG_MOUNT, "[MOUNT]: setDECHomingOffset(DEC): Offset: %l", offset);
+    }
+}
+
+/////////////////////////////////
+//
+// getHomingOffset
+//
+/////////////////////////////////
+long Mount::getHomingOffset(StepperAxis axis)
+{
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        return EEPROMStore::getRAHomingOffset();
+    }
+    else if (axis == StepperAxis::DEC_STEPS)
+    {
+        return EEPROMStore::getDECHomingOffset();
+    }
+    return 0;
+}
+
+/////////////////////////////////
+//
+// setStallHomingOffset
 //
 /////////////////////////////////
-void Mount::setHomingOffset(StepperAxis axis, long offset)
+void Mount::setStallHomingOffset(StepperAxis axis, long offset)
 {
     if (axis == StepperAxis::RA_STEPS)
     {
-        EEPROMStore::storeRAHomingOffset(offset);
-        LOG(DEBUG_MOUNT, "[MOUNT]: setHomingOffset(RA): Offset: %l", offset);
+        EEPROMStore::storeRAStallHomingOffset(offset);
+        LOG(DEBUG_MOUNT, "[MOUNT]: setStallHomingOffset(RA): Offset: %l", offset);
     }
     if (axis == StepperAxis::DEC_STEPS)
     {
-        EEPROMStore::storeDECHomingOffset(offset);
-        LOG(DEBUG_MOUNT, "[MOUNT]: setDECHomingOffset(DEC): Offset: %l", offset);
+        EEPROMStore::storeDECStallHomingOffset(offset);
+        LOG(DEBUG_MOUNT, "[MOUNT]: setStallHomingOffset(DEC): Offset: %l", offset);
     }
 }
 
 /////////////////////////////////
 //
-// getHomingOffset
+// getStallHomingOffset
 //
 /////////////////////////////////
-long Mount::getHomingOffset(StepperAxis axis)
+long Mount::getStallHomingOffset(StepperAxis axis)
 {
     if (axis == StepperAxis::RA_STEPS)
     {
-        return EEPROMStore::getRAHomingOffset();
+        return EEPROMStore::getRAStallHomingOffset();
     }
     else if (axis == StepperAxis::DEC_STEPS)
     {
-        return EEPROMStore::getDECHomingOffset();
+        return EEPROMStore::getDECStallHomingOffset();
     }
     return 0;
 }
@@ -2705,7 +3991,128 @@ bool Mount::findHomeByHallSensor(StepperAxis axis, int initialDirection, int sea
     #endif
     return false;
 }
+#endif
+
+#if (USE_STALLGUARD_RA_AUTOHOME == 1) || (USE_STALLGUARD_DEC_AUTOHOME == 1)
+/////////////////////////////////
+//
+// findHomeByStallGuard
+//
+/////////////////////////////////
+bool Mount::findHomeByStallGuard(StepperAxis axis)
+{
+    #if USE_STALLGUARD_RA_AUTOHOME == 1
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        if (!EEPROMStore::hasRAStallHomingOffset())
+        {
+            // Homing without an offset would put home at the hard stop
+            LOG(DEBUG_MOUNT, "[MOUNT]: findHomeByStallGuard(RA): No StallGuard homing offset set (:XSHRS), not homing");
+            return false;
+        }
+        if (_raStallHoming != nullptr)
+        {
+            delete _raStallHoming;
+        }
+        int32_t offset = EEPROMStore::getRAStallHomingOffset();
+        _raStallHoming = new StallGuardHoming(this, axis, _stepsPerRADegree, RA_DIAG_PIN, RA_STALL_HOMING_DIRECTION, offset);
+        return _raStallHoming->findHomeByStallGuard(RA_STALL_HOMING_SEARCH_DEGREES, RA_STALL_HOMING_SLEW_RATE);
+    }
+    #endif
+
+    #if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if (axis == StepperAxis::DEC_STEPS)
+    {
+        if (!EEPROMStore::hasDECStallHomingOffset())
+        {
+            LOG(DEBUG_MOUNT, "[MOUNT]: findHomeByStallGuard(DEC): No StallGuard homing offset set (:XSHDS), not homing");
+            return false;
+        }
+        if (_decStallHoming != nullptr)
+        {
+            delete _decStallHoming;
+        }
+        int32_t offset  = EEPROMStore::getDECStallHomingOffset();
+        _decStallHoming = new StallGuardHoming(this, axis, _stepsPerDECDegree, DEC_DIAG_PIN, DEC_STALL_HOMING_DIRECTION, offset);
+        return _decStallHoming->findHomeByStallGuard(DEC_STALL_HOMING_SEARCH_DEGREES, DEC_STALL_HOMING_SLEW_RATE);
+    }
+    #endif
+    return false;
+}
+
+/////////////////////////////////
+//
+// enableStallGuard
+//
+/////////////////////////////////
+void Mount::enableStallGuard(StepperAxis axis, bool enable)
+{
+    // StallGuard4 only measures the load in StealthChop
+    #if USE_STALLGUARD_RA_AUTOHOME == 1
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        _driverRA->en_spreadCycle(!enable && (RA_UART_STEALTH_MODE == 0));
+    }
+    #endif
+
+    #if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if (axis == StepperAxis::DEC_STEPS)
+    {
+        _driverDEC->en_spreadCycle(!enable && (DEC_UART_STEALTH_MODE == 0));
+    }
+    #endif
+}
+
+/////////////////////////////////
+//
+// isAxisStalled
+//
+/////////////////////////////////
+bool Mount::isAxisStalled(StepperAxis axis)
+{
+    // The TMC2209 signals a stall when SG_RESULT falls to twice SGTHRS
+    #if USE_STALLGUARD_RA_AUTOHOME == 1
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        return _driverRA->SG_RESULT() <= 2 * RA_STALL_VALUE;
+    }
+    #endif
+
+    #if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if (axis == StepperAxis::DEC_STEPS)
+    {
+        return _driverDEC->SG_RESULT() <= 2 * DEC_STALL_VALUE;
+    }
+    #endif
+    return false;
+}
+
+/////////////////////////////////
+//
+// hasStallGuardHomed
+//
+/////////////////////////////////
+bool Mount::hasStallGuardHomed(StepperAxis axis) const
+{
+    #if USE_STALLGUARD_RA_AUTOHOME == 1
+    if (axis == StepperAxis::RA_STEPS)
+    {
+        return (_raStallHoming != nullptr) && _raStallHoming->hasSucceeded();
+    }
+    #endif
+
+    #if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if (axis == StepperAxis::DEC_STEPS)
+    {
+        return (_decStallHoming != nullptr) && _decStallHoming->hasSucceeded();
+    }
+    #endif
+    return false;
+}
+#endif
 
+#if (USE_HALL_SENSOR_RA_AUTOHOME == 1) || (USE_HALL_SENSOR_DEC_AUTOHOME == 1) || (USE_STALLGUARD_RA_AUTOHOME == 1)                         \
+    || (USE_STALLGUARD_DEC_AUTOHOME == 1)
 /////////////////////////////////
 //
 // processHomingProgress
@@ -2726,6 +4133,20 @@ void Mount::processHomingProgress()
         _decHoming->processHomingProgress();
     }
     #endif
+
+    #if USE_STALLGUARD_RA_AUTOHOME == 1
+    if ((_raStallHoming != nullptr) && (!_raStallHoming->isIdleOrComplete()))
+    {
+        _raStallHoming->processHomingProgress();
+    }
+    #endif
+
+    #if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if ((_decStallHoming != nullptr) && (!_decStallHoming->isIdleOrComplete()))
+    {
+        _decStallHoming->processHomingProgress();
+    }
+    #endif
 }
 #endif
 
@@ -2740,6 +4161,21 @@ String Mount::getAutoHomingStates() const
     else
     {
         state += _raHoming->getLastResult();
+        state += HallSensorHoming::getStatistics(StepperAxis::RA_STEPS);
+    }
+#endif
+#if USE_STALLGUARD_RA_AUTOHOME == 1
+    if ((_raStallHoming != nullptr) && (!_raStallHoming->isIdleOrComplete()))
+    {
+        state += _raStallHoming->getHomingState();
+    }
+    else if (_raStallHoming != nullptr)
+    {
+        state += _raStallHoming->getLastResult();
+    }
+    else
+    {
+        state += F("NEVER RUN");
     }
 #endif
     state += "|";
@@ -2751,6 +4187,21 @@ String Mount::getAutoHomingStates() const
     else
     {
         state += _decHoming->getLastResult();
+        state += HallSensorHoming::getStatistics(StepperAxis::DEC_STEPS);
+    }
+#endif
+#if USE_STALLGUARD_DEC_AUTOHOME == 1
+    if ((_decStallHoming != nullptr) && (!_decStallHoming->isIdleOrComplete()))
+    {
+        state += _decStallHoming->getHomingState();
+    }
+    else if (_decStallHoming != nullptr)
+    {
+        state += _decStallHoming->getLastResult();
+    }
+    else
+    {
+        state += F("NEVER RUN");
     }
 #endif
     return state;
@@ -2773,6 +4224,13 @@ void Mount::setupEndSwitches()
     _decEndSwitch = new EndSwitch(
         this, StepperAxis::DEC_STEPS, DEC_ENDSWITCH_DOWN_SENSOR_PIN, DEC_ENDSWITCH_UP_SENSOR_PIN, DEC_END_SWITCH_ACTIVE_STATE);
     #endif
+
+    // The switches are read twice per axis on every stepper interrupt, log what the port register reads save there
+    #if (USE_RA_END_SWITCH == 1)
+    FastInputPin::logReadCost(RA_ENDSWITCH_EAST_SENSOR_PIN);
+    #else
+    FastInputPin::logReadCost(DEC_ENDSWITCH_DOWN_SENSOR_PIN);
+    #endif
 }
 #endif
 
@@ -2791,6 +4249,84 @@ void Mount::delay(int ms)
     }
 }
 
+#if STEP_ENVELOPE == 1
+/////////////////////////////////
+//
+// withinStepEnvelope
+//
+/////////////////////////////////
+// Called from interruptLoop() before the axis runs, so it only compares. Flags an outwards move inside the braking
+// distance for brakeForStepEnvelope() and returns false once the axis is at the edge, so it takes no step past it.
+bool Mount::withinStepEnvelope(AccelStepper *stepper, StepEnvelope &envelope)
+{
+    CriticalSection lock;
+    const long position = stepper->currentPosition();
+    if ((stepper->speed() > 0) && (position >= envelope.brakeAbove))
+    {
+        envelope.approaching = true;
+        return position < envelope.maxSteps;
+    }
+    if ((stepper->speed() < 0) && (position <= envelope.brakeBelow))
+    {
+        envelope.approaching = true;
+        return position > envelope.minSteps;
+    }
+    envelope.approaching = false;
+    return true;
+}
+
+/////////////////////////////////
+//
+// brakeForStepEnvelope
+//
+/////////////////////////////////
+// Runs in the MOUNT task and slows down the moves withinStepEnvelope() flagged.
+void Mount::brakeForStepEnvelope(AccelStepper *stepper, StepEnvelope &envelope, bool constantSpeed)
+{
+    if (!envelope.approaching)
+    {
+        envelope.braking = false;
+        return;
+    }
+
+    long position;
+    float speed;
+    {
+        CriticalSection lock;
+        position = stepper->currentPosition();
+        speed    = stepper->speed();
+    }
+    const long stepsLeft = (speed > 0) ? envelope.maxSteps - position : position - envelope.minSteps;
+    if (stepsLeft <= 0)
+    {
+        // Braking started too late (the envelope changed under a running move), so stop dead. This also clears the
+        // target, so the slew ends where withinStepEnvelope() held the axis.
+        CriticalSection lock;
+        stepper->setCurrentPosition(stepper->currentPosition());
+    }
+    else if (!constantSpeed)
+    {
+        if (!envelope.braking)
+        {
+            // run() decelerates to the target stop() sets
+            CriticalSection lock;
+            stepper->stop();
+        }
+        envelope.braking = true;
+    }
+    else
+    {
+        // runSpeed() has no ramp, so cap the speed at the one that still stops at the edge: v^2 = 2 * a * d
+        const float brakeSpeed = sqrtf(2.0f * envelope.deceleration * stepsLeft);
+        if (fabsf(speed) > brakeSpeed)
+        {
+            CriticalSection lock;
+            stepper->setSpeed((speed > 0) ? brakeSpeed : -brakeSpeed);
+        }
+    }
+}
+#endif
+
 /////////////////////////////////
 //
 // interruptLoop()
@@ -2803,9 +4339,46 @@ void Mount::interruptLoop()
     // Only process guide pulses if we are tracking.
     if ((_mountStatus & STATUS_GUIDE_PULSE) && (_mountStatus & STATUS_TRACKING))
     {
-        _stepperTRK->runSpeed();
+        bool runTRK = true;
+    #ifndef NEW_STEPPER_LIB
+        // The RA guide stepper runs the pulse up to exactly the step that uses up its budget. Then TRK, which kept
+        // the tracking speed, takes over again right away, which keeps setSpeed() out of the interrupt.
+        if ((_mountStatus & STATUS_GUIDE_PULSE_RA) && !_guideRaBudgetUsed)
+        {
+            runTRK = false;
+            if (_stepperRAGUIDE->runSpeed())
+            {
+        #if STEP_TIMING_CAPTURE == 1
+                StepTiming::capture();
+        #endif
+                {
+                    CriticalSection lock;
+                    _guideRaStepsLeft  = _guideRaStepsLeft - 1;
+                    _guideRaBudgetUsed = (_guideRaStepsLeft <= 0);
+                }
+        #if PEC_ENABLED == 1
+                pecStep(_stepperRAGUIDE->speed() > 0);
+        #endif
+            }
+        }
+    #endif
+        if (runTRK && _stepperTRK->runSpeed())
+        {
+    #if STEP_TIMING_CAPTURE == 1
+            StepTiming::capture();
+    #endif
+    #if PEC_ENABLED == 1
+            pecStep(_stepperTRK->speed() > 0);
+    #endif
+        }
         if (_mountStatus & STATUS_GUIDE_PULSE_DEC)
         {
+            // Stops at the target set by startDecGuidePulse()
+            _stepperGUIDE->runSpeedToPosition();
+        }
+        else
+        {
+            // DEC tracking rate, no steps at speed 0
             _stepperGUIDE->runSpeed();
         }
         return;
@@ -2813,20 +4386,57 @@ void Mount::interruptLoop()
 
     if (_mountStatus & STATUS_TRACKING)
     {
-        _stepperTRK->runSpeed();
+        if (_stepperTRK->runSpeed())
+        {
+    #if STEP_TIMING_CAPTURE == 1
+            if (!(_mountStatus & STATUS_SLEWING))
+            {
+                StepTiming::capture();
+            }
+    #endif
+    #if PEC_ENABLED == 1
+            pecStep(_stepperTRK->speed() > 0);
+    #endif
+        }
+        // DEC tracking rate, no steps at speed 0. The GUIDE stepper shares the DEC pins, so not while slewing.
+        if (!(_mountStatus & (STATUS_SLEWING | STATUS_FINDING_HOME)))
+        {
+            _stepperGUIDE->runSpeed();
+        }
     }
 
     if (_mountStatus & STATUS_SLEWING)
     {
+    #if STEP_ENVELOPE == 1
+        // Homing looks for where home is, so the envelope (relative to home) does not apply yet
+        const bool enveloped = !(_mountStatus & STATUS_FINDING_HOME);
+        const bool runDEC    = !enveloped || withinStepEnvelope(_stepperDEC, _decEnvelope);
+        const bool runRA     = !enveloped || withinStepEnvelope(_stepperRA, _raEnvelope);
+    #else
+        const bool runDEC = true;
+        const bool runRA  = true;
+    #endif
         if (_mountStatus & STATUS_SLEWING_MANUAL)
         {
-            _stepperDEC->runSpeed();
-            _stepperRA->runSpeed();
+            if (runDEC)
+            {
+                _stepperDEC->runSpeed();
+            }
+            if (runRA)
+            {
+                _stepperRA->runSpeed();
+            }
         }
         else
         {
-            _stepperDEC->run();
-            _stepperRA->run();
+            if (runDEC)
+            {
+                _stepperDEC->run();
+            }
+            if (runRA)
+            {
+                _stepperRA->run();
+            }
         }
     }
 
@@ -2880,15 +4490,108 @@ void Mount::interruptLoop()
 //
 // loop
 //
-// Process any stepper changes.
+// Runs the mount tasks of the scheduler.
 /////////////////////////////////
+// Also called from functions that block (waitUntilStopped(), delay(), ...) to keep the mount serviced.
 void Mount::loop()
 {
+    Scheduler::run(TASK_MOUNT);
+}
+
+/////////////////////////////////
+//
+// processGuidePulses
+//
+// Scheduler task that ends guide pulses once their time is up.
+/////////////////////////////////
+void Mount::processGuidePulses()
+{
+    if (!isGuiding())
+    {
+        return;
+    }
+
+    // Pulses normally end in interruptLoop() when their step budget is used up, which only runs the
+    // guide steppers while tracking. Without a budget or when not tracking, the pulse ends by time.
+    unsigned long now   = millis();
+    bool tracking       = (_mountStatus & STATUS_TRACKING) != 0;
+    bool stopRaGuiding  = false;
+    bool stopDecGuiding = false;
+    if (_mountStatus & STATUS_GUIDE_PULSE_RA)
+    {
+        long stepsLeft;
+        {
+            CriticalSection lock;
+            stepsLeft = _guideRaStepsLeft;
+        }
+        bool timeUp   = now - _guideRaStartTime >= _guideRaDuration;
+        stopRaGuiding = ((_guideRaBudget == 0) || !tracking) ? timeUp : (stepsLeft == 0);
+    }
+    if (_mountStatus & STATUS_GUIDE_PULSE_DEC)
+    {
+        long distance;
+        {
+            CriticalSection lock;
+            distance = _stepperGUIDE->distanceToGo();
+        }
+        bool timeUp    = now - _guideDecStartTime >= _guideDecDuration;
+        stopDecGuiding = ((_guideDecBudget == 0) || !tracking) ? timeUp : (distance == 0);
+    }
+    if (stopRaGuiding || stopDecGuiding)
+    {
+        stopGuiding(stopRaGuiding, stopDecGuiding);
+    }
+}
+
+/////////////////////////////////
+//
+// processMotion
+//
+// Scheduler task that processes any stepper changes.
+/////////////////////////////////
+void Mount::processMotion()
+{
+    ProfileScope profile(PROFILE_MOUNT_LOOP);
     bool raStillRunning  = false;
     bool decStillRunning = false;
 
     unsigned long now = millis();
 
+#if (DEBUG_LEVEL > 0) && (BINARY_LOGS == true)
+    BinaryLog::drain();
+#endif
+
+    if (now - _trackingRateFoldTime >= 1000UL)
+    {
+        foldTrackingRateMotion();
+    }
+#if EPHEMERIS_TRACKING == 1
+    if (_ephemerisFollowing && (now - _ephemerisUpdateMs >= EPHEMERIS_UPDATE_MS))
+    {
+        followEphemeris();
+    }
+#endif
+#if TARGET_QUEUE == 1
+    processTargetQueue();
+#endif
+    processDither();
+    processMeridianFlip();
+#if PEC_ENABLED == 1
+    if (_pecSegmentChanged)
+    {
+        _pecSegmentChanged = false;
+        updatePecTrackingSpeed();
+    }
+#endif
+#if STEP_ENVELOPE == 1
+    if ((_mountStatus & STATUS_SLEWING) && !(_mountStatus & STATUS_FINDING_HOME))
+    {
+        const bool constantSpeed = (_mountStatus & STATUS_SLEWING_MANUAL) != 0;
+        brakeForStepEnvelope(_stepperDEC, _decEnvelope, constantSpeed);
+        brakeForStepEnvelope(_stepperRA, _raEnvelope, constantSpeed);
+    }
+#endif
+
 #if (DEBUG_LEVEL & DEBUG_MOUNT) && (DEBUG_LEVEL & DEBUG_VERBOSE)
     if (now - _lastMountPrint > 2000)
     {
@@ -2952,19 +4655,7 @@ void Mount::loop()
 
     if (isGuiding())
     {
-        now                 = millis();
-        bool stopRaGuiding  = (now > _guideRaEndTime) && (_mountStatus & STATUS_GUIDE_PULSE_RA);
-        bool stopDecGuiding = (now > _guideDecEndTime) && (_mountStatus & STATUS_GUIDE_PULSE_DEC);
-        if (stopRaGuiding || stopDecGuiding)
-        {
-            stopGuiding(stopRaGuiding, stopDecGuiding);
-        }
-        else
-        {
-#if INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE
-            updateInfoDisplay();
-#endif
-        }
+        // Guide pulse expiry is handled by processGuidePulses()
         return;
     }
 
@@ -3141,10 +4832,12 @@ void Mount::loop()
 
             // Make sure we do one last update when the steppers have stopped.
             displayStepperPosition();
+            Scheduler::trigger(TASK_INFO_DISPLAY);
         }
     }
 
-#if (USE_HALL_SENSOR_RA_AUTOHOME == 1) || (USE_HALL_SENSOR_DEC_AUTOHOME == 1)
+#if (USE_HALL_SENSOR_RA_AUTOHOME == 1) || (USE_HALL_SENSOR_DEC_AUTOHOME == 1) || (USE_STALLGUARD_RA_AUTOHOME == 1)                         \
+    || (USE_STALLGUARD_DEC_AUTOHOME == 1)
     if (_mountStatus & STATUS_FINDING_HOME)
     {
         processHomingProgress();
@@ -3162,9 +4855,6 @@ void Mount::loop()
 #endif
 
     _stepperWasRunning = raStillRunning || decStillRunning;
-#if INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE
-    updateInfoDisplay();
-#endif
 }
 
 #if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
@@ -3182,14 +4872,10 @@ void Mount::setupInfoDisplay()
 void Mount::updateInfoDisplay()
 {
     #if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
-    _loops++;
-    // Update display every 8 cycles
-    if (_loops % 8 == 0)
-    {
-        LOG(DEBUG_DISPLAY, "[DISPLAY]: Render state to OLED ...");
-        infoDisplay->render(this);
-        LOG(DEBUG_DISPLAY, "[DISPLAY]: Rendered state to OLED ...");
-    }
+    ProfileScope profile(PROFILE_DISPLAY);
+    LOG(DEBUG_DISPLAY, "[DISPLAY]: Render state to OLED ...");
+    infoDisplay->render(this);
+    LOG(DEBUG_DISPLAY, "[DISPLAY]: Rendered state to OLED ...");
     #endif
 }
 
@@ -3319,12 +5005,17 @@ void Mount::setHome(bool clearZeroPos)
 #ifdef OAM
     _zeroPosRA.addHours(6);  // shift allcoordinates by 90° for EQ mount movement
 #endif
-    _zeroPosDEC = 0.0f;
+    _zeroPosDEC              = 0.0f;
+    _guideRaRemainderSeconds = 0;
 
     _stepperRA->setCurrentPosition(0);
     _stepperDEC->setCurrentPosition(0);
     _stepperTRK->setCurrentPosition(0);
     _stepperGUIDE->setCurrentPosition(0);
+    _decTrackingFoldedPosition = 0;
+#if PEC_ENABLED == 1
+    synchronizePec();
+#endif
 
     _targetRA      = currentRA();
     _slewingToHome = false;
@@ -3381,7 +5072,7 @@ void Mount::calculateStepperPositions(float raCoord, float decCoord, long &raPos
 //
 // This code tells the steppers to what location to move to, given the select right ascension and declination
 /////////////////////////////////
-void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps, long pSolutions[6]) const
+void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps, long pSolutions[6], PierSide *pPierSide) const
 {
     LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersPre: Current : RA: %s, DEC: %s", currentRA().ToString(), currentDEC().ToString());
     LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersPre: Target  : RA: %s, DEC: %s", _targetRA.ToString(), _targetDEC.ToString());
@@ -3480,12 +5171,45 @@ void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps,
         pSolutions[5] = long(-moveDEC) * _stepsPerDECDegree;
     }
 
-    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 1: %f, %f", -moveRA, moveDEC);
-    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 2: %f, %f", -(moveRA - 12.0f), -moveDEC);
-    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 3: %f, %f", -(moveRA + 12.0f), -moveDEC);
-
+    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 1: %f, %f", -moveRA, moveDEC);
+    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 2: %f, %f", -(moveRA - 12.0f), -moveDEC);
+    LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Solution 3: %f, %f", -(moveRA + 12.0f), -moveDEC);
+
+    // A meridian flip picks the side of the pier itself, as long as the RA ring stays within the limits on that side.
+    // Otherwise the side is picked by the limits as usual.
+    PierSide pierSide = PIER_SIDE_AUTO;
+    if (_forcedPierSide != PIER_SIDE_AUTO)
+    {
+        // Turn the same way solutions 2 and 3 do. moveRA includes the time tracked since home, so its sign can send the
+        // ring the long way around.
+        const float flipHours   = (homeTargetDeltaRA > 0) ? -12.0f : 12.0f;
+        const float forcedDelta = (_forcedPierSide == PIER_SIDE_FLIPPED) ? homeTargetDeltaRA + flipHours : homeTargetDeltaRA;
+        if ((forcedDelta < RALimitL) || (forcedDelta > RALimitR))
+        {
+            LOG(DEBUG_MOUNT,
+                "[MOUNT]: CalcSteppersIn: Forced pier side %d is %f h from home, past the limits %f to %f. Ignoring it.",
+                _forcedPierSide,
+                forcedDelta,
+                RALimitL,
+                RALimitR);
+        }
+        else
+        {
+            pierSide = _forcedPierSide;
+            if (pierSide == PIER_SIDE_FLIPPED)
+            {
+                moveRA += flipHours;
+                moveDEC = -moveDEC;
+            }
+        }
+    }
+
+    if (pierSide != PIER_SIDE_AUTO)
+    {
+        LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Using forced pier side %d. RA: %f, DEC: %f", pierSide, moveRA, moveDEC);
+    }
     // If we reach the limit in the positive direction ...
-    if (homeTargetDeltaRA > RALimitR)
+    else if (homeTargetDeltaRA > RALimitR)
     {
         LOG(DEBUG_COORD_CALC,
             "[MOUNT]: CalcSteppersIn: Using Solution 2, since hometargetDeltaRA %f (RA:%f) is past max limit %f, inverting both axes",
@@ -3495,7 +5219,8 @@ void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps,
 
         // ... turn both RA and DEC axis around
         moveRA -= 12.0f;
-        moveDEC = -moveDEC;
+        moveDEC  = -moveDEC;
+        pierSide = PIER_SIDE_FLIPPED;
         LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Adjusted Target. RA: %f, DEC: %f", moveRA, moveDEC);
     }
     // If we reach the limit in the negative direction...
@@ -3509,7 +5234,8 @@ void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps,
         // ... turn both RA and DEC axis around
 
         moveRA += 12.0f;
-        moveDEC = -moveDEC;
+        moveDEC  = -moveDEC;
+        pierSide = PIER_SIDE_FLIPPED;
         LOG(DEBUG_COORD_CALC, "[MOUNT]: CalcSteppersIn: Adjusted Target. RA: %f, DEC: %f", moveRA, moveDEC);
     }
     else
@@ -3519,6 +5245,11 @@ void Mount::calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps,
             homeTargetDeltaRA,
             moveRA,
             moveDEC);
+        pierSide = PIER_SIDE_NORMAL;
+    }
+    if (pPierSide != nullptr)
+    {
+        *pPierSide = pierSide;
     }
 
     // zeroPosDEC will be zero unless one or more Sync commands have moved it, in which case it is the
@@ -3581,7 +5312,76 @@ void Mount::moveSteppersTo(float targetRASteps, float targetDECSteps, StepperAxi
 
         _stepperDEC->moveTo(targetDECSteps);
     }
+#if STEP_ENVELOPE == 1
+    updateStepEnvelope();
+#endif
+}
+
+#if STEP_ENVELOPE == 1
+/////////////////////////////////
+//
+// setStepEnvelope
+//
+/////////////////////////////////
+void Mount::setStepEnvelope(StepEnvelope &envelope, AccelStepper *stepper, long minSteps, long maxSteps, float acceleration, float speedCap)
+{
+    if ((speedCap > 0) && (stepper->maxSpeed() > speedCap))
+    {
+        stepper->setMaxSpeed(speedCap);
+    }
+
+    // Braking distance from the top speed, plus what the axis covers while the MOUNT task (which does the braking)
+    // may be late. Slower moves stop a little short of the edge.
+    const float maxSpeed      = stepper->maxSpeed();
+    const float brakeDistance = maxSpeed * maxSpeed / (2.0f * acceleration) + maxSpeed * STEP_ENVELOPE_BRAKE_LATENCY_S;
+    const long brakeSteps     = static_cast<long>(brakeDistance) + 1;
+    const long brakeBelow     = (minSteps == INT32_MIN) ? INT32_MIN : minSteps + brakeSteps;
+    const long brakeAbove     = (maxSteps == INT32_MAX) ? INT32_MAX : maxSteps - brakeSteps;
+
+    CriticalSection lock;
+    envelope.minSteps     = minSteps;
+    envelope.maxSteps     = maxSteps;
+    envelope.brakeBelow   = brakeBelow;
+    envelope.brakeAbove   = brakeAbove;
+    envelope.deceleration = acceleration;
+}
+
+/////////////////////////////////
+//
+// updateStepEnvelope
+//
+/////////////////////////////////
+// Called before every move of the slew steppers, so the envelope is in the coordinates of the slew steppers at that time.
+void Mount::updateStepEnvelope()
+{
+    // RA may turn RA_PHYSICAL_LIMIT hours either way of home. The RA stepper position does not include what tracking
+    // turned, so the range is shifted by the tracked hours, like the manual slew targets in startSlewing().
+    const float trackedHours = (_stepperTRK->currentPosition() / _trackingSpeed) / 3600.0F;
+    const int sign           = inNorthernHemisphere ? 1 : -1;
+    const long eastSteps     = -sign * static_cast<long>(_stepsPerRADegree * 15.0f * (RA_PHYSICAL_LIMIT + trackedHours));
+    const long westSteps     = sign * static_cast<long>(_stepsPerRADegree * 15.0f * (RA_PHYSICAL_LIMIT - trackedHours));
+    setStepEnvelope(
+        _raEnvelope, _stepperRA, min(eastSteps, westSteps), max(eastSteps, westSteps), _maxRAAcceleration, STEP_ENVELOPE_RA_MAX_SPEED);
+
+    // The DEC limits include what the GUIDE stepper moved, the DEC stepper position does not. A limit of 0 is no limit.
+    long guidePosition;
+    {
+        CriticalSection lock;
+        guidePosition = _stepperGUIDE->currentPosition();
+    }
+    const long guideSteps = guidePosition * DEC_SLEW_MICROSTEPPING / DEC_GUIDE_MICROSTEPPING;
+    const long decMin     = (_decLowerLimit != 0) ? _decLowerLimit - guideSteps : INT32_MIN;
+    const long decMax     = (_decUpperLimit != 0) ? _decUpperLimit - guideSteps : INT32_MAX;
+    setStepEnvelope(_decEnvelope, _stepperDEC, decMin, decMax, _maxDECAcceleration, STEP_ENVELOPE_DEC_MAX_SPEED);
+
+    LOG(DEBUG_STEPPERS,
+        "[STEPPERS]: updateStepEnvelope: RA %l -> %l, DEC %l -> %l",
+        _raEnvelope.minSteps,
+        _raEnvelope.maxSteps,
+        _decEnvelope.minSteps,
+        _decEnvelope.maxSteps);
 }
+#endif
 
 /////////////////////////////////
 //
@@ -3881,12 +5681,34 @@ DayTime Mount::getUtcTime()
 //
 /////////////////////////////////
 DayTime Mount::getLocalTime()
+{
+    return localTimeAt(localElapsedMillis());
+}
+
+/////////////////////////////////
+//
+// localTimeAt
+//
+/////////////////////////////////
+DayTime Mount::localTimeAt(unsigned long elapsedMillis) const
 {
     DayTime timeLocal = _localStartTime;
-    timeLocal.addSeconds((millis() - _localStartTimeSetMillis) / 1000);
+    timeLocal.addSeconds(elapsedMillis / 1000);
     return timeLocal;
 }
 
+/////////////////////////////////
+//
+// localElapsedMillis
+//
+/////////////////////////////////
+// Time since the clock was set, corrected for the drift of millis()
+unsigned long Mount::localElapsedMillis() const
+{
+    const unsigned long elapsed = millis() - _localStartTimeSetMillis;
+    return elapsed - static_cast<long>(elapsed * (_clockDriftPpm * 1.0e-6f));
+}
+
 /////////////////////////////////
 //
 // localDate
@@ -3895,34 +5717,14 @@ DayTime Mount::getLocalTime()
 LocalDate Mount::getLocalDate()
 {
     LocalDate localDate        = _localStartDate;
-    long secondsSinceSetDayEnd = ((millis() - _localStartTimeSetMillis) / 1000) - (86400 - _localStartTime.getTotalSeconds());
+    long secondsSinceSetDayEnd = (localElapsedMillis() / 1000) - (86400 - _localStartTime.getTotalSeconds());
 
     while (secondsSinceSetDayEnd >= 0)
     {
         localDate.day++;
         secondsSinceSetDayEnd -= 86400;
 
-        int maxDays = 31;
-        switch (localDate.month)
-        {
-            case 2:
-                if (((localDate.year % 4 == 0) && (localDate.year % 100 != 0)) || (localDate.year % 400 == 0))
-                {
-                    maxDays = 29;
-                }
-                else
-                {
-                    maxDays = 28;
-                }
-                break;
-
-            case 4:
-            case 6:
-            case 9:
-            case 11:
-                maxDays = 30;
-                break;
-        }
+        int maxDays = daysInMonth(localDate.year, localDate.month);
 
         //calculate day overflow
         if (localDate.day > maxDays)
@@ -3941,6 +5743,26 @@ LocalDate Mount::getLocalDate()
     return localDate;
 }
 
+/////////////////////////////////
+//
+// daysInMonth
+//
+/////////////////////////////////
+int Mount::daysInMonth(int year, int month)
+{
+    switch (month)
+    {
+        case 2:
+            return (((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0)) ? 29 : 28;
+        case 4:
+        case 6:
+        case 9:
+        case 11:
+            return 30;
+    }
+    return 31;
+}
+
 /////////////////////////////////
 //
 // localUtcOffset
@@ -3962,6 +5784,13 @@ void Mount::setLocalStartDate(int year, int month, int day)
     _localStartDate.month = month;
     _localStartDate.day   = day;
 
+    // A date set right after the time belongs to the same sync
+    if (_driftReferenceSet && (_driftReferenceMillis == static_cast<unsigned long>(_localStartTimeSetMillis)))
+    {
+        _driftReferenceSet = false;
+        estimateClockDrift(_localStartDate, _driftReferenceErrorMs);
+    }
+
     autoCalcHa();
 }
 
@@ -3972,12 +5801,141 @@ void Mount::setLocalStartDate(int year, int month, int day)
 /////////////////////////////////
 void Mount::setLocalStartTime(DayTime localTime)
 {
+    // The date of the new time is that of the clock, unless the two are on opposite sides of midnight (more than
+    // 12 hours apart). Then the new time is on the next or the previous day.
+    LocalDate localDate    = getLocalDate();
+    const long timeJumpSec = localTime.getTotalSeconds() - getLocalTime().getTotalSeconds();
+    if (timeJumpSec < -43200L)
+    {
+        localDate.day++;
+        if (localDate.day > daysInMonth(localDate.year, localDate.month))
+        {
+            localDate.day = 1;
+            localDate.month++;
+            if (localDate.month > 12)
+            {
+                localDate.month = 1;
+                localDate.year++;
+            }
+        }
+    }
+    else if (timeJumpSec > 43200L)
+    {
+        localDate.day--;
+        if (localDate.day < 1)
+        {
+            localDate.month--;
+            if (localDate.month < 1)
+            {
+                localDate.month = 12;
+                localDate.year--;
+            }
+            localDate.day = daysInMonth(localDate.year, localDate.month);
+        }
+    }
+
     _localStartTime          = localTime;
     _localStartTimeSetMillis = millis();
+    estimateClockDrift(localDate, 1000);  // Set to whole seconds
 
     autoCalcHa();
 }
 
+/////////////////////////////////
+//
+// syncLocalClock
+//
+/////////////////////////////////
+void Mount::syncLocalClock(const DayTime &localTime, const LocalDate &localDate, unsigned long secondStartMillis, unsigned int syncErrorMs)
+{
+    _localStartTime          = localTime;
+    _localStartDate          = localDate;
+    _localStartTimeSetMillis = static_cast<long>(secondStartMillis);
+    estimateClockDrift(localDate, syncErrorMs);
+}
+
+/////////////////////////////////
+//
+// estimateClockDrift
+//
+/////////////////////////////////
+// Compares the millis() that passed since the drift reference sync with the time that really passed according to the
+// sync that just set the clock. The error is that of both syncs over the time between them, so the reference is kept
+// as long as the syncs agree and every later sync gives a better estimate.
+void Mount::estimateClockDrift(const LocalDate &localDate, unsigned int syncErrorMs)
+{
+    const long syncDays        = Sidereal::calculateDeltaJd(localDate.year, localDate.month, localDate.day);
+    const long syncSeconds     = syncDays * 86400L + _localStartTime.getTotalSeconds();
+    const long baselineSeconds = syncSeconds - _driftReferenceSeconds;
+    if (_driftReferenceSet && (baselineSeconds > 0) && (baselineSeconds <= CLOCK_DRIFT_MAX_BASELINE_S))
+    {
+        const unsigned long clockMillis = static_cast<unsigned long>(_localStartTimeSetMillis) - _driftReferenceMillis;
+        const long offsetMillis         = static_cast<long>(clockMillis) - 1000L * baselineSeconds;
+        const float driftPpm            = 1000.0f * offsetMillis / baselineSeconds;
+        if (fabsf(driftPpm) <= CLOCK_DRIFT_MAX_PPM)
+        {
+            updateClockDrift(driftPpm, 1000.0f * (syncErrorMs + _driftReferenceErrorMs) / baselineSeconds);
+            if (syncErrorMs >= _driftReferenceErrorMs)
+            {
+                return;
+            }
+        }
+        else
+        {
+            LOG(DEBUG_MOUNT, "[MOUNT]: Clock set %l ms off in %l s, restarting drift estimate", offsetMillis, baselineSeconds);
+        }
+    }
+
+    // Start a new reference, or move it to a more accurate sync. What the old one gave is already in the estimate.
+    _driftReferenceSet     = true;
+    _driftReferenceSeconds = syncSeconds;
+    _driftReferenceMillis  = static_cast<unsigned long>(_localStartTimeSetMillis);
+    _driftReferenceErrorMs = syncErrorMs;
+}
+
+/////////////////////////////////
+//
+// updateClockDrift
+//
+/////////////////////////////////
+void Mount::updateClockDrift(float driftPpm, float errorPpm)
+{
+    if ((errorPpm > _clockDriftErrorPpm) || (errorPpm > CLOCK_DRIFT_MAX_ERROR_PPM))
+    {
+        return;
+    }
+    _clockDriftPpm      = driftPpm;
+    _clockDriftErrorPpm = errorPpm;
+
+    // Stored only when the error halved, so syncing every second does not wear out the EEPROM
+    if (errorPpm <= _storedClockDriftErrorPpm / 2)
+    {
+        LOG(DEBUG_MOUNT, "[MOUNT]: Storing clock drift of %f ppm (+/- %f)", driftPpm, errorPpm);
+        EEPROMStore::storeClockDrift(driftPpm, errorPpm);
+        _storedClockDriftErrorPpm = errorPpm;
+    }
+}
+
+/////////////////////////////////
+//
+// getClockDriftPpm
+//
+/////////////////////////////////
+float Mount::getClockDriftPpm() const
+{
+    return _clockDriftPpm;
+}
+
+/////////////////////////////////
+//
+// getClockDriftErrorPpm
+//
+/////////////////////////////////
+float Mount::getClockDriftErrorPpm() const
+{
+    return _clockDriftErrorPpm;
+}
+
 /////////////////////////////////
 //
 // setLocalUtcOffset
@@ -4008,9 +5966,15 @@ void Mount::autoCalcHa()
 /////////////////////////////////
 DayTime Mount::calculateLst()
 {
-    DayTime timeUTC     = getUtcTime();
-    LocalDate localDate = getLocalDate();
-    DayTime lst = Sidereal::calculateByDateAndTime(longitude().getTotalHours(), localDate.year, localDate.month, localDate.day, &timeUTC);
+    // The clock runs in milliseconds, so add the part of the second the UTC DayTime cannot hold. Since the syncs start
+    // the clock on a second, this takes the LST to the nearest second instead of up to a second late.
+    const unsigned long elapsed = localElapsedMillis();
+    DayTime timeUTC             = localTimeAt(elapsed);
+    LocalDate localDate         = getLocalDate();
+    timeUTC.addHours(-_localUtcOffset);
+    const float utcHours = timeUTC.getTotalHours() + (elapsed % 1000UL) / 3600000.0f;
+    DayTime lst          = Sidereal::calculateByDateAndTime(
+        longitude().getTotalHours(), localDate.year, localDate.month, localDate.day, utcHours);
     LOG(DEBUG_INFO,
         "[MOUNT]: Calculating LST. UTC time: %s. Date: %d-%d-%d. Longitude: %s",
         timeUTC.ToString(),
@@ -4101,10 +6065,42 @@ void Mount::testUART_vactual(TMC2209Stepper *driver, int _speed, int _duration)
 //
 /////////////////////////////////
 float Mount::checkRALimit()
+{
+    const float RALimit            = RA_TRACKING_LIMIT;
+    const float homeCurrentDeltaRA = getRaRingHours();
+    LOG(DEBUG_MOUNT_VERBOSE, "[MOUNT]: checkRALimit: deltaRA: %f => Check against %f", homeCurrentDeltaRA, RALimit);
+
+    // Only one automatic flip per GoTo, so a flip that does not gain tracking time cannot repeat
+    const bool canFlip = _autoMeridianFlip && isSlewingTRK() && (_meridianFlipState == FLIP_NONE);
+    if (homeCurrentDeltaRA > RALimit)
+    {
+        // Also while a flip is pending, the pause before it must not track past the limit
+        LOG(DEBUG_MOUNT, "[MOUNT]: checkRALimit: Tracking limit reached. deltaRA: %f > RALimit:%f.", homeCurrentDeltaRA, RALimit);
+        stopSlewing(TRACKING);
+    }
+    else if (canFlip && ((RALimit - homeCurrentDeltaRA) * 60.0f < _meridianFlipLeadMinutes))
+    {
+        LOG(DEBUG_MOUNT,
+            "[MOUNT]: checkRALimit: Tracking limit ahead. deltaRA: %f, RALimit:%f. Meridian flip pending.",
+            homeCurrentDeltaRA,
+            RALimit);
+        _meridianFlipState        = FLIP_PENDING;
+        _meridianFlipPendingSince = millis();
+    }
+    _lastTRKCheck = millis();
+
+    return RALimit - homeCurrentDeltaRA;
+}
+
+/////////////////////////////////
+//
+// getRaRingHours
+//
+/////////////////////////////////
+float Mount::getRaRingHours() const
 {
     const float trackedHours = (_stepperTRK->currentPosition() / _trackingSpeed) / 3600.0F;  // steps / steps/s / 3600 = hours
     const float homeRA       = _zeroPosRA.getTotalHours() + trackedHours;
-    const float RALimit      = RA_TRACKING_LIMIT;
     LOG(DEBUG_MOUNT_VERBOSE,
         "[MOUNT]: checkRALimit: homeRA: %f (ZeroPos: %f + TrkHrs: %f)",
         homeRA,
@@ -4127,19 +6123,197 @@ float Mount::checkRALimit()
         homeCurrentDeltaRA -= 24;
     while (homeCurrentDeltaRA < -12)
         homeCurrentDeltaRA += 24;
-    LOG(DEBUG_MOUNT_VERBOSE, "[MOUNT]: checkRALimit: deltaRA: %f => Check against %f", homeCurrentDeltaRA, RALimit);
 
-    if (homeCurrentDeltaRA > RALimit)
+    return homeCurrentDeltaRA;
+}
+
+/////////////////////////////////
+//
+// forecastLimits
+//
+/////////////////////////////////
+// Works out how long tracking takes from the given RA ring position and DEC position (in slew steps) to each limit.
+LimitForecast Mount::forecastLimits(float ringHours, long decSteps) const
+{
+    LimitForecast forecast;
+    forecast.reachable = true;
+    // The ring turns at the selected tracking rate, whatever the pointing does
+    const float ringHoursPerHour  = _trackingRateFactor;
+    forecast.trackingLimitMinutes = (ringHoursPerHour > 0) ? max(RA_TRACKING_LIMIT - ringHours, 0.0f) * 60.0f / ringHoursPerHour : -1.0f;
+    forecast.physicalLimitMinutes = (ringHoursPerHour > 0) ? max(RA_PHYSICAL_LIMIT - ringHours, 0.0f) * 60.0f / ringHoursPerHour : -1.0f;
+
+    // Same direction logic as updateDecTrackingSpeed(), in slew steps per minute
+    forecast.decLimitMinutes = -1.0f;
+    if (_decTrackingRate != 0)
     {
-        LOG(DEBUG_MOUNT,
-            "[MOUNT]: checkRALimit: Tracking limit reached. deltaRA: %f > RALimit:%f.  TrackedHrs:%f, HomeRA:%f, ",
-            homeCurrentDeltaRA,
-            RALimit,
-            trackedHours,
-            homeRA);
-        stopSlewing(TRACKING);
+        const float degreePos   = (decSteps / _stepsPerDECDegree) + _zeroPosDEC;
+        const float northSign   = ((degreePos >= 0) == inNorthernHemisphere) ? -1.0f : 1.0f;
+        const float stepsPerMin = northSign * _decTrackingRate * _stepsPerDECDegree / 60.0f;
+        if ((stepsPerMin > 0) && (_decUpperLimit != 0))
+        {
+            forecast.decLimitMinutes = max(_decUpperLimit - decSteps, 0L) / stepsPerMin;
+        }
+        else if ((stepsPerMin < 0) && (_decLowerLimit != 0))
+        {
+            forecast.decLimitMinutes = min(_decLowerLimit - decSteps, 0L) / stepsPerMin;
+        }
     }
-    _lastTRKCheck = millis();
+    return forecast;
+}
 
-    return RALimit - homeCurrentDeltaRA;
+/////////////////////////////////
+//
+// getLimitForecast
+//
+/////////////////////////////////
+LimitForecast Mount::getLimitForecast() const
+{
+    long guidePosition;
+    {
+        CriticalSection lock;
+        guidePosition = _stepperGUIDE->currentPosition();
+    }
+    const long decSteps = _stepperDEC->currentPosition() + guidePosition * DEC_SLEW_MICROSTEPPING / DEC_GUIDE_MICROSTEPPING;
+    return forecastLimits(getRaRingHours(), decSteps);
+}
+
+LimitForecast Mount::getLimitForecast(const DayTime &ra, const Declination &dec, PierSide side)
+{
+    DayTime savedRA      = _targetRA;
+    Declination savedDec = _targetDEC;
+    _targetRA            = ra;
+    _targetDEC           = dec;
+    _forcedPierSide      = side;
+    long raSteps, decSteps;
+    PierSide pickedSide;
+    calculateRAandDECSteppers(raSteps, decSteps, nullptr, &pickedSide);
+    _forcedPierSide = PIER_SIDE_AUTO;
+    _targetRA       = savedRA;
+    _targetDEC      = savedDec;
+
+    // The forced side falls back to the automatic one when it is out of the RA limits
+    if (pickedSide != side)
+    {
+        LimitForecast forecast;
+        forecast.trackingLimitMinutes = -1.0f;
+        forecast.physicalLimitMinutes = -1.0f;
+        forecast.decLimitMinutes      = -1.0f;
+        forecast.reachable            = false;
+        return forecast;
+    }
+
+    // Same as getRaRingHours() once the mount got there
+    const float trackedHours = (_stepperTRK->currentPosition() / _trackingSpeed) / 3600.0F;
+    float ringHours          = _zeroPosRA.getTotalHours() + trackedHours - ra.getTotalHours();
+    if (side == PIER_SIDE_FLIPPED)
+    {
+        ringHours += 12.0f;
+    }
+    while (ringHours > 12)
+        ringHours -= 24;
+    while (ringHours < -12)
+        ringHours += 24;
+    return forecastLimits(ringHours, decSteps);
+}
+
+/////////////////////////////////
+//
+// getGoToPierSide
+//
+/////////////////////////////////
+PierSide Mount::getGoToPierSide(const DayTime &ra, const Declination &dec)
+{
+    DayTime savedRA      = _targetRA;
+    Declination savedDec = _targetDEC;
+    _targetRA            = ra;
+    _targetDEC           = dec;
+    long raSteps, decSteps;
+    PierSide side;
+    calculateRAandDECSteppers(raSteps, decSteps, nullptr, &side);
+    _targetRA  = savedRA;
+    _targetDEC = savedDec;
+    return side;
+}
+
+/////////////////////////////////
+//
+// setAutoMeridianFlip
+//
+/////////////////////////////////
+void Mount::setAutoMeridianFlip(bool enabled)
+{
+    _autoMeridianFlip = enabled;
+    if (!enabled && (_meridianFlipState == FLIP_PENDING))
+    {
+        _meridianFlipState = FLIP_NONE;
+    }
+}
+
+/////////////////////////////////
+//
+// setMeridianFlipLeadMinutes
+//
+/////////////////////////////////
+void Mount::setMeridianFlipLeadMinutes(int minutes)
+{
+    // With no lead the flip would only become pending at the limit, where tracking stops
+    _meridianFlipLeadMinutes = constrain(minutes, 1, 120);
+}
+
+/////////////////////////////////
+//
+// getMeridianFlipStatus
+//
+/////////////////////////////////
+String Mount::getMeridianFlipStatus() const
+{
+    const char *states[] = {"", "FlipPending", "Flipping", "Flipped"};
+    return String(_autoMeridianFlip ? 1 : 0) + ',' + String(_meridianFlipLeadMinutes) + ',' + String(states[_meridianFlipState]);
+}
+
+/////////////////////////////////
+//
+// startMeridianFlip
+//
+/////////////////////////////////
+void Mount::startMeridianFlip()
+{
+    // Same test as checkRALimit() for which side of the pier the mount is on
+    const float degreePos = (_stepperDEC->currentPosition() / _stepsPerDECDegree) + _zeroPosDEC;
+    const bool flipped    = inNorthernHemisphere ? degreePos < 0 : degreePos > 0;
+    LOG(DEBUG_MOUNT, "[MOUNT]: Meridian flip from the %s side", flipped ? "flipped" : "normal");
+
+    stopGuiding();
+    _targetRA       = currentRA();
+    _targetDEC      = currentDEC();
+    _forcedPierSide = flipped ? PIER_SIDE_NORMAL : PIER_SIDE_FLIPPED;
+    startSlewingToTarget();
+    _forcedPierSide    = PIER_SIDE_AUTO;
+    _meridianFlipState = FLIP_SLEWING;
+}
+
+/////////////////////////////////
+//
+// processMeridianFlip
+//
+/////////////////////////////////
+// Gives the host AUTO_MERIDIAN_FLIP_PAUSE_SECONDS to pause guiding (it sees 'FlipPending' in :GX#), then flips.
+void Mount::processMeridianFlip()
+{
+    if (_meridianFlipState == FLIP_PENDING)
+    {
+        if (!isSlewingTRK())
+        {
+            _meridianFlipState = FLIP_NONE;
+        }
+        else if (millis() - _meridianFlipPendingSince >= 1000UL * AUTO_MERIDIAN_FLIP_PAUSE_SECONDS)
+        {
+            startMeridianFlip();
+        }
+    }
+    else if ((_meridianFlipState == FLIP_SLEWING) && !isSlewingRAorDEC())
+    {
+        LOG(DEBUG_MOUNT, "[MOUNT]: Meridian flip done, tracking %s", isSlewingTRK() ? "resumed" : "off");
+        _meridianFlipState = FLIP_DONE;
+    }
 }
@@ -5,6 +5,10 @@
 #include "Latitude.hpp"
 #include "Longitude.hpp"
 #include "Types.hpp"
+#include "GuideRateLearner.hpp"
+#if EPHEMERIS_TRACKING == 1
+    #include "libs/EphemerisTrack/EphemerisTrack.hpp"
+#endif
 
 #if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
 class InfoDisplayRender;
@@ -86,6 +90,7 @@ using StepperFocusSlew = AccelStepper;
 class LcdMenu;
 class TMC2209Stepper;
 class HallSensorHoming;
+class StallGuardHoming;
 class EndSwitch;
 
 #define NORTH          B00000001
@@ -142,6 +147,69 @@ enum FocuserDirection
     FOCUS_FORWARD  = 1
 };
 
+// Tracking rates
+enum TrackingRate
+{
+    TRACKING_SIDEREAL,
+    TRACKING_LUNAR,
+    TRACKING_SOLAR,
+    TRACKING_KING,
+    TRACKING_CUSTOM,
+};
+
+// Side of the pier a GoTo ends up on
+enum PierSide
+{
+    PIER_SIDE_AUTO,     // Picked by the RA limits
+    PIER_SIDE_NORMAL,   // Solution 1
+    PIER_SIDE_FLIPPED,  // Solution 2 or 3, both axes turned around
+};
+
+// Tracking time left before each limit, in minutes. Negative if the limit is never reached.
+struct LimitForecast {
+    float trackingLimitMinutes;  // RA_TRACKING_LIMIT
+    float physicalLimitMinutes;  // RA_PHYSICAL_LIMIT
+    float decLimitMinutes;       // DEC limits, only reached with a DEC tracking rate
+    bool reachable;              // False if a GoTo would not end up on the forecast side of the pier
+};
+
+// States of the automatic meridian flip
+enum MeridianFlipState
+{
+    FLIP_NONE,
+    FLIP_PENDING,  // Waiting for the host to pause guiding
+    FLIP_SLEWING,
+    FLIP_DONE,
+};
+
+// States of an on-mount dither
+enum DitherState
+{
+    DITHER_NONE,
+    DITHER_MOVING,
+    DITHER_SETTLING,
+    DITHER_SETTLED,
+};
+
+#if TARGET_QUEUE == 1
+// States of the target queue
+enum TargetQueueState
+{
+    QUEUE_IDLE,
+    QUEUE_SLEWING,
+    QUEUE_DWELLING,
+};
+
+// A target of the queue, in celestial coordinates
+struct QueuedTarget {
+    long ra;               // Seconds of time, or offset from the previous target
+    long dec;              // Arcseconds, or offset from the previous target
+    uint16_t dwellSecs;    // Time to stay on the target after arriving
+    uint8_t ditherArcsec;  // Random offset on both axes, 0 for none
+    bool relative;
+};
+#endif
+
 //////////////////////////////////////////////////////////////////
 //
 // Class that represent the OpenAstroTracker mount, with all its parameters, motors, etc.
@@ -240,6 +308,13 @@ class Mount
     // Set the current RA tracking speed factor
     void setSpeedCalibration(float val, bool saveToStorage);
 
+    // Select the tracking rate. The custom rates are in arcsec/sec, RA as rotation of the RA axis (sidereal is
+    // about 15.041) and DEC towards the north. The other modes do not move DEC.
+    void setTrackingRate(TrackingRate rate, float raArcsecPerSec = 0, float decArcsecPerSec = 0);
+    TrackingRate getTrackingRate() const;
+    float getRaTrackingRate() const;
+    float getDecTrackingRate() const;
+
 #if USE_GYRO_LEVEL == 1
     // Get the current pitch angle calibraton
     float getPitchCalibrationAngle();
@@ -346,9 +421,13 @@ class Mount
     // Set the tracking stepper position
     void setTrackingStepperPos(long stepPos);
 
-    // Process any stepper movement.
+    // Runs the mount tasks (guide pulses and stepper movement) of the scheduler.
     void loop();
 
+    // Scheduler tasks, see Scheduler.hpp
+    void processGuidePulses();
+    void processMotion();
+
 // Low-level process any stepper movement on interrupt callback.
 #if defined(ESP32) || !defined(NEW_STEPPER_LIB)
     void interruptLoop();
@@ -377,6 +456,79 @@ class Mount
     // Stops given guide operations in progress.
     void stopGuiding(bool ra = true, bool dec = true);
 
+    // Returns "raSteps,raBudget,decSteps,decBudget" for the last completed RA and DEC guide pulses.
+    String getLastGuidePulseSteps() const;
+
+    // Returns "RA,pulses,steps,westMs,eastMs,netArcsec,rmsArcsec|DEC,pulses,steps,northMs,southMs,netArcsec,rmsArcsec"
+    // for all guide pulses since boot or the last reset.
+    String getGuideStatistics() const;
+    void resetGuideStatistics();
+
+    // Moves the pointing by a random offset of up to radiusArcsec with guide pulses on both axes and then waits
+    // for the mount to settle. Returns false if not tracking or busy slewing or guiding.
+    bool dither(float radiusArcsec);
+
+    // Automatic meridian flip when tracking gets within leadMinutes of RA_TRACKING_LIMIT, instead of stopping tracking.
+    void setAutoMeridianFlip(bool enabled);
+    void setMeridianFlipLeadMinutes(int minutes);
+    // Returns "enabled,leadMinutes,state".
+    String getMeridianFlipStatus() const;
+
+    // Forecast of the tracking time left at the current position.
+    LimitForecast getLimitForecast() const;
+    // Forecast of the tracking time left after a GoTo to the given position on the given side of the pier.
+    // Not reachable if the GoTo would not use that side (out of the RA limits).
+    LimitForecast getLimitForecast(const DayTime &ra, const Declination &dec, PierSide side);
+    // Returns the side of the pier a GoTo to the given position would pick.
+    PierSide getGoToPierSide(const DayTime &ra, const Declination &dec);
+
+#if GUIDE_RATE_LEARNING != 0
+    // Returns "valid,bins,spanMinutes,arcsecPerHour,stdErrArcsecPerHour,proposedFactor,rejectedPulses" for the
+    // tracking rate error learned from the RA guide pulses since tracking started or the last slew.
+    String getGuideRateLearning() const;
+    void resetGuideRateLearning();
+
+    // Applies and stores the learned speed calibration. Returns false if there is no valid fit.
+    bool applyLearnedSpeedCalibration();
+#endif
+
+#if PEC_ENABLED == 1
+    // Returns "playback,recording,segment,recordedPercent,peakToPeakArcsec" of the periodic error correction.
+    String getPecStatus() const;
+    // Returns the correction of each PEC segment in 1/16 arcsec, separated by commas.
+    String getPecTable() const;
+    void setPecPlayback(bool enabled);
+    // Starts recording the RA guide corrections into the PEC table. Returns false if not tracking.
+    bool startPecRecording();
+    void stopPecRecording();
+    void clearPecTable();
+#endif
+
+#if EPHEMERIS_TRACKING == 1
+    // Discards the ephemeris points and restarts the track time at 0.
+    void clearEphemeris();
+    // Adds a point of the track. Time in ms of track time, RA and DEC in 1/100 arcsec. Returns false if full or out of order.
+    bool addEphemerisPoint(uint32_t timeMs, int32_t ra, int32_t dec);
+    // Starts tracking along the ephemeris from the current track time. Returns false if the track does not cover it.
+    bool startEphemerisTracking();
+    void stopEphemerisTracking();
+    // Returns "following,trackTimeMs,points,space,endTimeMs,raResidual,decResidual" with residuals in 1/100 arcsec.
+    String getEphemerisStatus() const;
+#endif
+
+#if TARGET_QUEUE == 1
+    // Empties the target queue, aborting it if it is running.
+    void clearTargetQueue();
+    // Appends a target. RA in seconds of time and DEC in arcseconds, or offsets from the previous target if relative.
+    // Returns false if the queue is full or running.
+    bool addQueuedTarget(long ra, long dec, uint16_t dwellSecs, uint8_t ditherArcsec, bool relative);
+    // Slews to the queued targets one after the other. Returns false if the queue is empty.
+    bool startTargetQueue();
+    void abortTargetQueue();
+    // Returns "state,index,count,completed,dwellSecsLeft".
+    String getTargetQueueStatus() const;
+#endif
+
     // Return a string of DEC in the given format. For LCDSTRING, active determines where the cursor is
     String DECString(byte type, byte active = 0);
 
@@ -404,7 +556,6 @@ class Mount
     void setupInfoDisplay();
     void updateInfoDisplay();
     InfoDisplayRender *getInfoDisplay();
-    long _loops;
 #endif
 
     // Called by Meade processor every time a command is received.
@@ -450,12 +601,28 @@ class Mount
 
 #if (USE_HALL_SENSOR_RA_AUTOHOME == 1) || (USE_HALL_SENSOR_DEC_AUTOHOME == 1)
     bool findHomeByHallSensor(StepperAxis axis, int initialDirection, int searchDistance);
+#endif
+#if (USE_STALLGUARD_RA_AUTOHOME == 1) || (USE_STALLGUARD_DEC_AUTOHOME == 1)
+    // Homes the axis against its hard stop using the TMC2209 stall detection
+    bool findHomeByStallGuard(StepperAxis axis);
+    // Switches the axis driver to StealthChop (which StallGuard needs) or back to the configured mode
+    void enableStallGuard(StepperAxis axis, bool enable);
+    // Whether the axis driver's SG_RESULT is at or below the stall threshold
+    bool isAxisStalled(StepperAxis axis);
+    // Whether the last StallGuard homing of the axis succeeded
+    bool hasStallGuardHomed(StepperAxis axis) const;
+#endif
+#if (USE_HALL_SENSOR_RA_AUTOHOME == 1) || (USE_HALL_SENSOR_DEC_AUTOHOME == 1) || (USE_STALLGUARD_RA_AUTOHOME == 1)                         \
+    || (USE_STALLGUARD_DEC_AUTOHOME == 1)
     void processHomingProgress();
 #endif
     String getAutoHomingStates() const;
 
     void setHomingOffset(StepperAxis axis, long offset);
     long getHomingOffset(StepperAxis axis);
+    // Steps from the hard stop to home for StallGuard homing, stored apart from the Hall sensor offset
+    void setStallHomingOffset(StepperAxis axis, long offset);
+    long getStallHomingOffset(StepperAxis axis);
 
     // Move the given stepper motor by the given amount of steps.
     void moveStepperBy(StepperAxis which, long steps);
@@ -497,6 +664,18 @@ class Mount
     void setLocalStartTime(DayTime localTime);
     void setLocalUtcOffset(int offset);
 
+    // Sets the clock to localTime and localDate at secondStartMillis, the millis() at which that second began, give or
+    // take syncErrorMs. Unlike setLocalStartTime() this leaves the HA alone, so a time source can keep the clock in step
+    // while the mount runs.
+    void syncLocalClock(const DayTime &localTime, const LocalDate &localDate, unsigned long secondStartMillis, unsigned int syncErrorMs);
+
+    // How fast millis() runs against true time, in ppm (positive is fast). It is estimated from successive clock syncs,
+    // taken out of the time elapsed since the last sync and stored in EEPROM, so it carries over to the next session.
+    // A new estimate is only used if its error is no larger than that of the current one.
+    void updateClockDrift(float driftPpm, float errorPpm);
+    float getClockDriftPpm() const;
+    float getClockDriftErrorPpm() const;
+
     DayTime calculateLst();
     DayTime calculateHa();
 
@@ -506,9 +685,19 @@ class Mount
 
     // Returns the remaining tracking time available and stops tracking if it reaches zero.
     float checkRALimit();
+    // Hours the RA ring has turned from home towards the tracking limit, from currentRA() and the tracked time.
+    float getRaRingHours() const;
+    LimitForecast forecastLimits(float ringHours, long decSteps) const;
 
     // Calculate the stepper positions for the current target coordinates
-    void calculateRAandDECSteppers(long &targetRASteps, long &targetDECSteps, long pSolutions[6] = nullptr) const;
+    void calculateRAandDECSteppers(long &targetRASteps,
+                                   long &targetDECSteps,
+                                   long pSolutions[6] = nullptr,
+                                   PierSide *pPierSide = nullptr) const;
+
+    // Slews to the other side of the pier for the current position, tracking continues on arrival.
+    void startMeridianFlip();
+    void processMeridianFlip();
 
 #if UART_CONNECTION_TEST_TX == 1
     #if RA_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART
@@ -519,6 +708,61 @@ class Mount
     #endif
 #endif
   private:
+    struct GuideAxisStatistics {
+        unsigned long pulses;
+        unsigned long steps;          // Steps delivered at guide speed
+        unsigned long durationMs[2];  // Total pulse time WEST/NORTH and EAST/SOUTH
+        float netArcsec;              // Net displacement, positive is WEST/NORTH
+        float sumSquaresArcsec;       // Sum of the squared displacement of each pulse
+    };
+#if STEP_ENVELOPE == 1
+    // Step range an axis may move in, checked by interruptLoop() on every pass
+    struct StepEnvelope {
+        long minSteps;
+        long maxSteps;
+        long brakeBelow;  // Moving down below this needs braking to stop by minSteps
+        long brakeAbove;  // Moving up above this needs braking to stop by maxSteps
+        float deceleration;
+        volatile bool approaching;  // Set by interruptLoop() while the axis moves outwards inside the braking distance
+        bool braking;               // stop() was called for this approach to the edge
+    };
+#endif
+
+    void startRaGuidePulse(float speed, int duration);
+    void startDecGuidePulse(float speed, int duration);
+    void recordGuidePulse(GuideAxisStatistics &stats, bool positive, unsigned long durationMs, long steps, float netArcsec);
+    void processDither();
+#if GUIDE_RATE_LEARNING != 0
+    bool getLearnedSpeedCalibration(const GuideRateLearner::Fit &fit, float &speedCalibration) const;
+    void learnTrackingRate();
+#endif
+    // TRK speed for the current position, including periodic error correction.
+    float currentTrackingSpeed() const;
+    void addRaDisplacement(float netSteps);
+    void updateDecTrackingSpeed();
+    void foldTrackingRateMotion();
+#if PEC_ENABLED == 1
+    void synchronizePec();
+    void updatePecTrackingSpeed();
+    void buildPecRates();
+    void recordPecCorrection(float netArcsec);
+    void finishPecRecording();
+    void pecStep(bool forward);
+#endif
+#if EPHEMERIS_TRACKING == 1
+    void followEphemeris();
+#endif
+#if TARGET_QUEUE == 1
+    void processTargetQueue();
+    void slewToQueuedTarget();
+#endif
+#if STEP_ENVELOPE == 1
+    void updateStepEnvelope();
+    void setStepEnvelope(StepEnvelope &envelope, AccelStepper *stepper, long minSteps, long maxSteps, float acceleration, float speedCap);
+    bool withinStepEnvelope(AccelStepper *stepper, StepEnvelope &envelope);
+    void brakeForStepEnvelope(AccelStepper *stepper, StepEnvelope &envelope, bool constantSpeed);
+#endif
+
 #if UART_CONNECTION_TEST_TX == 1
     #if RA_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART || DEC_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART
     void testUART_vactual(TMC2209Stepper *driver, int speed, int duration);
@@ -588,6 +832,7 @@ class Mount
     AccelStepper *_stepperDEC;
     AccelStepper *_stepperTRK;
     AccelStepper *_stepperGUIDE;
+    AccelStepper *_stepperRAGUIDE;  // Runs the RA motor during RA guide pulses, so TRK keeps the tracking speed
 #endif
 #if RA_DRIVER_TYPE == DRIVER_TYPE_TMC2209_UART
     TMC2209Stepper *_driverRA;
@@ -645,6 +890,12 @@ class Mount
 #if USE_HALL_SENSOR_DEC_AUTOHOME == 1
     HallSensorHoming *_decHoming;
 #endif
+#if USE_STALLGUARD_RA_AUTOHOME == 1
+    StallGuardHoming *_raStallHoming;
+#endif
+#if USE_STALLGUARD_DEC_AUTOHOME == 1
+    StallGuardHoming *_decStallHoming;
+#endif
 
 #if USE_RA_END_SWITCH == 1
     EndSwitch *_raEndSwitch;
@@ -653,11 +904,79 @@ class Mount
     EndSwitch *_decEndSwitch;
 #endif
 
-    unsigned long _guideRaEndTime;
-    unsigned long _guideDecEndTime;
+    // Guide pulses end when their step budget (duration x guide speed) is used up. The duration is only
+    // used when no budget can be enforced (zero RA guide speed or NEW_STEPPER_LIB).
+    unsigned long _guideRaStartTime;
+    unsigned long _guideDecStartTime;
+    unsigned long _guideRaDuration;
+    unsigned long _guideDecDuration;
+    long _guideRaBudget;
+    long _guideDecBudget;
+    volatile long _guideRaStepsLeft;   // Counted down by interruptLoop() for every RA step of the pulse
+    volatile bool _guideRaBudgetUsed;  // Set by interruptLoop(), TRK takes over from the RA guide stepper again
+    long _guideRaStartPosition;
+    long _guideDecStartPosition;
+    long _lastGuideRaSteps;
+    long _lastGuideDecSteps;
+    float _guideRaSpeed;
+    float _guideDecSpeed;
+    float _guideRaRemainderSeconds;  // Guide and tracking rate displacement not yet folded into _zeroPosRA
+    DitherState _ditherState;
+    unsigned long _ditherSettleMs;     // Settle time of the current dither
+    unsigned long _ditherSettleStart;  // When the dither pulses ended
+    bool _autoMeridianFlip;
+    int _meridianFlipLeadMinutes;
+    MeridianFlipState _meridianFlipState;
+    unsigned long _meridianFlipPendingSince;
+    PierSide _forcedPierSide;  // Only set by startMeridianFlip() while it starts the slew
+    GuideAxisStatistics _guideStatsRA;
+    GuideAxisStatistics _guideStatsDEC;
+#if STEP_ENVELOPE == 1
+    StepEnvelope _raEnvelope;
+    StepEnvelope _decEnvelope;
+#endif
+#if GUIDE_RATE_LEARNING != 0
+    GuideRateLearner _guideRateLearner;
+#endif
+#if PEC_ENABLED == 1
+    int8_t _pecTable[PEC_SEGMENTS];        // Extra RA correction per segment in 1/16 arcsec
+    float _pecRates[PEC_SEGMENTS];         // TRK speed for each segment, built from _pecTable
+    int16_t _pecRecordSums[PEC_SEGMENTS];  // Recorded RA guide corrections per segment in 1/16 arcsec
+    float _pecSegmentArcsec;               // Guide corrections in the segment being recorded
+    uint16_t _pecRecordedSegments;
+    uint8_t _pecRecordSegment;
+    bool _pecRecording;
+    volatile bool _pecPlayback;
+    volatile uint8_t _pecSegment;      // Segment of the RA motor phase, counted by interruptLoop()
+    volatile long _pecStepsLeft;       // TRK steps until the next segment
+    volatile bool _pecSegmentChanged;  // Set by interruptLoop(), processMotion() switches to the rate of the new segment
+#endif
+#if EPHEMERIS_TRACKING == 1
+    EphemerisTrack<EPHEMERIS_POINTS> _ephemeris;
+    unsigned long _ephemerisStartMs;   // millis() at track time 0
+    unsigned long _ephemerisUpdateMs;  // millis() of the last rate update
+    bool _ephemerisFollowing;
+#endif
+#if TARGET_QUEUE == 1
+    QueuedTarget _targetQueue[TARGET_QUEUE_SIZE];
+    uint8_t _targetQueueCount;
+    uint8_t _targetQueueIndex;      // Target being slewed to or dwelled on
+    uint8_t _targetQueueCompleted;  // Targets whose dwell is over, since the queue was started
+    TargetQueueState _targetQueueState;
+    long _targetQueueRA;   // Undithered RA of the current target in seconds of time
+    long _targetQueueDEC;  // Undithered DEC of the current target in arcseconds
+    unsigned long _targetQueueDwellStart;
+#endif
     unsigned long _lastMountPrint = 0;
     float _trackingSpeed;             // RA u-steps/sec when in tracking mode
     float _trackingSpeedCalibration;  // Dimensionless, very close to 1.0
+    TrackingRate _trackingRate;
+    float _trackingRateFactor;            // Selected RA rate relative to sidereal
+    float _trackingRateSpeed;             // TRK u-steps/sec at the selected rate
+    float _decTrackingRate;               // arcsec/sec towards the north
+    float _decTrackingSpeed;              // GUIDE u-steps/sec for the DEC rate at the current position
+    long _decTrackingFoldedPosition;      // GUIDE position already folded into _zeroPosDEC
+    unsigned long _trackingRateFoldTime;  // Last time the tracking rate motion was folded into the zero positions
     unsigned long _lastDisplayUpdate;
     unsigned long _trackerStoppedAt;
     bool _compensateForTrackerOff;
@@ -674,6 +993,18 @@ class Mount
     LocalDate _localStartDate;
     DayTime _localStartTime;
     long _localStartTimeSetMillis;
+    float _clockDriftPpm;
+    float _clockDriftErrorPpm;
+    float _storedClockDriftErrorPpm;
+    bool _driftReferenceSet;              // The drift is estimated from the time passed since this sync
+    long _driftReferenceSeconds;          // Local time of the reference sync, in seconds since J2000
+    unsigned long _driftReferenceMillis;  // millis() at the reference sync
+    unsigned int _driftReferenceErrorMs;
+
+    unsigned long localElapsedMillis() const;
+    DayTime localTimeAt(unsigned long elapsedMillis) const;
+    void estimateClockDrift(const LocalDate &localDate, unsigned int syncErrorMs);
+    static int daysInMonth(int year, int month);
 };
 
 #endif
@@ -0,0 +1,99 @@
+#include "../Configuration.hpp"
+#include "Profiler.hpp"
+
+#if LOOP_PROFILER == 1
+
+struct ProfileStats {
+    unsigned long count;
+    unsigned long minUs;
+    unsigned long maxUs;
+    uint64_t totalUs;
+    uint16_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+};
+
+static ProfileStats profileStats[PROFILE_SECTION_COUNT];
+static const char *const profileSectionNames[PROFILE_SECTION_COUNT] = {"CMD", "LOOP", "DISP", "EEPROM", "WIFI", "GPS"};
+
+void Profiler::record(ProfileSection section, unsigned long durationUs)
+{
+    ProfileStats &stats = profileStats[section];
+    if ((stats.count == 0) || (durationUs < stats.minUs))
+    {
+        stats.minUs = durationUs;
+    }
+    if (durationUs > stats.maxUs)
+    {
+        stats.maxUs = durationUs;
+    }
+    stats.count++;
+    stats.totalUs += durationUs;
+
+    // Bucket is the number of significant bits in the duration
+    uint8_t bucket = (durationUs == 0) ? 0 : (8 * sizeof(unsigned long)) - __builtin_clzl(durationUs);
+    if (bucket >= PROFILE_HISTOGRAM_BUCKETS)
+    {
+        bucket = PROFILE_HISTOGRAM_BUCKETS - 1;
+    }
+    if (stats.histogram[bucket] != 0xFFFF)
+    {
+        stats.histogram[bucket]++;
+    }
+}
+
+void Profiler::reset()
+{
+    memset(profileStats, 0, sizeof(profileStats));
+}
+
+String Profiler::getReport()
+{
+    String result;
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++)
+    {
+        const ProfileStats &stats = profileStats[i];
+        unsigned long mean        = 0;
+        if (stats.count != 0)
+        {
+            mean = stats.totalUs / stats.count;
+        }
+        if (i > 0)
+        {
+            result += '|';
+        }
+        result += String(profileSectionNames[i]) + ',' + String(stats.count) + ',' + String(stats.minUs) + ','
+                  + String(stats.maxUs) + ',' + String(mean) + ',';
+
+        int lastBucket = PROFILE_HISTOGRAM_BUCKETS - 1;
+        while ((lastBucket > 0) && (stats.histogram[lastBucket] == 0))
+        {
+            lastBucket--;
+        }
+        for (int bucket = 0; bucket <= lastBucket; bucket++)
+        {
+            if (bucket > 0)
+            {
+                result += ';';
+            }
+            result += String(stats.histogram[bucket]);
+        }
+    }
+    result += '#';
+    return result;
+}
+
+#else
+
+void Profiler::record(ProfileSection section, unsigned long durationUs)
+{
+}
+
+void Profiler::reset()
+{
+}
+
+String Profiler::getReport()
+{
+    return "#";
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+// Sections of the main loop that are timed by the profiler
+enum ProfileSection
+{
+    PROFILE_COMMAND,     // Parsing and executing a Meade command
+    PROFILE_MOUNT_LOOP,  // Mount::loop()
+    PROFILE_DISPLAY,     // LCD menu and info display rendering
+    PROFILE_EEPROM,      // Writing to EEPROM/flash
+    PROFILE_WIFI,        // WifiControl::loop()
+    PROFILE_GPS,         // Reading and decoding GPS sentences
+
+    PROFILE_SECTION_COUNT
+};
+
+#define PROFILE_HISTOGRAM_BUCKETS 18
+
+/////////////////////////////////
+//
+// class Profiler
+//
+/////////////////////////////////
+// Keeps min/max/mean and a log2 histogram of the durations (in microseconds) of each section.
+// Bucket 0 counts zero length runs, bucket n (n > 0) counts durations from 2^(n-1) to 2^n - 1 us,
+// the last bucket also holds everything longer.
+// Only call this from the main loop, not from interruptLoop().
+class Profiler
+{
+  public:
+    static void record(ProfileSection section, unsigned long durationUs);
+    static void reset();
+
+    // Returns "name,count,min,max,mean,b0;b1;...|name,...#", trailing empty buckets are omitted.
+    static String getReport();
+};
+
+// Times the enclosing scope into the given profiler section.
+class ProfileScope
+{
+  public:
+#if LOOP_PROFILER == 1
+    ProfileScope(ProfileSection section) : _section(section), _start(micros())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        Profiler::record(_section, micros() - _start);
+    }
+
+  private:
+    ProfileSection _section;
+    unsigned long _start;
+#else
+    ProfileScope(ProfileSection section)
+    {
+    }
+#endif
+};
@@ -0,0 +1,222 @@
+#include "../Configuration.hpp"
+#include "Scheduler.hpp"
+
+struct ScheduledTask {
+    const char *name;
+    TaskFunction function;
+    unsigned long periodMs;
+    unsigned long deadlineMs;
+    unsigned long dueAt;  // Start of the period for periodic tasks, last start for every-pass tasks
+    unsigned long triggeredAt;
+    bool enabled;
+    bool triggered;
+    bool running;
+
+    unsigned long runs;
+    unsigned long maxUs;
+    uint64_t totalUs;
+    unsigned long maxLateMs;
+    unsigned long misses;
+};
+
+static ScheduledTask scheduledTasks[TASK_COUNT];
+
+// Tasks that are given another turn after each slower task has run
+static uint16_t everyPassTasks = 0;
+
+/////////////////////////////////
+//
+// lateness
+//
+/////////////////////////////////
+// Returns how long the task has been due in ms, or -1 if it is not due.
+static long lateness(const ScheduledTask &task, unsigned long now)
+{
+    if (!task.enabled || task.running || (task.function == nullptr))
+    {
+        return -1;
+    }
+    if (task.triggered)
+    {
+        return now - task.triggeredAt;
+    }
+    if (task.periodMs == SCHEDULE_EVERY_PASS)
+    {
+        return now - task.dueAt;
+    }
+    if ((task.periodMs != SCHEDULE_ON_TRIGGER) && (now - task.dueAt >= task.periodMs))
+    {
+        return now - task.dueAt - task.periodMs;
+    }
+    return -1;
+}
+
+/////////////////////////////////
+//
+// addTask
+//
+/////////////////////////////////
+void Scheduler::addTask(SchedulerTask task, const char *name, TaskFunction function, unsigned long periodMs, unsigned long deadlineMs)
+{
+    ScheduledTask &entry = scheduledTasks[task];
+    memset(&entry, 0, sizeof(entry));
+    entry.name       = name;
+    entry.function   = function;
+    entry.periodMs   = periodMs;
+    entry.deadlineMs = deadlineMs;
+    entry.dueAt      = millis();
+    entry.enabled    = true;
+    if (periodMs == SCHEDULE_EVERY_PASS)
+    {
+        everyPassTasks |= 1U << task;
+    }
+    else
+    {
+        everyPassTasks &= ~(1U << task);
+    }
+}
+
+/////////////////////////////////
+//
+// setEnabled
+//
+/////////////////////////////////
+void Scheduler::setEnabled(SchedulerTask task, bool enabled)
+{
+    scheduledTasks[task].enabled = enabled;
+    scheduledTasks[task].dueAt   = millis();
+}
+
+/////////////////////////////////
+//
+// trigger
+//
+/////////////////////////////////
+void Scheduler::trigger(SchedulerTask task)
+{
+    if (!scheduledTasks[task].triggered)
+    {
+        scheduledTasks[task].triggeredAt = millis();
+        scheduledTasks[task].triggered   = true;
+    }
+}
+
+/////////////////////////////////
+//
+// run
+//
+/////////////////////////////////
+void Scheduler::run(SchedulerTask lowestPriority)
+{
+    uint16_t done = 0;  // Tasks that already ran in this pass
+    for (;;)
+    {
+        unsigned long now = millis();
+        int next          = -1;
+        long late         = -1;
+        for (int i = 0; i <= lowestPriority; i++)
+        {
+            if ((done & (1U << i)) == 0)
+            {
+                late = lateness(scheduledTasks[i], now);
+                if (late >= 0)
+                {
+                    next = i;
+                    break;
+                }
+            }
+        }
+        if (next < 0)
+        {
+            return;
+        }
+
+        ScheduledTask &task = scheduledTasks[next];
+        done |= 1U << next;
+        if ((task.periodMs != SCHEDULE_EVERY_PASS) && !task.triggered)
+        {
+            // Keep the period stable, unless we fell more than a whole period behind.
+            task.dueAt = (now - task.dueAt >= 2 * task.periodMs) ? now : task.dueAt + task.periodMs;
+        }
+        else
+        {
+            task.dueAt = now;
+        }
+        task.triggered = false;
+        if (static_cast<unsigned long>(late) > task.maxLateMs)
+        {
+            task.maxLateMs = late;
+        }
+        if (static_cast<unsigned long>(late) > task.deadlineMs)
+        {
+            task.misses++;
+        }
+
+        task.running            = true;
+        unsigned long startTime = micros();
+        task.function();
+        unsigned long duration = micros() - startTime;
+        task.running           = false;
+
+        task.runs++;
+        task.totalUs += duration;
+        if (duration > task.maxUs)
+        {
+            task.maxUs = duration;
+        }
+
+        if (task.periodMs != SCHEDULE_EVERY_PASS)
+        {
+            done &= ~everyPassTasks;
+        }
+    }
+}
+
+/////////////////////////////////
+//
+// getReport
+//
+/////////////////////////////////
+String Scheduler::getReport()
+{
+    String result;
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        const ScheduledTask &task = scheduledTasks[i];
+        if (task.function == nullptr)
+        {
+            continue;
+        }
+        unsigned long mean = 0;
+        if (task.runs != 0)
+        {
+            mean = task.totalUs / task.runs;
+        }
+        if (result.length() > 0)
+        {
+            result += '|';
+        }
+        result += String(task.name) + ',' + String(task.runs) + ',' + String(task.maxUs) + ',' + String(mean) + ','
+                  + String(task.maxLateMs) + ',' + String(task.misses);
+    }
+    result += '#';
+    return result;
+}
+
+/////////////////////////////////
+//
+// resetStats
+//
+/////////////////////////////////
+void Scheduler::resetStats()
+{
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        ScheduledTask &task = scheduledTasks[i];
+        task.runs           = 0;
+        task.maxUs          = 0;
+        task.totalUs        = 0;
+        task.maxLateMs      = 0;
+        task.misses         = 0;
+    }
+}
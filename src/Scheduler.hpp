@@ -0,0 +1,55 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+// Tasks run by the Scheduler. The order is the priority, highest first.
+enum SchedulerTask
+{
+    TASK_GUIDE_PULSES,  // Ending guide pulses on time
+    TASK_MOUNT,         // Slew arrival, parking, homing, end switches, AZ/ALT and focuser bookkeeping
+    TASK_SERIAL,        // Polling the serial port (ESP32 only, ATmega uses serialEvent())
+    TASK_WIFI,          // WifiControl::loop()
+    TASK_GPS,           // Feeding received GPS characters to the parser
+    TASK_GYRO,          // Sampling the gyro accelerometer
+    TASK_INFO_DISPLAY,  // Rendering the OLED info display
+    TASK_LCD_DISPLAY,   // Updating the LCD menu line and tracking indicator
+
+    TASK_COUNT
+};
+
+// Period for tasks that should be checked on every scheduler pass.
+#define SCHEDULE_EVERY_PASS 0UL
+// Period for tasks that only run when triggered.
+#define SCHEDULE_ON_TRIGGER 0xFFFFFFFFUL
+
+typedef void (*TaskFunction)();
+
+/////////////////////////////////
+//
+// class Scheduler
+//
+/////////////////////////////////
+// Small cooperative scheduler for the main loop. Each task is either run on every pass, periodically
+// or only when triggered (periodic tasks can be triggered as well to run early). A pass runs the due
+// tasks in priority order and gives the every-pass tasks another turn after each slower task, so time
+// critical work (e.g. ending guide pulses) never waits for more than one other task.
+//
+// The deadline of a task is how late (in ms) it may start: for every-pass tasks it is the allowed gap
+// between two runs, for the others the delay from becoming due. Late starts are counted as misses.
+// A task is never re-entered, so tasks may call Mount::loop() (which runs a nested pass) while waiting.
+class Scheduler
+{
+  public:
+    static void addTask(SchedulerTask task, const char *name, TaskFunction function, unsigned long periodMs, unsigned long deadlineMs);
+    static void setEnabled(SchedulerTask task, bool enabled);
+
+    // Makes the task due, it runs on the next pass.
+    static void trigger(SchedulerTask task);
+
+    // Runs one pass over the due tasks up to and including the given priority.
+    static void run(SchedulerTask lowestPriority = static_cast<SchedulerTask>(TASK_COUNT - 1));
+
+    // Returns "name,runs,maxUs,meanUs,maxLateMs,misses|name,...#".
+    static String getReport();
+    static void resetStats();
+};
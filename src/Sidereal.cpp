@@ -24,10 +24,16 @@ DayTime Sidereal::calculateByGPS(TinyGPSPlus *gps)
 #endif  // USE_GPS
 
 DayTime Sidereal::calculateByDateAndTime(double longitude, int year, int month, int day, DayTime *timeUTC)
+{
+    return calculateByDateAndTime(longitude, year, month, day, timeUTC->getTotalHours());
+}
+
+// Takes the UTC time in hours, so it can hold a fraction of a second
+DayTime Sidereal::calculateByDateAndTime(double longitude, int year, int month, int day, float utcHours)
 {
     int deltaJd   = calculateDeltaJd(year, month, day);
-    double deltaJ = deltaJd + ((timeUTC->getTotalHours()) / 24.0f);
-    return DayTime(static_cast<float>(calculateTheta(deltaJ, longitude, timeUTC->getTotalHours()) / 15.0));
+    double deltaJ = deltaJd + (utcHours / 24.0f);
+    return DayTime(static_cast<float>(calculateTheta(deltaJ, longitude, utcHours) / 15.0));
 }
 
 double Sidereal::calculateTheta(double deltaJ, double longitude, float timeUTC)
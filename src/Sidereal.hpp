@@ -12,9 +12,12 @@ class Sidereal
     static DayTime calculateByGPS(TinyGPSPlus *gps);
 
     static DayTime calculateByDateAndTime(double longitude, int year, int month, int day, DayTime *timeUTC);
+    static DayTime calculateByDateAndTime(double longitude, int year, int month, int day, float utcHours);
     static DayTime calculateHa(float lstTotalHours);
 
+    // Days since J2000
+    static int calculateDeltaJd(int year, int month, int day);
+
   private:
     static double calculateTheta(double deltaJ, double longitude, float timeUTC);
-    static int calculateDeltaJd(int year, int month, int day);
 };
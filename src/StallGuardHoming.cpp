@@ -0,0 +1,281 @@
+#include "../Configuration.hpp"
+#include "Utility.hpp"
+#include "StallGuardHoming.hpp"
+#include "libs/MappedDict/MappedDict.hpp"
+
+#if (USE_STALLGUARD_RA_AUTOHOME == 1) || (USE_STALLGUARD_DEC_AUTOHOME == 1)
+
+    // SG_RESULT is low while the motor accelerates, so stalls are ignored for this long after starting
+    #define STALL_HOMING_BLANK_MS 500
+
+    // The driver only updates SG_RESULT once per full step, so it is not read again before the axis has moved one
+    #define STALL_HOMING_POLL_STEPS(axis) (((axis) == StepperAxis::RA_STEPS) ? RA_SLEW_MICROSTEPPING : DEC_SLEW_MICROSTEPPING)
+
+    #if defined(ESP32)
+        #define STALL_ISR_ATTR IRAM_ATTR
+    #else
+        #define STALL_ISR_ATTR
+    #endif
+
+StallGuardHoming *StallGuardHoming::_latchInstance[2] = {nullptr, nullptr};
+
+/////////////////////////////////
+//
+// latchRaStall
+//
+/////////////////////////////////
+// attachInterrupt() handlers get no context, so each axis has its own
+void STALL_ISR_ATTR StallGuardHoming::latchRaStall()
+{
+    if (_latchInstance[StepperAxis::RA_STEPS] != nullptr)
+    {
+        _latchInstance[StepperAxis::RA_STEPS]->_stallLatched = true;
+    }
+}
+
+/////////////////////////////////
+//
+// latchDecStall
+//
+/////////////////////////////////
+void STALL_ISR_ATTR StallGuardHoming::latchDecStall()
+{
+    if (_latchInstance[StepperAxis::DEC_STEPS] != nullptr)
+    {
+        _latchInstance[StepperAxis::DEC_STEPS]->_stallLatched = true;
+    }
+}
+
+/////////////////////////////////
+//
+// attachLatch
+//
+/////////////////////////////////
+void StallGuardHoming::attachLatch()
+{
+    const int interrupt = digitalPinToInterrupt(_diagPin);
+    if (interrupt == NOT_AN_INTERRUPT)
+    {
+        LOG(DEBUG_STEPPERS, "[STALLHOME]: DIAG pin %d has no interrupt, polling SG_RESULT", _diagPin);
+        return;
+    }
+
+    _stallLatched         = false;
+    _latchInstance[_axis] = this;
+    attachInterrupt(interrupt, (_axis == StepperAxis::RA_STEPS) ? latchRaStall : latchDecStall, RISING);
+    _latching = true;
+    LOG(DEBUG_STEPPERS, "[STALLHOME]: Latching stalls on interrupt %d", interrupt);
+}
+
+/////////////////////////////////
+//
+// detachLatch
+//
+/////////////////////////////////
+void StallGuardHoming::detachLatch()
+{
+    if (_latching)
+    {
+        detachInterrupt(digitalPinToInterrupt(_diagPin));
+        _latchInstance[_axis] = nullptr;
+        _latching             = false;
+    }
+}
+
+/////////////////////////////////
+//
+// isStalled
+//
+/////////////////////////////////
+bool StallGuardHoming::isStalled()
+{
+    if (_latching)
+    {
+        return _stallLatched;
+    }
+
+    const long position = _pMount->getCurrentStepperPosition(_axis);
+    if (labs(position - _polledPosition) >= STALL_HOMING_POLL_STEPS(_axis))
+    {
+        _polledPosition = position;
+        _polledStall    = _pMount->isAxisStalled(_axis);
+    }
+    return _polledStall;
+}
+
+/////////////////////////////////
+//
+// getHomingState
+//
+/////////////////////////////////
+String StallGuardHoming::getHomingState() const
+{
+    MappedDict<StallHomingState, String>::DictEntry_t lookupTable[] = {
+        {STALL_HOMING_SEEKING, F("SEEKING_STOP")},
+        {STALL_HOMING_WAIT_FOR_STOP, F("WAIT_FOR_STOP")},
+        {STALL_HOMING_MOVING_HOME, F("MOVING_HOME")},
+        {STALL_HOMING_FAILED, F("FAILED")},
+        {STALL_HOMING_SUCCESSFUL, F("SUCCESSFUL")},
+        {STALL_HOMING_NOT_ACTIVE, F("NOT_ACTIVE")},
+    };
+
+    auto strLookup = MappedDict<StallHomingState, String>(lookupTable, ARRAY_SIZE(lookupTable));
+    String rtnStr;
+    if (strLookup.tryGet(_state, &rtnStr))
+    {
+        return rtnStr;
+    }
+    return F("WTF_STATE");
+}
+
+/////////////////////////////////
+//
+// getLastResult
+//
+/////////////////////////////////
+String StallGuardHoming::getLastResult() const
+{
+    MappedDict<int, String>::DictEntry_t lookupTable[] = {
+        {STALL_HOMING_RESULT_SUCCEEDED, F("SUCCEEDED")},
+        {STALL_HOMING_RESULT_HOMING_NEVER_RUN, F("NEVER RUN")},
+        {STALL_HOMING_RESULT_IN_PROGRESS, F("IN PROGRESS")},
+        {STALL_HOMING_RESULT_NO_STALL_DETECTED, F("NO STALL DETECTED")},
+    };
+
+    auto strLookup = MappedDict<int, String>(lookupTable, ARRAY_SIZE(lookupTable));
+    String rtnStr;
+    if (strLookup.tryGet(_lastResult, &rtnStr))
+    {
+        return rtnStr;
+    }
+    return F("WTF_RESULT");
+}
+
+/////////////////////////////////
+//
+// findHomeByStallGuard
+//
+/////////////////////////////////
+bool StallGuardHoming::findHomeByStallGuard(int searchDistanceDegrees, int slewRate)
+{
+    long distance = _direction * _stepsPerDegree * searchDistanceDegrees;
+    LOG(DEBUG_STEPPERS,
+        "[STALLHOME]: Start homing procedure. Axis %d, moving %l steps towards the stop at rate %d",
+        (int) _axis,
+        distance,
+        slewRate);
+
+    _lastResult = STALL_HOMING_RESULT_IN_PROGRESS;
+    _savedRate  = _pMount->getSlewRate();
+    _pMount->setSlewRate(slewRate);
+    _pMount->setStatusFlag(STATUS_FINDING_HOME);
+    _pMount->enableStallGuard(_axis, true);
+    attachLatch();
+
+    _polledPosition = _pMount->getCurrentStepperPosition(_axis);
+    _polledStall    = false;
+    _pMount->moveStepperBy(_axis, distance);
+    _startedAt = millis();
+    _state     = StallHomingState::STALL_HOMING_SEEKING;
+    return true;
+}
+
+/////////////////////////////////
+//
+// processHomingProgress
+//
+/////////////////////////////////
+void StallGuardHoming::processHomingProgress()
+{
+    switch (_state)
+    {
+        case StallHomingState::STALL_HOMING_NOT_ACTIVE:
+            break;
+
+        case StallHomingState::STALL_HOMING_SEEKING:
+            {
+                if (millis() - _startedAt < STALL_HOMING_BLANK_MS)
+                {
+                    _stallLatched = false;
+                }
+                else if (isStalled())
+                {
+                    LOG(DEBUG_STEPPERS,
+                        "[STALLHOME]: Stall detected at %l, stopping. Advance to WAIT_FOR_STOP",
+                        _pMount->getCurrentStepperPosition(_axis));
+                    _pMount->stopSlewing(_axis);
+                    _state = StallHomingState::STALL_HOMING_WAIT_FOR_STOP;
+                }
+                else if (!_pMount->isAxisRunning(_axis))
+                {
+                    LOG(DEBUG_STEPPERS, "[STALLHOME]: Search distance used up without a stall. Advance to FAILED");
+                    _lastResult = STALL_HOMING_RESULT_NO_STALL_DETECTED;
+                    _state      = StallHomingState::STALL_HOMING_FAILED;
+                }
+            }
+            break;
+
+        case StallHomingState::STALL_HOMING_WAIT_FOR_STOP:
+            {
+                if (!_pMount->isAxisRunning(_axis))
+                {
+                    // The steps counted while stalled did not move the axis, it is physically at the stop. So the
+                    // home position is the offset away from wherever the stepper position ended up.
+                    LOG(DEBUG_STEPPERS,
+                        "[STALLHOME]: Stopped against the stop, moving %l steps to home. Advance to MOVING_HOME",
+                        -_direction * _offset);
+                    detachLatch();
+                    _pMount->enableStallGuard(_axis, false);
+                    _pMount->moveStepperBy(_axis, -_direction * _offset);
+                    _state = StallHomingState::STALL_HOMING_MOVING_HOME;
+                }
+            }
+            break;
+
+        case StallHomingState::STALL_HOMING_MOVING_HOME:
+            {
+                if (!_pMount->isAxisRunning(_axis))
+                {
+                    _state = StallHomingState::STALL_HOMING_SUCCESSFUL;
+                }
+            }
+            break;
+
+        case StallHomingState::STALL_HOMING_SUCCESSFUL:
+            {
+                LOG(DEBUG_STEPPERS, "[STALLHOME]: Successfully homed! Setting home and restoring Rate setting.");
+                _lastResult = STALL_HOMING_RESULT_SUCCEEDED;
+                _state      = StallHomingState::STALL_HOMING_NOT_ACTIVE;
+                _pMount->setHome(false);
+                _pMount->setSlewRate(_savedRate);
+                _pMount->clearStatusFlag(STATUS_FINDING_HOME);
+                if (_wasTracking)
+                {
+                    _pMount->startSlewing(TRACKING);
+                }
+            }
+            break;
+
+        case StallHomingState::STALL_HOMING_FAILED:
+            {
+                LOG(DEBUG_STEPPERS, "[STALLHOME]: Failed to home! Restoring Rate setting.");
+                _state = StallHomingState::STALL_HOMING_NOT_ACTIVE;
+                detachLatch();
+                _pMount->enableStallGuard(_axis, false);
+                _pMount->setSlewRate(_savedRate);
+                _pMount->clearStatusFlag(STATUS_FINDING_HOME);
+            }
+            break;
+
+        default:
+            LOG(DEBUG_STEPPERS, "[STALLHOME]: Unhandled state (%d)! ", _state);
+            break;
+    }
+}
+
+bool StallGuardHoming::isIdleOrComplete() const
+{
+    return _state == StallHomingState::STALL_HOMING_NOT_ACTIVE;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef _STALLGUARDHOMING_HPP
+#define _STALLGUARDHOMING_HPP
+
+#include "Types.hpp"
+#include "Mount.hpp"
+
+#define STALL_HOMING_RESULT_SUCCEEDED         1
+#define STALL_HOMING_RESULT_HOMING_NEVER_RUN  0
+#define STALL_HOMING_RESULT_IN_PROGRESS       -1
+#define STALL_HOMING_RESULT_NO_STALL_DETECTED -2
+
+class Mount;
+
+enum StallHomingState
+{
+    STALL_HOMING_SEEKING,
+    STALL_HOMING_WAIT_FOR_STOP,
+    STALL_HOMING_MOVING_HOME,
+    STALL_HOMING_FAILED,
+    STALL_HOMING_SUCCESSFUL,
+
+    STALL_HOMING_NOT_ACTIVE
+};
+
+/////////////////////////////////
+//
+// class StallGuardHoming
+//
+/////////////////////////////////
+// Homes an axis without a sensor by driving it against its hard stop until the TMC2209 reports a stall. The stall
+// is taken from the DIAG pin interrupt if the pin has one, else SG_RESULT is polled over UART.
+class StallGuardHoming
+{
+  private:
+    StallHomingState _state;
+    Mount *_pMount;
+    StepperAxis _axis;
+    long _stepsPerDegree;
+    int _diagPin;
+    int _direction;
+    long _offset;
+    int _lastResult;
+    int _savedRate;
+    bool _wasTracking;
+    bool _latching;                              // True while the DIAG pin interrupt is attached
+    volatile bool _stallLatched;                 // Set by the DIAG pin interrupt
+    unsigned long _startedAt;                    // Time the axis started moving towards the stop
+    long _polledPosition;                        // Stepper position SG_RESULT was last read at
+    bool _polledStall;                           // Stall state from the last SG_RESULT read
+    static StallGuardHoming *_latchInstance[2];  // Instance homing RA and DEC, for the interrupt handlers
+
+    static void latchRaStall();
+    static void latchDecStall();
+    void attachLatch();
+    void detachLatch();
+    bool isStalled();
+
+  public:
+    StallGuardHoming(Mount *mount, StepperAxis axis, long stepsPerDegree, int diagPin, int direction, int32_t offset)
+    {
+        _state          = StallHomingState::STALL_HOMING_NOT_ACTIVE;
+        _pMount         = mount;
+        _axis           = axis;
+        _stepsPerDegree = stepsPerDegree;
+        _diagPin        = diagPin;
+        _direction      = direction;
+        _offset         = offset;
+        _lastResult     = STALL_HOMING_RESULT_HOMING_NEVER_RUN;
+        _savedRate      = mount->getSlewRate();
+        _wasTracking    = mount->isSlewingTRK();
+        _latching       = false;
+        _stallLatched   = false;
+        _startedAt      = 0;
+        _polledPosition = 0;
+        _polledStall    = false;
+    }
+
+    ~StallGuardHoming()
+    {
+        detachLatch();
+    }
+
+    bool findHomeByStallGuard(int searchDistanceDegrees, int slewRate);
+    void processHomingProgress();
+    String getHomingState() const;
+    bool isIdleOrComplete() const;
+    String getLastResult() const;
+    bool hasSucceeded() const
+    {
+        return _lastResult == STALL_HOMING_RESULT_SUCCEEDED;
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "../Configuration.hpp"
+#include "CriticalSection.hpp"
+#include "StepTiming.hpp"
+
+#if STEP_TIMING_CAPTURE == 1
+
+volatile bool StepTiming::_enabled = false;
+uint32_t StepTiming::_samples[STEP_TIMING_BUFFER_SIZE];
+volatile uint16_t StepTiming::_head     = 0;
+volatile uint16_t StepTiming::_tail     = 0;
+volatile uint16_t StepTiming::_overruns = 0;
+
+/////////////////////////////////
+//
+// setEnabled
+//
+/////////////////////////////////
+// Starting a capture discards anything that was not downloaded yet.
+void StepTiming::setEnabled(bool enabled)
+{
+    CriticalSection lock;
+    if (enabled && !_enabled)
+    {
+        _head     = 0;
+        _tail     = 0;
+        _overruns = 0;
+    }
+    _enabled = enabled;
+}
+
+/////////////////////////////////
+//
+// ticksPerSecond
+//
+/////////////////////////////////
+unsigned long StepTiming::ticksPerSecond()
+{
+    #if defined(ESP32)
+    return getCpuFrequencyMhz() * 1000000UL;
+    #else
+    return 1000000UL;
+    #endif
+}
+
+/////////////////////////////////
+//
+// getNextSamples
+//
+/////////////////////////////////
+String StepTiming::getNextSamples()
+{
+    uint16_t head;
+    uint16_t overruns;
+    {
+        CriticalSection lock;
+        head      = _head;
+        overruns  = _overruns;
+        _overruns = 0;
+    }
+
+    String result = String(ticksPerSecond()) + "|" + String(overruns) + "|";
+    uint16_t tail = _tail;
+    for (int count = 0; (tail != head) && (count < 16); count++)
+    {
+        if (count > 0)
+        {
+            result += ',';
+        }
+        result += String(_samples[tail]);
+        tail = (tail + 1) & (STEP_TIMING_BUFFER_SIZE - 1);
+    }
+
+    {
+        CriticalSection lock;
+        _tail = tail;
+    }
+    return result + "#";
+}
+
+#endif
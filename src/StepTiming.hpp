@@ -0,0 +1,67 @@
+#pragma once
+
+#include "inc/Globals.hpp"
+
+#if STEP_TIMING_CAPTURE == 1
+
+/////////////////////////////////
+//
+// class StepTiming
+//
+/////////////////////////////////
+// Captures a timestamp for every RA tracking step into a ring buffer, so that the step timing can be
+// downloaded (see :XGJ#) and analyzed on a PC with scripts/StepJitterAnalyzer.py.
+// Timestamps are CPU cycles on ESP32 and microseconds (4us resolution) on ATmega.
+// capture() is called from the stepper interrupt, everything else from the main loop.
+class StepTiming
+{
+  public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled()
+    {
+        return _enabled;
+    }
+
+    static void capture()
+    {
+        if (!_enabled)
+        {
+            return;
+        }
+        uint16_t next = (_head + 1) & (STEP_TIMING_BUFFER_SIZE - 1);
+        if (next == _tail)
+        {
+            if (_overruns != 0xFFFF)
+            {
+                _overruns++;
+            }
+            return;
+        }
+        _samples[_head] = ticks();
+        _head           = next;
+    }
+
+    static unsigned long ticksPerSecond();
+
+    // Returns "ticksPerSecond|overruns|t1,t2,...#" with up to 16 of the oldest samples and removes them.
+    // overruns is the number of samples lost because the buffer was full since the last call.
+    static String getNextSamples();
+
+  private:
+    static uint32_t ticks()
+    {
+    #if defined(ESP32)
+        return ESP.getCycleCount();
+    #else
+        return micros();
+    #endif
+    }
+
+    static volatile bool _enabled;
+    static uint32_t _samples[STEP_TIMING_BUFFER_SIZE];
+    static volatile uint16_t _head;
+    static volatile uint16_t _tail;
+    static volatile uint16_t _overruns;
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "../Configuration.hpp"
 #include "Utility.hpp"
+#include "CriticalSection.hpp"
 
 #if DEBUG_LEVEL > 0
     #include <stdarg.h>
@@ -13,102 +14,118 @@ unsigned long RealTime::_suspendStart = 0;
 int RealTime::_suspended              = 0;
 #endif
 
+#if defined(ESP32)
+portMUX_TYPE criticalSectionMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 #if BUFFER_LOGS == true
-    #define LOG_BUFFER_SIZE 512
-char logBuffer[LOG_BUFFER_SIZE];
-int bufferWritePos = 0;
-int bufferStartPos = 0;
+// Fixed size log records, kept in a ring that overwrites the oldest record when it is full.
+// Adding a record only copies one line under a short critical section, so it can be done from
+// interruptLoop() as well.
+struct LogRecord {
+    uint16_t sequence;
+    unsigned long time;
+    char text[LOG_BUFFER_RECORD_LENGTH];
+};
+
+LogRecord logRecords[LOG_BUFFER_RECORDS];
+uint8_t logHead        = 0;  // Slot that receives the next record
+uint8_t logCount       = 0;  // Number of valid records in the ring
+uint16_t logSequence   = 0;  // Sequence number of the next record
+uint16_t logReadCursor = 0;  // Sequence number of the next record to be streamed
 
-int scanForNextNewLine(int bufPos)
+void addToLogBuffer(unsigned long timestamp, const char *text)
 {
-    for (int i = bufPos; i < LOG_BUFFER_SIZE; i++)
+    CriticalSection lock;
+    LogRecord &record = logRecords[logHead];
+    record.sequence   = logSequence++;
+    record.time       = timestamp;
+    strncpy(record.text, text, LOG_BUFFER_RECORD_LENGTH - 1);
+    record.text[LOG_BUFFER_RECORD_LENGTH - 1] = '\0';
+
+    logHead = (logHead + 1) % LOG_BUFFER_RECORDS;
+    if (logCount < LOG_BUFFER_RECORDS)
     {
-        if (logBuffer[i] == '\n')
-        {
-            return i;
-        }
+        logCount++;
     }
+}
 
-    for (int i = 0; i < LOG_BUFFER_SIZE; i++)
+// Copies the record with the given age (0 is the oldest) out of the ring. Returns false if there is no such record.
+bool copyLogRecord(uint8_t age, LogRecord &copy)
+{
+    CriticalSection lock;
+    if (age >= logCount)
     {
-        if (logBuffer[i] == '\n')
-        {
-            return i;
-        }
+        return false;
     }
-    // WTF?
-    return 0;
+    copy = logRecords[(logHead + LOG_BUFFER_RECORDS - logCount + age) % LOG_BUFFER_RECORDS];
+    return true;
 }
 
-void addToLogBuffer(String s)
+// '#' terminates a Meade reply, so it is replaced in the log text.
+void appendLogText(String &result, const char *text)
 {
-    s += '\n';
-    int charsToWrite = s.length();
-    if (bufferWritePos + charsToWrite > LOG_BUFFER_SIZE)
-    {
-        int charsToWriteAtEndOfBuffer = LOG_BUFFER_SIZE - bufferWritePos;
-        memcpy(logBuffer + bufferWritePos, s.c_str(), charsToWriteAtEndOfBuffer);
-        charsToWrite -= charsToWriteAtEndOfBuffer;
-        memcpy(logBuffer, s.c_str() + charsToWriteAtEndOfBuffer, charsToWrite);
-        bufferWritePos            = charsToWrite;
-        logBuffer[bufferWritePos] = '\0';
-        bufferStartPos            = scanForNextNewLine(bufferWritePos);
-    }
-    else
+    for (const char *p = text; *p != '\0'; p++)
     {
-        memcpy(logBuffer + bufferWritePos, s.c_str(), charsToWrite);
-        if (bufferStartPos > bufferWritePos)
-        {
-            bufferWritePos += charsToWrite;
-            bufferStartPos = scanForNextNewLine(bufferWritePos);
-        }
-        else
-        {
-            bufferWritePos += charsToWrite;
-        }
+        result += (*p == '#') ? '%' : *p;
     }
 }
 
-class MyString : public String
+String getLogBuffer()
 {
-  public:
-    void setLen(unsigned int newLen)
+    String result;
+    result.reserve(LOG_BUFFER_RECORDS * 32);
+    LogRecord record;
+    for (uint8_t age = 0; copyLogRecord(age, record); age++)
     {
-        len = newLen;
+        appendLogText(result, record.text);
+        result += '\n';
     }
-};
+    result += '#';
+    return result;
+}
 
-String getLogBuffer()
+String getNextLogRecord()
 {
-    MyString result;
-    unsigned int len = (bufferStartPos > bufferWritePos) ? LOG_BUFFER_SIZE - bufferStartPos : 0;
-    len += bufferWritePos;
-    result.reserve(len + 2);
-    char *buffer = result.begin();
-
-    if (bufferStartPos > bufferWritePos)
+    uint8_t count;
     {
-        for (int i = bufferStartPos; i < LOG_BUFFER_SIZE; i++)
+        // Records the reader fell behind on are gone, so skip to the oldest one still in the ring. Otherwise a
+        // writer more than half the sequence range ahead would make every retained record look older than the cursor.
+        CriticalSection lock;
+        count = logCount;
+        if (static_cast<uint16_t>(logSequence - logReadCursor) > count)
         {
-            *buffer++ = (logBuffer[i] == '#') ? '%' : logBuffer[i];
+            logReadCursor = logSequence - count;
         }
     }
 
-    for (int i = 0; i < bufferWritePos; i++)
+    LogRecord record;
+    for (uint8_t age = 0; copyLogRecord(age, record); age++)
     {
-        *buffer++ = (logBuffer[i] == '#') ? '%' : logBuffer[i];
+        // Sequence numbers wrap, so compare the distance instead of the values. Records before the cursor wrap
+        // around to a distance larger than the ring.
+        uint16_t distance = record.sequence - logReadCursor;
+        if (distance < LOG_BUFFER_RECORDS)
+        {
+            logReadCursor = record.sequence + 1;
+            String result = String(record.sequence) + "|" + String(record.time) + "|";
+            appendLogText(result, record.text);
+            result += '#';
+            return result;
+        }
     }
-
-    *buffer++ = '#';
-    *buffer   = '\0';
-    result.setLen(buffer - result.begin());
-    return result;
+    return "#";
 }
 #else
 String getLogBuffer()
 {
     return "Debugging disabled.#";
 }
+
+String getNextLogRecord()
+{
+    return "#";
+}
 #endif
 
 // Adjust the given number by the given adjustment, wrap around the limits.
@@ -255,22 +272,38 @@ int freeMemory()
 
 #if DEBUG_LEVEL > 0
 
-String formatArg(const char *input, va_list args)
+// Formats the input into the buffer without allocating, so it can be used from interruptLoop().
+// The output is truncated to fit into bufferSize characters (including the terminator).
+// If inProgmem is set, the input is read from flash (as passed to LOG() via F()).
+void formatArg(char *buffer, size_t bufferSize, const char *input, bool inProgmem, va_list args)
 {
     const char *nibble = "0123456789ABCDEF";
-    char achBuffer[255];
-    char *p = achBuffer;
+    char number[48];
+    char *p         = buffer;
+    const char *end = buffer + bufferSize - 1;
 
-    for (const char *i = input; *i != 0; i++)
+    for (const char *i = input; (p < end); i++)
     {
-        if (*i != '%')
+        char ch = inProgmem ? static_cast<char>(pgm_read_byte(i)) : *i;
+        if (ch == '\0')
+        {
+            break;
+        }
+        if (ch != '%')
         {
-            *p++ = *i;
+            *p++ = ch;
             continue;
         }
         i++;
-        switch (*i)
+        ch                  = inProgmem ? static_cast<char>(pgm_read_byte(i)) : *i;
+        const char *toWrite = number;
+        number[0]           = '\0';
+        switch (ch)
         {
+            case '\0':
+                i--;
+                break;
+
             case '%':
                 {
                     *p++ = '%';
@@ -279,24 +312,19 @@ String formatArg(const char *input, va_list args)
 
             case 'c':
                 {
-                    char ch = (char) va_arg(args, int);
-                    *p++    = ch;
+                    *p++ = (char) va_arg(args, int);
                 }
                 break;
 
             case 's':
                 {
-                    char *s = va_arg(args, char *);
-                    strcpy(p, s);
-                    p += strlen(s);
+                    toWrite = va_arg(args, char *);
                 }
                 break;
 
             case 'd':
                 {
-                    String s = String((int) va_arg(args, int));
-                    strcpy(p, s.c_str());
-                    p += s.length();
+                    itoa((int) va_arg(args, int), number, 10);
                 }
                 break;
 
@@ -305,46 +333,53 @@ String formatArg(const char *input, va_list args)
                     int n             = (int) va_arg(args, int);
                     int shift         = 12;
                     unsigned int mask = 0xF000;
-                    *p++              = '0';
-                    *p++              = 'x';
+                    char *h           = number;
+                    *h++              = '0';
+                    *h++              = 'x';
                     while (shift >= 0)
                     {
                         int d = (n & mask) >> shift;
-                        *p++  = *(nibble + d);
+                        *h++  = *(nibble + d);
                         mask  = mask >> 4;
                         shift -= 4;
                     }
-
-                    *p = 0;
+                    *h = '\0';
                 }
                 break;
 
             case 'l':
                 {
-                    String s = String((long) va_arg(args, long));
-                    strcpy(p, s.c_str());
-                    p += s.length();
+                    ltoa((long) va_arg(args, long), number, 10);
                 }
                 break;
 
             case 'f':
                 {
                     float num = (float) va_arg(args, double);
-                    String s  = String(num, 4);
-                    strcpy(p, s.c_str());
-                    p += s.length();
+                    dtostrf(num, 1, 4, number);
                 }
                 break;
 
             default:
                 {
-                    *p++ = *i;
+                    *p++ = ch;
                 }
                 break;
         }
+
+        while ((*toWrite != '\0') && (p < end))
+        {
+            *p++ = *toWrite++;
+        }
     }
 
     *p = '\0';
+}
+
+String formatArg(const char *input, va_list args)
+{
+    char achBuffer[255];
+    formatArg(achBuffer, sizeof(achBuffer), input, false, args);
     return String(achBuffer);
 }
 
@@ -359,17 +394,19 @@ String format(const char *input, ...)
 
 unsigned long lastLog = 0;
 
-void logv(int levelFlags, String input, ...)
+void logv(int levelFlags, const __FlashStringHelper *input, ...)
 {
     if ((levelFlags & DEBUG_LEVEL) != 0)
     {
-        unsigned long now   = millis();
-        unsigned long delta = now - lastLog;
+        unsigned long now = millis();
         va_list argp;
         va_start(argp, input);
     #if BUFFER_LOGS == true
-        addToLogBuffer(formatArg(input.c_str(), argp));
+        char message[LOG_BUFFER_RECORD_LENGTH];
+        formatArg(message, sizeof(message), reinterpret_cast<const char *>(input), true, argp);
+        addToLogBuffer(now, message);
     #else
+        unsigned long delta = now - lastLog;
         DEBUG_SERIAL_PORT.print("[");
         DEBUG_SERIAL_PORT.print(String(now));
         DEBUG_SERIAL_PORT.print("]{");
@@ -377,7 +414,9 @@ void logv(int levelFlags, String input, ...)
         DEBUG_SERIAL_PORT.print("}ms:");
         DEBUG_SERIAL_PORT.print(String(freeMemory()));
         DEBUG_SERIAL_PORT.print("B: ");
-        DEBUG_SERIAL_PORT.println(formatArg(input.c_str(), argp));
+        char message[255];
+        formatArg(message, sizeof(message), reinterpret_cast<const char *>(input), true, argp);
+        DEBUG_SERIAL_PORT.println(message);
         DEBUG_SERIAL_PORT.flush();
     #endif
         lastLog = now;
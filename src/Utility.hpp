@@ -8,10 +8,24 @@
 #endif
 
 String getLogBuffer();
+String getNextLogRecord();
 int freeMemory();
 
 #if DEBUG_LEVEL > 0
-    #define LOG(level, format, ...) logv((level), (F(format)), ##__VA_ARGS__)
+    #if BINARY_LOGS == true
+        #include "BinaryLog.hpp"
+        // Only the hash of the format string and the raw arguments are stored, see BinaryLog.hpp
+        #define LOG(level, format, ...)                                                                                                    \
+            do                                                                                                                             \
+            {                                                                                                                              \
+                if (((DEBUG_LEVEL) & (level)) != 0)                                                                                        \
+                {                                                                                                                          \
+                    BinaryLog::write(BinaryLogId<BinaryLog::hash(format)>::value, ##__VA_ARGS__);                                          \
+                }                                                                                                                          \
+            } while (0)
+    #else
+        #define LOG(level, format, ...) logv((level), (F(format)), ##__VA_ARGS__)
+    #endif
 
 // Realtime timer class using microseconds to time stuff
 class RealTime
@@ -122,11 +136,12 @@ class PerfMeasure
     }
 };
 
+void formatArg(char *buffer, size_t bufferSize, const char *input, bool inProgmem, va_list args);
 String formatArg(const char *input, va_list args);
 String format(const char *input, ...);
 // void log(const char* input);
 // void log(String input);
-void logv(int levelFlags, String input, ...);
+void logv(int levelFlags, const __FlashStringHelper *input, ...);
 
 #else  // DEBUG_LEVEL>0
     #define LOG(level, format, ...)
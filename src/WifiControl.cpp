@@ -3,6 +3,7 @@
 #include "WifiControl.hpp"
 #include "MeadeCommandProcessor.hpp"
 #include "Mount.hpp"
+#include "Profiler.hpp"
 
 #if (WIFI_ENABLED == 1)
 
@@ -119,6 +120,7 @@ String WifiControl::getStatus()
 
 void WifiControl::loop()
 {
+    ProfileScope profile(PROFILE_WIFI);
     if (WIFI_MODE == WIFI_MODE_DISABLED)
     {
         return;
@@ -144,8 +146,6 @@ void WifiControl::loop()
         }
     }
 
-    _mount->loop();
-
     if (_status != WL_CONNECTED)
     {
         infraToAPFailover();
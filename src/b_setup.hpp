@@ -90,6 +90,11 @@ void stepperControlTimerCallback(void *payload)
     #endif
 #endif
 
+void setupTasks();  // defined in c_buttons.hpp
+#if (USE_GPS == 1) && defined(GPS_PPS_PIN)
+void gpsStartPps();  // defined in c72_menuHA_GPS.hpp
+#endif
+
 /////////////////////////////////
 //
 // Main program setup
@@ -112,6 +117,7 @@ void setup()
 #endif
 
     LOG(DEBUG_ANY, "[SYSTEM]: Hello, universe, this is OAT %s!", VERSION);
+    setupTasks();
 
 #if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
     LOG(DEBUG_ANY, "[SYSTEM]: Get OLED info screen ready...");
@@ -122,6 +128,9 @@ void setup()
 
 #if USE_GPS == 1
     GPS_SERIAL_PORT.begin(GPS_BAUD_RATE);
+    #if defined(GPS_PPS_PIN)
+    gpsStartPps();
+    #endif
 #endif
 
 //Turn on dew heater
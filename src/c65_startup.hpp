@@ -18,6 +18,10 @@ void setControlMode(bool);  // In CTRL menu
 enum startupState_t
 {
     StartupIsInHomePosition,
+        #if (USE_STALLGUARD_RA_AUTOHOME == 1) && (USE_STALLGUARD_DEC_AUTOHOME == 1)
+    StartupWaitForRAHoming,
+    StartupWaitForDECHoming,
+        #endif
     StartupSetRoll,
     StartupWaitForRollCompletion,
     StartupRollConfirmed,
@@ -56,6 +60,31 @@ void startupIsCompleted()
     LOG(DEBUG_ANY, "[STARTUP]: Completed!");
 }
 
+// The mount is in the home position, continue with leveling or the HA
+void startupHomeConfirmed()
+{
+        #if USE_GYRO_LEVEL == 1
+    startupState = StartupSetRoll;
+    LOG(DEBUG_INFO, "[STARTUP]: State is set roll!");
+        #else
+    startupState = StartupSetHATime;
+        #endif
+}
+
+// Let the user move the mount to the home position in the CTRL menu
+void startupHomeManually()
+{
+    startupState   = StartupWaitForPoleCompletion;
+    inStartup      = false;
+    okToUpdateMenu = false;
+    lcdMenu.setCursor(0, 0);
+    lcdMenu.printMenu("Home with ^~<>");
+    lcdMenu.setActive(Control_Menu);
+
+    // Skip the 'Manual control' prompt
+    setControlMode(true);
+}
+
 bool processStartupKeys()
 {
     lcdButton_t key;
@@ -75,24 +104,18 @@ bool processStartupKeys()
                     {
                         if (isInHomePosition == YES)
                         {
-        #if USE_GYRO_LEVEL == 1
-                            startupState = StartupSetRoll;
-                            LOG(DEBUG_INFO, "[STARTUP]: State is set roll!");
-        #else
-                            startupState = StartupSetHATime;
-        #endif
+                            startupHomeConfirmed();
                         }
                         else if (isInHomePosition == NO)
                         {
-                            startupState   = StartupWaitForPoleCompletion;
-                            inStartup      = false;
-                            okToUpdateMenu = false;
-                            lcdMenu.setCursor(0, 0);
-                            lcdMenu.printMenu("Home with ^~<>");
-                            lcdMenu.setActive(Control_Menu);
-
-                            // Skip the 'Manual control' prompt
-                            setControlMode(true);
+        #if (USE_STALLGUARD_RA_AUTOHOME == 1) && (USE_STALLGUARD_DEC_AUTOHOME == 1)
+                            // Both axes can find their hard stops, so home them one after the other instead of by hand
+                            LOG(DEBUG_INFO, "[STARTUP]: Homing RA by StallGuard");
+                            mount.findHomeByStallGuard(StepperAxis::RA_STEPS);
+                            startupState = StartupWaitForRAHoming;
+        #else
+                            startupHomeManually();
+        #endif
                         }
                         else if (isInHomePosition == CANCEL)
                         {
@@ -103,6 +126,44 @@ bool processStartupKeys()
             }
             break;
 
+        #if (USE_STALLGUARD_RA_AUTOHOME == 1) && (USE_STALLGUARD_DEC_AUTOHOME == 1)
+        case StartupWaitForRAHoming:
+            {
+                if (!mount.isFindingHome())
+                {
+                    if (mount.hasStallGuardHomed(StepperAxis::RA_STEPS))
+                    {
+                        LOG(DEBUG_INFO, "[STARTUP]: Homing DEC by StallGuard");
+                        mount.findHomeByStallGuard(StepperAxis::DEC_STEPS);
+                        startupState = StartupWaitForDECHoming;
+                    }
+                    else
+                    {
+                        LOG(DEBUG_INFO, "[STARTUP]: RA StallGuard homing failed, home manually");
+                        startupHomeManually();
+                    }
+                }
+            }
+            break;
+
+        case StartupWaitForDECHoming:
+            {
+                if (!mount.isFindingHome())
+                {
+                    if (mount.hasStallGuardHomed(StepperAxis::DEC_STEPS))
+                    {
+                        startupHomeConfirmed();
+                    }
+                    else
+                    {
+                        LOG(DEBUG_INFO, "[STARTUP]: DEC StallGuard homing failed, home manually");
+                        startupHomeManually();
+                    }
+                }
+            }
+            break;
+        #endif
+
         #if USE_GYRO_LEVEL == 1
         case StartupSetRoll:
             {
@@ -204,6 +265,18 @@ void printStartupMenu()
             }
             break;
 
+        #if (USE_STALLGUARD_RA_AUTOHOME == 1) && (USE_STALLGUARD_DEC_AUTOHOME == 1)
+        case StartupWaitForRAHoming:
+        case StartupWaitForDECHoming:
+            {
+                lcdMenu.setCursor(0, 0);
+                lcdMenu.printMenu("Auto homing...");
+                lcdMenu.setCursor(0, 1);
+                lcdMenu.printMenu((startupState == StartupWaitForRAHoming) ? "RA axis" : "DEC axis");
+            }
+            break;
+        #endif
+
         default:
             break;
     }
@@ -2,6 +2,8 @@
 
 #include "../Configuration.hpp"
 #include "EPROMStore.hpp"
+#include "Profiler.hpp"
+#include "CriticalSection.hpp"
 
 #if USE_GPS == 1
 
@@ -10,9 +12,221 @@ char gpsBuf[256];
 int gpsBufPos = 0;
     #endif
 
-long lastGPSUpdate = 0;
-bool gpsAqcuisitionComplete(int &indicator)
+long lastGPSUpdate         = 0;
+int gpsIndicator           = 0;
+bool gpsSentenceDecoded    = false;
+bool gpsClockSynced        = false;  // Set once a fix was applied, after that every new second keeps the clock in step
+uint32_t gpsLastSyncedTime = 0;      // TinyGPS time value of the last second the clock was synced to
+
+    #if defined(GPS_PPS_PIN)
+        #if defined(ESP32)
+            #define GPS_ISR_ATTR IRAM_ATTR
+        #else
+            #define GPS_ISR_ATTR
+        #endif
+
+        #define GPS_PPS_MAX_DRIFT_PPM   5000  // PPS intervals further than this from a second are missed or glitched edges
+        #define GPS_PPS_DRIFT_FILTER    16    // Number of PPS intervals the drift estimate is averaged over
+        #define GPS_PPS_DRIFT_ERROR_PPM 2.0f  // Error of the averaged intervals, from the micros() resolution and ISR latency
+
+volatile unsigned long ppsEdgeMicros = 0;  // micros() at the last PPS rising edge
+volatile uint8_t ppsEdgeCount        = 0;  // Bumped by every edge, so the task can tell a new one came in
+uint8_t ppsEdgesSeen                 = 0;
+unsigned long ppsLastEdgeMicros      = 0;
+unsigned long ppsSecondStartMillis   = 0;  // millis() at the last PPS edge, which is the start of a UTC second
+bool ppsHaveEdge                     = false;
+uint8_t ppsDriftSamples              = 0;
+float ppsDriftPpm                    = 0;
+
+/////////////////////////////////
+//
+// latchPpsEdge
+//
+/////////////////////////////////
+// Runs in the PPS pin interrupt, only takes the time. The edge is processed by gpsTask().
+void GPS_ISR_ATTR latchPpsEdge()
+{
+    ppsEdgeMicros = micros();
+    ppsEdgeCount++;
+}
+
+/////////////////////////////////
+//
+// gpsStartPps
+//
+/////////////////////////////////
+void gpsStartPps()
+{
+    const int interrupt = digitalPinToInterrupt(GPS_PPS_PIN);
+    if (interrupt == NOT_AN_INTERRUPT)
+    {
+        LOG(DEBUG_GPS, "[GPS]: PPS pin %d has no interrupt, PPS is not used", GPS_PPS_PIN);
+        return;
+    }
+    pinMode(GPS_PPS_PIN, INPUT);
+    attachInterrupt(interrupt, latchPpsEdge, RISING);
+    LOG(DEBUG_GPS, "[GPS]: Capturing PPS edges on interrupt %d", interrupt);
+}
+
+/////////////////////////////////
+//
+// processPpsEdge
+//
+/////////////////////////////////
+// Converts a new PPS edge to the millis() it happened at and averages the interval since the previous one into a drift
+// estimate. The receiver keeps its PPS within a microsecond of UTC, so the interval shows how far off micros() runs.
+// This gives the mount a good estimate within a minute, long before the one from the syncs catches up.
+void processPpsEdge()
+{
+    unsigned long edgeMicros;
+    unsigned long nowMicros;
+    unsigned long nowMillis;
+    uint8_t edgeCount;
+    {
+        CriticalSection lock;
+        edgeMicros = ppsEdgeMicros;
+        edgeCount  = ppsEdgeCount;
+        nowMicros  = micros();
+        nowMillis  = millis();
+    }
+    if (edgeCount == ppsEdgesSeen)
+    {
+        return;
+    }
+
+    // Counted back from now in micros(), so the edge lands on the right millis() tick
+    ppsSecondStartMillis = nowMillis - (nowMicros - edgeMicros) / 1000UL;
+    if (ppsHaveEdge && (static_cast<uint8_t>(edgeCount - ppsEdgesSeen) == 1))
+    {
+        const long errorPpm = static_cast<long>(edgeMicros - ppsLastEdgeMicros) - 1000000L;
+        if (labs(errorPpm) <= GPS_PPS_MAX_DRIFT_PPM)
+        {
+            ppsDriftPpm = (ppsDriftSamples > 0) ? ppsDriftPpm + (errorPpm - ppsDriftPpm) / GPS_PPS_DRIFT_FILTER : errorPpm;
+            if (ppsDriftSamples < 2 * GPS_PPS_DRIFT_FILTER)
+            {
+                ppsDriftSamples++;
+            }
+            else
+            {
+                mount.updateClockDrift(ppsDriftPpm, GPS_PPS_DRIFT_ERROR_PPM);
+            }
+        }
+    }
+    ppsLastEdgeMicros = edgeMicros;
+    ppsEdgesSeen      = edgeCount;
+    ppsHaveEdge       = true;
+}
+    #endif
+
+/////////////////////////////////
+//
+// gpsSecondStartMillis
+//
+/////////////////////////////////
+// Returns the millis() at which the UTC second of the last decoded sentence began, and how far off that may be. That is
+// the last PPS edge if one came in during that second, else the time the sentence was decoded less its centiseconds.
+// Without PPS the time the receiver takes to send the sentence is not known, which leaves the clock late by up to a
+// few 100ms.
+unsigned long gpsSecondStartMillis(unsigned int &errorMs)
+{
+    #if defined(GPS_PPS_PIN)
+    if (ppsHaveEdge && (gps.time.centisecond() == 0) && (millis() - ppsSecondStartMillis < 1000UL))
+    {
+        errorMs = 1;
+        return ppsSecondStartMillis;
+    }
+    #endif
+    errorMs = 250;
+    return millis() - 10UL * gps.time.centisecond();
+}
+
+/////////////////////////////////
+//
+// gpsDaysInMonth
+//
+/////////////////////////////////
+int gpsDaysInMonth(int year, int month)
+{
+    switch (month)
+    {
+        case 2:
+            return (((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0)) ? 29 : 28;
+        case 4:
+        case 6:
+        case 9:
+        case 11:
+            return 30;
+    }
+    return 31;
+}
+
+/////////////////////////////////
+//
+// syncClockToGps
+//
+/////////////////////////////////
+// Sets the mount clock from the time of the last decoded sentence, once per GPS second
+void syncClockToGps()
 {
+    if (!gps.time.isValid() || !gps.date.isValid() || (gps.time.value() == gpsLastSyncedTime))
+    {
+        return;
+    }
+    gpsLastSyncedTime = gps.time.value();
+
+    // GPS sends UTC, so the date has to move along with the time when the offset crosses midnight
+    LocalDate localDate = {gps.date.year(), gps.date.month(), gps.date.day()};
+    int localHour       = gps.time.hour() + mount.getLocalUtcOffset();
+    if (localHour < 0)
+    {
+        localHour += 24;
+        localDate.day--;
+        if (localDate.day < 1)
+        {
+            localDate.month--;
+            if (localDate.month < 1)
+            {
+                localDate.month = 12;
+                localDate.year--;
+            }
+            localDate.day = gpsDaysInMonth(localDate.year, localDate.month);
+        }
+    }
+    else if (localHour >= 24)
+    {
+        localHour -= 24;
+        localDate.day++;
+        if (localDate.day > gpsDaysInMonth(localDate.year, localDate.month))
+        {
+            localDate.day = 1;
+            localDate.month++;
+            if (localDate.month > 12)
+            {
+                localDate.month = 1;
+                localDate.year++;
+            }
+        }
+    }
+
+    unsigned int errorMs;
+    const unsigned long secondStart = gpsSecondStartMillis(errorMs);
+    DayTime localNow                = DayTime(localHour, gps.time.minute(), gps.time.second());
+    mount.syncLocalClock(localNow, localDate, secondStart, errorMs);
+}
+
+/////////////////////////////////
+//
+// gpsTask
+//
+/////////////////////////////////
+// Scheduler task that feeds the received characters to the GPS parser. Once a fix has been applied it keeps the
+// mount clock in step with every new GPS second.
+void gpsTask()
+{
+    ProfileScope profile(PROFILE_GPS);
+    #if defined(GPS_PPS_PIN)
+    processPpsEdge();
+    #endif
     while (GPS_SERIAL_PORT.available())
     {
         int gpsChar = GPS_SERIAL_PORT.read();
@@ -28,7 +242,7 @@ bool gpsAqcuisitionComplete(int &indicator)
             // $ (ASCII 36) marks start of message, so we switch indicator every message
             if (millis() - lastGPSUpdate > 500)
             {
-                indicator     = adjustWrap(indicator, 1, 0, 3);
+                gpsIndicator  = adjustWrap(gpsIndicator, 1, 0, 3);
                 lastGPSUpdate = millis();
             }
         }
@@ -39,32 +253,53 @@ bool gpsAqcuisitionComplete(int &indicator)
             LOG(DEBUG_GPS, "[GPS]: Sentence: [%s]", gpsBuf);
             gpsBufPos = 0;
     #endif
+            gpsSentenceDecoded = true;
+            if (gpsClockSynced)
+            {
+                syncClockToGps();
+            }
+        }
+    }
+}
 
-            LOG(DEBUG_GPS,
-                "[GPS]: Encoded. %l sats, Location is%svalid, age is %lms",
-                gps.satellites.value(),
-                (gps.location.isValid() ? " " : " NOT "),
-                gps.location.age());
-            // Make sure we got a fix in the last 30 seconds
-            if ((gps.location.lng() != 0) && (gps.location.age() < 30000UL))
-            {
-                LOG(DEBUG_INFO, "[GPS]: Sync'd GPS location. Age is %d secs", gps.location.age() / 1000);
-                LOG(DEBUG_INFO, "[GPS]: Location: %f  %f", gps.location.lat(), gps.location.lng());
-                LOG(DEBUG_INFO, "[GPS]: UTC time is %dh%dm%ds", gps.time.hour(), gps.time.minute(), gps.time.second());
-                lcdMenu.printMenu("GPS sync'd....");
-
-                DayTime utcNow = DayTime(gps.time.hour(), gps.time.minute(), gps.time.second());
-                utcNow.addHours(mount.getLocalUtcOffset());
-                mount.setLocalStartTime(utcNow);
-                mount.setLocalStartDate(gps.date.year(), gps.date.month(), gps.date.day());
-                mount.setLatitude(gps.location.lat());
-                mount.setLongitude(gps.location.lng());
+/////////////////////////////////
+//
+// gpsAqcuisitionComplete
+//
+/////////////////////////////////
+// Checks whether the sentences decoded by gpsTask() hold a recent fix and applies it to the mount.
+bool gpsAqcuisitionComplete(int &indicator)
+{
+    indicator = gpsIndicator;
+    if (!gpsSentenceDecoded)
+    {
+        return false;
+    }
+    gpsSentenceDecoded = false;
 
-                mount.delay(500);
+    LOG(DEBUG_GPS,
+        "[GPS]: Encoded. %l sats, Location is%svalid, age is %lms",
+        gps.satellites.value(),
+        (gps.location.isValid() ? " " : " NOT "),
+        gps.location.age());
+    // Make sure we got a fix in the last 30 seconds
+    if ((gps.location.lng() != 0) && (gps.location.age() < 30000UL))
+    {
+        LOG(DEBUG_INFO, "[GPS]: Sync'd GPS location. Age is %d secs", gps.location.age() / 1000);
+        LOG(DEBUG_INFO, "[GPS]: Location: %f  %f", gps.location.lat(), gps.location.lng());
+        LOG(DEBUG_INFO, "[GPS]: UTC time is %dh%dm%ds", gps.time.hour(), gps.time.minute(), gps.time.second());
+        lcdMenu.printMenu("GPS sync'd....");
 
-                return true;
-            }
-        }
+        // Sets the local date as well, setLongitude() then recalculates the HA
+        gpsLastSyncedTime = 0;
+        syncClockToGps();
+        gpsClockSynced = true;
+        mount.setLatitude(gps.location.lat());
+        mount.setLongitude(gps.location.lng());
+
+        mount.delay(500);
+
+        return true;
     }
     return false;
 }
@@ -93,7 +328,6 @@ bool processHAKeys()
         if (gpsAqcuisitionComplete(indicator))
         {
             LOG(DEBUG_INFO, "[HA]: GPS acquired");
-            GPS_SERIAL_PORT.end();
             haState = SHOWING_HA_SYNC;
         #if SUPPORT_GUIDED_STARTUP == 1
             if (startupState == StartupWaitForHACompletion)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LcdButtons.hpp"
+#include "Profiler.hpp"
 #include "b_setup.hpp"
 #include "c65_startup.hpp"
 #include "c70_menuRA.hpp"
@@ -13,17 +14,100 @@
 #include "c77_menuFOC.hpp"
 #include "c78_menuINFO.hpp"
 
+#include "Scheduler.hpp"
+
 #if SUPPORT_SERIAL_CONTROL == 1
     #include "f_serial.hpp"
 #endif
 
+/////////////////////////////////
+//
+// Scheduler tasks
+//
+/////////////////////////////////
+void guidePulsesTask()
+{
+    mount.processGuidePulses();
+}
+
+void mountTask()
+{
+    mount.processMotion();
+}
+
+#if (WIFI_ENABLED == 1)
+void wifiTask()
+{
+    wifiControl.loop();
+}
+#endif
+
+#if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
+void infoDisplayTask()
+{
+    mount.updateInfoDisplay();
+}
+#endif
+
+#if (DISPLAY_TYPE > 0) && (LCD_BUTTON_TEST == 0)
+// Updates the menu line (or the stepper positions when under serial control) and the tracking indicator.
+void lcdDisplayTask()
+{
+    if (inSerialControl)
+    {
+        mount.displayStepperPositionThrottled();
+    }
+    else if (okToUpdateMenu && !inStartup && !mount.isSlewingRAorDEC())
+    {
+        // Main menu display
+        ProfileScope profile(PROFILE_DISPLAY);
+        lcdMenu.updateDisplay();
+    }
+
+    // Tracking marker
+    if (mount.isBootComplete())
+    {
+        lcdMenu.printAt(15, 0, mount.isSlewingTRK() ? '&' : '`');
+    }
+}
+#endif
+
+/////////////////////////////////
+//
+// setupTasks
+//
+/////////////////////////////////
+// Registers the main loop tasks. Periods and deadlines are in ms.
+void setupTasks()
+{
+    Scheduler::addTask(TASK_GUIDE_PULSES, "GUIDE", guidePulsesTask, SCHEDULE_EVERY_PASS, 2);
+    Scheduler::addTask(TASK_MOUNT, "MOUNT", mountTask, SCHEDULE_EVERY_PASS, 20);
+#if defined(ESP32) && (SUPPORT_SERIAL_CONTROL == 1)
+    Scheduler::addTask(TASK_SERIAL, "SERIAL", processSerialData, SCHEDULE_EVERY_PASS, 50);
+#endif
+#if (WIFI_ENABLED == 1)
+    Scheduler::addTask(TASK_WIFI, "WIFI", wifiTask, 10, 50);
+#endif
+#if USE_GPS == 1
+    Scheduler::addTask(TASK_GPS, "GPS", gpsTask, 20, 200);
+#endif
+#if USE_GYRO_LEVEL == 1
+    Scheduler::addTask(TASK_GYRO, "GYRO", Gyro::sample, GYRO_TASK_MS, 5 * GYRO_TASK_MS);
+#endif
+#if (INFO_DISPLAY_TYPE != INFO_DISPLAY_TYPE_NONE)
+    Scheduler::addTask(TASK_INFO_DISPLAY, "OLED", infoDisplayTask, 150, 500);
+#endif
+#if (DISPLAY_TYPE > 0) && (LCD_BUTTON_TEST == 0)
+    Scheduler::addTask(TASK_LCD_DISPLAY, "LCD", lcdDisplayTask, 100, 500);
+#endif
+}
+
 #if DISPLAY_TYPE > 0
     #if LCD_BUTTON_TEST == 1
 lcdButton_t lastKey = btnNONE;
     #endif
 
 lcdButton_t lcd_key;
-unsigned long lastTrackingStatusPrint = 0;
 
 void loop()
 {
@@ -77,23 +161,8 @@ void loop()
 
     #endif
 
-    // Give the mount a time slice to do its thing...
-    mount.loop();
-
-    // Update the LCD display
-    unsigned long now = millis();
-    if (!inSerialControl && okToUpdateMenu && !inStartup && !mount.isSlewingRAorDEC())
-    {
-        // Main menu display
-        lcdMenu.updateDisplay();
-    }
-
-    // Tracking marker
-    if ((mount.isBootComplete()) && (now - lastTrackingStatusPrint > 200))
-    {
-        lcdMenu.printAt(15, 0, mount.isSlewingTRK() ? '&' : '`');
-        lastTrackingStatusPrint = now;
-    }
+    // Give the mount, communication and display tasks a time slice to do their thing...
+    Scheduler::run();
 
     lcdMenu.setCursor(0, 1);
 
@@ -112,7 +181,6 @@ void loop()
                 quitSerialOnNextButtonRelease = false;
             }
         }
-        serialLoop();
     }
     else
     #endif
@@ -178,6 +246,8 @@ void loop()
 
         if (waitForButtonRelease)
         {
+            // A key was handled, so show its effect on the menu line right away
+            Scheduler::trigger(TASK_LCD_DISPLAY);
             if (lcdButtons.currentState() != btnNONE)
             {
                 do
@@ -271,7 +341,7 @@ void loop()
 // No display present.
 void loop()
 {
-    serialLoop();
+    Scheduler::run();
 }
 
 #endif
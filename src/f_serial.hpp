@@ -7,22 +7,6 @@
 
 void processSerialData();
 
-////////////////////////////////////////////////
-// The main loop when under serial control
-void serialLoop()
-{
-    mount.loop();
-    mount.displayStepperPositionThrottled();
-
-    #ifdef ESP32
-    processSerialData();
-    #endif
-
-    #if (WIFI_ENABLED == 1)
-    wifiControl.loop();
-    #endif
-}
-
     //////////////////////////////////////////////////
     // Event that is triggered when the serial port receives data.
     #ifndef ESP32
@@ -32,7 +16,7 @@ void serialEvent()
 }
     #endif
 
-// ESP needs to call this in a loop :_(
+// ESP needs to call this in a loop :_( (it is the TASK_SERIAL scheduler task there)
 void processSerialData()
 {
     char buffer[2];
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief A bounded buffer of time tagged RA/DEC positions of a moving object (comet, asteroid, satellite)
+ * and the logic to follow it by setting axis rates.
+ * @details Positions are in 1/100 arcsec and times in ms of track time, all in fixed point so that it runs
+ * the same on every board. Between the points the track is a cubic Hermite curve with Catmull-Rom tangents,
+ * so uneven point spacing is fine. Points that are no longer needed are dropped while following, so a long
+ * pass can be streamed in while the buffer has space.
+ * @tparam Capacity Maximum number of buffered points (at least 4)
+ */
+template <uint8_t Capacity> class EphemerisTrack
+{
+  public:
+    static const int32_t FULL_CIRCLE = 129600000L;  ///< 360 degrees in 1/100 arcsec
+
+    typedef struct {
+        uint32_t timeMs;  ///< Track time
+        int32_t ra;       ///< RA in 1/100 arcsec (15 arcsec per second of time), unwrapped across 0h
+        int32_t dec;      ///< DEC in 1/100 arcsec
+    } Point_t;
+
+    EphemerisTrack()
+    {
+        clear();
+    }
+
+    /**
+     * Discards all points and stops following.
+     */
+    void clear()
+    {
+        _head        = 0;
+        _count       = 0;
+        _raPos       = 0;
+        _decPos      = 0;
+        _raRate      = 0;
+        _decRate     = 0;
+        _updateMs    = 0;
+        _raResidual  = 0;
+        _decResidual = 0;
+    }
+
+    uint8_t size() const
+    {
+        return _count;
+    }
+
+    uint8_t space() const
+    {
+        return Capacity - _count;
+    }
+
+    /**
+     * @return Track time of the last point, 0 if there are none
+     */
+    uint32_t endTimeMs() const
+    {
+        return (_count > 0) ? at(_count - 1).timeMs : 0;
+    }
+
+    /**
+     * Appends a point to the track.
+     * @param[in] timeMs Track time, must be later than the last point
+     * @param[in] ra RA in 1/100 arcsec, may wrap at 24h
+     * @param[in] dec DEC in 1/100 arcsec
+     * @return false if the buffer is full or the point is not later than the last one
+     */
+    bool add(uint32_t timeMs, int32_t ra, int32_t dec)
+    {
+        if (_count == Capacity)
+        {
+            return false;
+        }
+        if (_count > 0)
+        {
+            const Point_t &last = at(_count - 1);
+            if (timeMs <= last.timeMs)
+            {
+                return false;
+            }
+            // Keep RA continuous across 0h/24h, so the curve never sees a jump
+            while (ra - last.ra > FULL_CIRCLE / 2)
+            {
+                ra -= FULL_CIRCLE;
+            }
+            while (last.ra - ra > FULL_CIRCLE / 2)
+            {
+                ra += FULL_CIRCLE;
+            }
+        }
+        Point_t &point = _points[(_head + _count) % Capacity];
+        point.timeMs   = timeMs;
+        point.ra       = ra;
+        point.dec      = dec;
+        _count++;
+        return true;
+    }
+
+    /**
+     * Drops the points that are not needed anymore to evaluate the track at or after the given time.
+     */
+    void discardBefore(uint32_t timeMs)
+    {
+        // The segment containing timeMs starts at point 1 or later, point 0 only served its tangent
+        while ((_count >= 3) && (at(2).timeMs <= timeMs))
+        {
+            _head = (_head + 1) % Capacity;
+            _count--;
+        }
+    }
+
+    /**
+     * Gets the position on the track at the given time.
+     * @param[in] timeMs Track time
+     * @param[out] ra RA in 1/100 arcsec (unwrapped)
+     * @param[out] dec DEC in 1/100 arcsec
+     * @return false if the time is not covered by the buffered points
+     */
+    bool evaluate(uint32_t timeMs, int32_t &ra, int32_t &dec) const
+    {
+        if ((_count < 2) || (timeMs < at(0).timeMs) || (timeMs > at(_count - 1).timeMs))
+        {
+            return false;
+        }
+        uint8_t segment = 0;
+        while (at(segment + 1).timeMs < timeMs)
+        {
+            segment++;
+        }
+        // Position within the segment, 0..65536
+        const int64_t s = (static_cast<int64_t>(timeMs - at(segment).timeMs) << 16) / (at(segment + 1).timeMs - at(segment).timeMs);
+        ra              = interpolate(segment, s, &Point_t::ra);
+        dec             = interpolate(segment, s, &Point_t::dec);
+        return true;
+    }
+
+    /**
+     * Starts following the track, assuming the mount points at the track position of the given time.
+     * @return false if the track does not cover the given time
+     */
+    bool start(uint32_t timeMs)
+    {
+        int32_t ra;
+        int32_t dec;
+        if (!evaluate(timeMs, ra, dec))
+        {
+            return false;
+        }
+        _raPos       = static_cast<int64_t>(ra) * 1000;
+        _decPos      = static_cast<int64_t>(dec) * 1000;
+        _raRate      = 0;
+        _decRate     = 0;
+        _updateMs    = timeMs;
+        _raResidual  = 0;
+        _decResidual = 0;
+        return true;
+    }
+
+    /**
+     * Works out the rates that take the mount from where the rates of the previous update got it to the track
+     * position periodMs later. Any residual of the previous period is removed in the next one.
+     * @param[in] timeMs Current track time
+     * @param[in] periodMs Time until the next update
+     * @param[out] raRate RA rate in 1/100 arcsec per second (positive is east, i.e. increasing RA)
+     * @param[out] decRate DEC rate in 1/100 arcsec per second
+     * @return false if the track ends before the next update
+     */
+    bool update(uint32_t timeMs, uint32_t periodMs, int32_t &raRate, int32_t &decRate)
+    {
+        // Rates in 1/100 arcsec/sec times ms give positions in 1/100000 arcsec, which keeps the integration exact
+        const int32_t elapsedMs = timeMs - _updateMs;
+        _raPos += static_cast<int64_t>(_raRate) * elapsedMs;
+        _decPos += static_cast<int64_t>(_decRate) * elapsedMs;
+        _updateMs = timeMs;
+        discardBefore(timeMs);
+
+        int32_t ra;
+        int32_t dec;
+        if (evaluate(timeMs, ra, dec))
+        {
+            _raResidual  = ra - static_cast<int32_t>(_raPos / 1000);
+            _decResidual = dec - static_cast<int32_t>(_decPos / 1000);
+        }
+        if ((periodMs == 0) || !evaluate(timeMs + periodMs, ra, dec))
+        {
+            _raRate  = 0;
+            _decRate = 0;
+            return false;
+        }
+        _raRate  = (static_cast<int64_t>(ra) * 1000 - _raPos) / static_cast<int32_t>(periodMs);
+        _decRate = (static_cast<int64_t>(dec) * 1000 - _decPos) / static_cast<int32_t>(periodMs);
+        raRate   = _raRate;
+        decRate  = _decRate;
+        return true;
+    }
+
+    /**
+     * @return Track RA minus the RA the rates got to, at the last update, in 1/100 arcsec
+     */
+    int32_t getRaResidual() const
+    {
+        return _raResidual;
+    }
+
+    /**
+     * @return Track DEC minus the DEC the rates got to, at the last update, in 1/100 arcsec
+     */
+    int32_t getDecResidual() const
+    {
+        return _decResidual;
+    }
+
+  private:
+    const Point_t &at(uint8_t index) const
+    {
+        return _points[(_head + index) % Capacity];
+    }
+
+    /**
+     * Tangent at a segment end from its neighbours a and b, scaled to the segment length.
+     */
+    int64_t tangent(const Point_t &a, const Point_t &b, uint32_t spanMs, int32_t Point_t::*axis) const
+    {
+        return (static_cast<int64_t>(b.*axis) - a.*axis) * spanMs / (b.timeMs - a.timeMs);
+    }
+
+    int32_t interpolate(uint8_t segment, int64_t s, int32_t Point_t::*axis) const
+    {
+        const Point_t &p1     = at(segment);
+        const Point_t &p2     = at(segment + 1);
+        const uint32_t spanMs = p2.timeMs - p1.timeMs;
+        const int64_t delta   = static_cast<int64_t>(p2.*axis) - p1.*axis;
+
+        // At the ends of the buffered track the outer tangent comes from the parabola through the segment and
+        // its inner tangent, so a quadratic track stays exact. With only two points the segment is straight.
+        const bool hasM1 = segment > 0;
+        const bool hasM2 = segment + 2 < _count;
+        int64_t m1       = hasM1 ? tangent(at(segment - 1), p2, spanMs, axis) : delta;
+        int64_t m2       = hasM2 ? tangent(p1, at(segment + 2), spanMs, axis) : delta;
+        if (!hasM1 && hasM2)
+        {
+            m1 = 2 * delta - m2;
+        }
+        else if (hasM1 && !hasM2)
+        {
+            m2 = 2 * delta - m1;
+        }
+
+        // Hermite basis functions in 16 bit fixed point
+        const int64_t s2  = (s * s) >> 16;
+        const int64_t s3  = (s2 * s) >> 16;
+        const int64_t h01 = 3 * s2 - 2 * s3;
+        const int64_t h10 = s3 - 2 * s2 + s;
+        const int64_t h11 = s3 - s2;
+        return p1.*axis + static_cast<int32_t>((h01 * delta + h10 * m1 + h11 * m2) >> 16);
+    }
+
+    Point_t _points[Capacity];  ///< Ring buffer of points
+    uint8_t _head;              ///< Index of the oldest point
+    uint8_t _count;             ///< Number of buffered points
+    int64_t _raPos;             ///< RA the rates got to, in 1/100000 arcsec
+    int64_t _decPos;            ///< DEC the rates got to, in 1/100000 arcsec
+    int32_t _raRate;            ///< RA rate of the last update, in 1/100 arcsec per second
+    int32_t _decRate;           ///< DEC rate of the last update, in 1/100 arcsec per second
+    uint32_t _updateMs;         ///< Track time of the last update
+    int32_t _raResidual;        ///< See getRaResidual()
+    int32_t _decResidual;       ///< See getDecResidual()
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Fixed point sine, cosine, arctangent and square root for the boards without a floating point unit.
+ * @details On the ATmega2560 every float operation is a soft-float library call, and sinf(), atan2f() and sqrtf()
+ * take thousands of cycles each. These kernels only use 32 bit integer multiplies, adds and shifts (plus one
+ * division in arctan2()), and give the same results on every board.
+ *
+ * Angles are binary angles: a full circle is 65536, so an int16_t wraps around at 180 degrees by itself. One unit
+ * is 0.0055 degrees (19.8 arcsec). Sine and cosine are in Q15, where 32767 is 1.0.
+ *
+ * Error bounds, checked against libm for every input angle by unit_tests/test_native_fixed_trig/test_FixedTrig.cpp:
+ * - sine(), cosine(): at most 2 units of Q15 (6.1e-5)
+ * - arctan2(): at most 1 unit of angle
+ * - squareRoot(): exact, the square root rounded down
+ */
+class FixedTrig
+{
+  public:
+    static const int32_t QUARTER_TURN = 16384;  ///< 90 degrees
+    static const int32_t HALF_TURN    = 32768;  ///< 180 degrees, wraps to -32768 in an int16_t
+    static const int32_t ONE          = 32767;  ///< 1.0 in Q15 (saturated)
+
+    /**
+     * @return The binary angle in degrees, -180 to 180
+     */
+    static float toDegrees(int16_t angle)
+    {
+        return angle * (360.0f / 65536.0f);
+    }
+
+    /**
+     * @return The angle in degrees as a binary angle, wrapped to -180 to 180 degrees
+     */
+    static int16_t fromDegrees(float degrees)
+    {
+        const float units = degrees * (65536.0f / 360.0f);
+        return static_cast<int16_t>(static_cast<int32_t>(units + ((units < 0) ? -0.5f : 0.5f)));
+    }
+
+    /**
+     * @return sin(angle) in Q15
+     */
+    static int16_t sine(int16_t angle)
+    {
+        // sin(180 - a) = sin(a) folds the angle into -90 to 90 degrees
+        int32_t x = angle;
+        if (x > QUARTER_TURN)
+        {
+            x = HALF_TURN - x;
+        }
+        else if (x < -QUARTER_TURN)
+        {
+            x = -HALF_TURN - x;
+        }
+
+        // Minimax polynomial of sin(z * pi / 2) for z in -1 to 1, error 6e-7 before rounding to Q15
+        const int32_t z  = 2 * x;
+        const int32_t z2 = mulQ15(z, z);
+        int32_t p        = SIN_C7;
+        p                = SIN_C5 + mulQ15(p, z2);
+        p                = SIN_C3 + mulQ15(p, z2);
+        p                = SIN_C1 + mulQ15(p, z2);
+        return saturateQ15(mulQ15(p, z));
+    }
+
+    /**
+     * @return cos(angle) in Q15
+     */
+    static int16_t cosine(int16_t angle)
+    {
+        return sine(static_cast<int16_t>(angle + QUARTER_TURN));
+    }
+
+    /**
+     * Angle of the vector (x, y), like atan2(y, x). Only the ratio of x and y matters, so any scale can be used.
+     * @return The angle, -180 to 180 degrees. 0 for (0, 0).
+     */
+    static int16_t arctan2(int32_t y, int32_t x)
+    {
+        uint32_t ax = (x < 0) ? 0UL - static_cast<uint32_t>(x) : static_cast<uint32_t>(x);
+        uint32_t ay = (y < 0) ? 0UL - static_cast<uint32_t>(y) : static_cast<uint32_t>(y);
+        if ((ax == 0) && (ay == 0))
+        {
+            return 0;
+        }
+
+        // Keep both in 16 bits, so the Q15 ratio fits in 32 bits
+        while ((ax | ay) > 0xFFFFUL)
+        {
+            ax >>= 1;
+            ay >>= 1;
+        }
+
+        // The polynomial covers 0 to 45 degrees, atan(1/t) = 90 - atan(t) covers the steeper half of the octant
+        const bool steep = ay > ax;
+        int32_t angle    = steep ? arctanQ15(ratioQ15(ax, ay)) : arctanQ15(ratioQ15(ay, ax));
+        if (steep)
+        {
+            angle = QUARTER_TURN - angle;
+        }
+        if (x < 0)
+        {
+            angle = HALF_TURN - angle;
+        }
+        if (y < 0)
+        {
+            angle = -angle;
+        }
+        return static_cast<int16_t>(angle);
+    }
+
+    /**
+     * @return The square root of value, rounded down
+     */
+    static uint16_t squareRoot(uint32_t value)
+    {
+        // Digit by digit in base 4, one result bit per round
+        uint32_t root = 0;
+        uint32_t bit  = 1UL << 30;
+        while (bit > value)
+        {
+            bit >>= 2;
+        }
+        while (bit != 0)
+        {
+            if (value >= root + bit)
+            {
+                value -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else
+            {
+                root >>= 1;
+            }
+            bit >>= 2;
+        }
+        return static_cast<uint16_t>(root);
+    }
+
+  private:
+    // sin(z * pi / 2) = z * (C1 + z^2 * (C3 + z^2 * (C5 + z^2 * C7))), in Q15
+    static const int32_t SIN_C1 = 51472;   // 1.5707910
+    static const int32_t SIN_C3 = -21165;  // -0.6458929
+    static const int32_t SIN_C5 = 2603;    // 0.0794344
+    static const int32_t SIN_C7 = -142;    // -0.0043331
+
+    // atan(t) / pi = t * (C1 + t^2 * (C3 + t^2 * (C5 + t^2 * (C7 + t^2 * C9)))) for t in 0 to 1. The coefficients are
+    // scaled by 2^17, so the product with t in Q15 is the binary angle scaled by 2^17. Error 1.1e-5 rad (0.12 units
+    // of angle) before rounding, see Abramowitz & Stegun 4.4.49.
+    static const int32_t ATAN_C1 = 41716;   // 0.9998663 / pi
+    static const int32_t ATAN_C3 = -13781;  // -0.3303048 / pi
+    static const int32_t ATAN_C5 = 7517;    // 0.1801591 / pi
+    static const int32_t ATAN_C7 = -3553;   // -0.0851557 / pi
+    static const int32_t ATAN_C9 = 870;     // 0.0208447 / pi
+
+    static int32_t mulQ15(int32_t a, int32_t b)
+    {
+        return (a * b + (1L << 14)) >> 15;
+    }
+
+    static int16_t saturateQ15(int32_t value)
+    {
+        return static_cast<int16_t>((value > ONE) ? ONE : ((value < -ONE) ? -ONE : value));
+    }
+
+    // Rounded numerator / denominator in Q15, numerator not above denominator and both below 65536
+    static int32_t ratioQ15(uint32_t numerator, uint32_t denominator)
+    {
+        return static_cast<int32_t>(((numerator << 15) + (denominator >> 1)) / denominator);
+    }
+
+    // Binary angle of atan(t), t in Q15 from 0 to 1.0 (32768)
+    static int32_t arctanQ15(int32_t t)
+    {
+        const int32_t t2 = mulQ15(t, t);
+        int32_t p        = ATAN_C9;
+        p                = ATAN_C7 + mulQ15(p, t2);
+        p                = ATAN_C5 + mulQ15(p, t2);
+        p                = ATAN_C3 + mulQ15(p, t2);
+        p                = ATAN_C1 + mulQ15(p, t2);
+        return (p * t + (1L << 16)) >> 17;
+    }
+};
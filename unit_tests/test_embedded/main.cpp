@@ -1,6 +1,7 @@
 #include <unity.h>
 
 #include "test_sidereal.h"
+#include "test_fixed_trig.h"
 
 // void setup()
 // {
@@ -17,6 +18,7 @@ int main(int argc, char **argv)
     UNITY_BEGIN();
 
     test::sidereal::run();
+    test::fixedtrig::run();
 
     UNITY_END();
 
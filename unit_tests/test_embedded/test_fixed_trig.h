@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "unity.h"
+#include "FixedTrig.hpp"
+
+namespace test
+{
+namespace fixedtrig
+{
+const int benchmarkCalls = 256;
+
+volatile int32_t fixedSink;
+volatile float floatSink;
+
+// Cycles per call from the time a loop of benchmarkCalls took. Includes the loop overhead, which is the same for both.
+unsigned long cyclesPerCall(unsigned long elapsedUs)
+{
+    return elapsedUs * (F_CPU / 1000000UL) / benchmarkCalls;
+}
+
+void reportCycles(const char *kernel, unsigned long fixedUs, unsigned long floatUs)
+{
+    char message[80];
+    snprintf(message,
+             sizeof(message),
+             "%s: %lu cycles fixed point, %lu cycles float",
+             kernel,
+             cyclesPerCall(fixedUs),
+             cyclesPerCall(floatUs));
+    TEST_MESSAGE(message);
+}
+
+void test_kernels_match_float_on_target()
+{
+    for (int32_t angle = -32768; angle < 32768; angle += 97)
+    {
+        const float radians = angle * (2.0f * PI / 65536.0f);
+        TEST_ASSERT_INT_WITHIN(3, lroundf(32767.0f * sinf(radians)), FixedTrig::sine(angle));
+        const int32_t y        = lroundf(30000.0f * sinf(radians));
+        const int32_t x        = lroundf(30000.0f * cosf(radians));
+        const int16_t expected = static_cast<int16_t>(lroundf(atan2f(y, x) * (32768.0f / PI)));
+        TEST_ASSERT_INT_WITHIN(2, 0, static_cast<int16_t>(FixedTrig::arctan2(y, x) - expected));  // Wraps at 180 degrees
+    }
+    TEST_ASSERT_EQUAL_UINT16(65535, FixedTrig::squareRoot(0xFFFFFFFFUL));
+}
+
+// The benchmarks only report the cycle counts, timing depends on the board and the interrupts running during the test
+void test_benchmark_sine()
+{
+    unsigned long start = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        fixedSink = fixedSink + FixedTrig::sine(i * 251);
+    }
+    unsigned long middle = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        floatSink = floatSink + sinf(i * 0.02406f);
+    }
+    unsigned long end = micros();
+    reportCycles("sine", middle - start, end - middle);
+}
+
+void test_benchmark_arctan2()
+{
+    unsigned long start = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        fixedSink = fixedSink + FixedTrig::arctan2(i * 61 - 7808, 9000);
+    }
+    unsigned long middle = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        floatSink = floatSink + atan2f(i * 61.0f - 7808.0f, 9000.0f);
+    }
+    unsigned long end = micros();
+    reportCycles("arctan2", middle - start, end - middle);
+}
+
+void test_benchmark_square_root()
+{
+    unsigned long start = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        fixedSink = fixedSink + FixedTrig::squareRoot(i * 16769023UL);
+    }
+    unsigned long middle = micros();
+    for (int i = 0; i < benchmarkCalls; i++)
+    {
+        floatSink = floatSink + sqrtf(i * 16769023.0f);
+    }
+    unsigned long end = micros();
+    reportCycles("squareRoot", middle - start, end - middle);
+}
+
+void run()
+{
+    RUN_TEST(test_kernels_match_float_on_target);
+    RUN_TEST(test_benchmark_sine);
+    RUN_TEST(test_benchmark_arctan2);
+    RUN_TEST(test_benchmark_square_root);
+}
+}  // namespace fixedtrig
+}  // namespace test
@@ -0,0 +1,147 @@
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "EphemerisTrack.hpp"
+
+const int32_t fullCircle = EphemerisTrack<4>::FULL_CIRCLE;
+
+void test_function_ephemeris_buffer_bounds(void)
+{
+    EphemerisTrack<4> track;
+    int32_t ra;
+    int32_t dec;
+    TEST_ASSERT_FALSE(track.evaluate(0, ra, dec));
+    TEST_ASSERT_TRUE(track.add(0, 0, 0));
+    TEST_ASSERT_FALSE(track.add(0, 100, 100));  // Not later than the last point
+    TEST_ASSERT_TRUE(track.add(1000, 100, 100));
+    TEST_ASSERT_TRUE(track.add(2000, 200, 200));
+    TEST_ASSERT_TRUE(track.add(3000, 300, 300));
+    TEST_ASSERT_FALSE(track.add(4000, 400, 400));  // Full
+    TEST_ASSERT_EQUAL(0, track.space());
+    TEST_ASSERT_FALSE(track.evaluate(3001, ra, dec));
+
+    // Point 0 is only needed for the tangent of the segment starting at point 1
+    track.discardBefore(1500);
+    TEST_ASSERT_EQUAL(0, track.space());
+    track.discardBefore(2000);
+    TEST_ASSERT_EQUAL(1, track.space());
+    TEST_ASSERT_TRUE(track.add(4000, 400, 400));
+    TEST_ASSERT_EQUAL(4000, track.endTimeMs());
+    TEST_ASSERT_TRUE(track.evaluate(3500, ra, dec));
+    TEST_ASSERT_EQUAL(350, ra);
+    TEST_ASSERT_EQUAL(350, dec);
+}
+
+void test_function_ephemeris_quadratic_is_exact(void)
+{
+    // Catmull-Rom tangents are exact for a quadratic with even spacing, so the inner segments must match
+    EphemerisTrack<8> track;
+    for (int32_t i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_TRUE(track.add(i * 10000, 5000 * i * i, -3000 * i * i));
+    }
+    for (uint32_t timeMs = 10000; timeMs <= 60000; timeMs += 1250)
+    {
+        int32_t ra;
+        int32_t dec;
+        TEST_ASSERT_TRUE(track.evaluate(timeMs, ra, dec));
+        const double seconds = timeMs / 10000.0;
+        TEST_ASSERT_INT32_WITHIN(2, lround(5000 * seconds * seconds), ra);
+        TEST_ASSERT_INT32_WITHIN(2, lround(-3000 * seconds * seconds), dec);
+    }
+}
+
+void test_function_ephemeris_ra_wraps(void)
+{
+    EphemerisTrack<4> track;
+    TEST_ASSERT_TRUE(track.add(0, fullCircle - 1000, 0));
+    TEST_ASSERT_TRUE(track.add(1000, 500, 0));
+    TEST_ASSERT_TRUE(track.add(2000, 2000, 0));
+    int32_t ra;
+    int32_t dec;
+    TEST_ASSERT_TRUE(track.evaluate(1500, ra, dec));
+    TEST_ASSERT_EQUAL(fullCircle + 1250, ra);
+}
+
+// A fast pass across 0h, with RA rates up to 12x sidereal and a DEC rate that keeps changing. In arcsec.
+static void passPosition(double seconds, double &ra, double &dec)
+{
+    ra  = 1295900.0 + 36000.0 * sin(2.0 * M_PI * seconds / 1200.0);
+    dec = 72000.0 + 18000.0 * (seconds / 600.0) * (seconds / 600.0);
+}
+
+void test_function_ephemeris_follow_residual(void)
+{
+    // Simulates the mount: the buffer is refilled whenever it has space, the rates are updated every second
+    // and the axes move in steps of 0.5 arcsec. The residual is the distance between the pass and the axes.
+    const uint32_t passMs         = 600000;
+    const uint32_t pointSpacingMs = 10000;
+    const uint32_t updateMs       = 1000;
+    const double stepArcsec       = 0.5;
+
+    EphemerisTrack<8> track;
+    uint32_t nextPointMs = 0;
+    double axisRa        = 0;
+    double axisDec       = 0;
+    double maxResidual   = 0;
+    uint32_t timeMs      = 0;
+    int32_t raRate       = 0;
+    int32_t decRate      = 0;
+    for (;; timeMs += updateMs)
+    {
+        while ((track.space() > 0) && (nextPointMs <= passMs))
+        {
+            double ra;
+            double dec;
+            passPosition(nextPointMs / 1000.0, ra, dec);
+            TEST_ASSERT_TRUE(track.add(nextPointMs, lround(fmod(ra, 1296000.0) * 100), lround(dec * 100)));
+            nextPointMs += pointSpacingMs;
+        }
+
+        if (timeMs == 0)
+        {
+            // The mount was slewed to the start of the pass
+            TEST_ASSERT_TRUE(track.start(0));
+            passPosition(0, axisRa, axisDec);
+        }
+        if (!track.update(timeMs, updateMs, raRate, decRate))
+        {
+            break;
+        }
+
+        for (uint32_t tickMs = 10; tickMs <= updateMs; tickMs += 10)
+        {
+            axisRa += raRate / 100.0 * 0.01;
+            axisDec += decRate / 100.0 * 0.01;
+            double ra;
+            double dec;
+            passPosition((timeMs + tickMs) / 1000.0, ra, dec);
+            const double raError  = ra - round(axisRa / stepArcsec) * stepArcsec;
+            const double decError = dec - round(axisDec / stepArcsec) * stepArcsec;
+            maxResidual           = fmax(maxResidual, sqrt(raError * raError + decError * decError));
+        }
+    }
+
+    char message[80];
+    snprintf(message, sizeof(message), "Followed %lu s, max residual %.2f arcsec", (unsigned long) (timeMs / 1000), maxResidual);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(timeMs >= passMs - updateMs);
+    TEST_ASSERT_TRUE(maxResidual < 1.0);
+}
+
+void process()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_function_ephemeris_buffer_bounds);
+    RUN_TEST(test_function_ephemeris_quadratic_is_exact);
+    RUN_TEST(test_function_ephemeris_ra_wraps);
+    RUN_TEST(test_function_ephemeris_follow_residual);
+    UNITY_END();
+}
+
+int main(int argc, char **argv)
+{
+    process();
+    return 0;
+}
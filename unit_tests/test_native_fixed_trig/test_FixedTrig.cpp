@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+
+#include "FixedTrig.hpp"
+
+const int32_t fullCircle = 65536;
+
+// Difference of two binary angles, wrapped to -180 to 180 degrees
+double angleError(double angle, double expected)
+{
+    double error = fmod(angle - expected, fullCircle);
+    if (error > fullCircle / 2)
+    {
+        error -= fullCircle;
+    }
+    else if (error < -fullCircle / 2)
+    {
+        error += fullCircle;
+    }
+    return fabs(error);
+}
+
+void test_sine_cosine_error_bound()
+{
+    long maxError = 0;
+    for (int32_t angle = -32768; angle < 32768; angle++)
+    {
+        const double radians = angle * 2.0 * M_PI / fullCircle;
+        const long sine      = lround(fmin(32768.0 * sin(radians), 32767.0));
+        const long cosine    = lround(fmin(32768.0 * cos(radians), 32767.0));
+        maxError             = std::max(maxError, labs(FixedTrig::sine(angle) - sine));
+        maxError             = std::max(maxError, labs(FixedTrig::cosine(angle) - cosine));
+    }
+    TEST_ASSERT_INT_WITHIN(2, 0, maxError);
+    TEST_ASSERT_EQUAL(0, FixedTrig::sine(0));
+    TEST_ASSERT_EQUAL(32767, FixedTrig::sine(16384));
+    TEST_ASSERT_EQUAL(-32767, FixedTrig::sine(-16384));
+    TEST_ASSERT_EQUAL(0, FixedTrig::sine(-32768));
+}
+
+void test_arctan2_error_bound()
+{
+    // The scale of the vector does not matter, large ones are scaled down to 16 bits first
+    const double magnitudes[] = {100.0, 16384.0, 46341.0, 1.0e6, 2.0e9};
+    double maxError           = 0;
+    for (double magnitude : magnitudes)
+    {
+        for (int32_t angle = -32768; angle < 32768; angle++)
+        {
+            const double radians = angle * 2.0 * M_PI / fullCircle;
+            const int32_t y      = lround(magnitude * sin(radians));
+            const int32_t x      = lround(magnitude * cos(radians));
+            const double exact   = atan2(y, x) * fullCircle / (2.0 * M_PI);
+            maxError             = fmax(maxError, angleError(FixedTrig::arctan2(y, x), exact));
+        }
+    }
+    TEST_ASSERT_TRUE(maxError <= 1.0);
+
+    // The axes are exact
+    TEST_ASSERT_EQUAL(0, FixedTrig::arctan2(0, 0));
+    TEST_ASSERT_EQUAL(0, FixedTrig::arctan2(0, 5));
+    TEST_ASSERT_EQUAL(16384, FixedTrig::arctan2(5, 0));
+    TEST_ASSERT_EQUAL(-16384, FixedTrig::arctan2(-5, 0));
+    TEST_ASSERT_EQUAL(-32768, FixedTrig::arctan2(0, -5));
+    TEST_ASSERT_EQUAL(8192, FixedTrig::arctan2(INT32_MAX, INT32_MAX));
+    TEST_ASSERT_EQUAL(-24576, FixedTrig::arctan2(INT32_MIN, INT32_MIN));
+}
+
+void test_square_root_is_exact()
+{
+    const uint32_t edges[] = {0, 1, 2, 3, 4, 15, 16, 17, 65535, 65536, 0xFFFE0000UL, 0xFFFE0001UL, 0x80000000UL, 0xFFFFFFFFUL};
+    for (uint32_t value : edges)
+    {
+        TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(floor(sqrt(static_cast<double>(value)))), FixedTrig::squareRoot(value));
+    }
+    uint32_t value = 12345;
+    for (int i = 0; i < 100000; i++)
+    {
+        value = value * 1664525UL + 1013904223UL;  // Numerical Recipes LCG
+        TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(floor(sqrt(static_cast<double>(value)))), FixedTrig::squareRoot(value));
+    }
+}
+
+void test_degrees_conversion()
+{
+    TEST_ASSERT_EQUAL(16384, FixedTrig::fromDegrees(90.0f));
+    TEST_ASSERT_EQUAL(-16384, FixedTrig::fromDegrees(-90.0f));
+    TEST_ASSERT_EQUAL(-32768, FixedTrig::fromDegrees(180.0f));
+    TEST_ASSERT_EQUAL(16384, FixedTrig::fromDegrees(450.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, -45.0f, FixedTrig::toDegrees(-8192));
+}
+
+// Nanoseconds per call of the fixed point kernels and their libm counterparts on the host. Only reported, since
+// on the host the FPU makes libm fast. See test_embedded for the cycle counts on the board.
+void test_benchmark_against_libm()
+{
+    const int32_t calls        = 1 << 20;
+    volatile int32_t fixedSink = 0;
+    volatile float floatSink   = 0;
+
+    clock_t start = clock();
+    for (int32_t i = 0; i < calls; i++)
+    {
+        fixedSink = fixedSink + FixedTrig::sine(i) + FixedTrig::arctan2(i & 0x7FFF, 20000) + FixedTrig::squareRoot(i * 4093U);
+    }
+    const double fixedNs = 1.0e9 * (clock() - start) / CLOCKS_PER_SEC / calls;
+
+    start = clock();
+    for (int32_t i = 0; i < calls; i++)
+    {
+        floatSink = floatSink + sinf(i * 9.58738e-5f) + atan2f(i & 0x7FFF, 20000.0f) + sqrtf(i * 4093.0f);
+    }
+    const double floatNs = 1.0e9 * (clock() - start) / CLOCKS_PER_SEC / calls;
+
+    char message[100];
+    snprintf(message, sizeof(message), "sine + arctan2 + squareRoot: %.1f ns, sinf + atan2f + sqrtf: %.1f ns", fixedNs, floatNs);
+    TEST_MESSAGE(message);
+}
+
+void process()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sine_cosine_error_bound);
+    RUN_TEST(test_arctan2_error_bound);
+    RUN_TEST(test_square_root_is_exact);
+    RUN_TEST(test_degrees_conversion);
+    RUN_TEST(test_benchmark_against_libm);
+    UNITY_END();
+}
+
+int main(int argc, char **argv)
+{
+    process();
+    return 0;
+}